@@ -6,10 +6,60 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Layouts computed here rather than per card on the CPU; see CardLayoutKind
+// in cardpool.h. With layoutKind 0 the card is placed by its model matrix.
+// Otherwise it's placed by its position in the library view, and the card
+// at scrollOffset is centred on the origin.
+const int kLayoutRow = 1;
+const int kLayoutGrid = 2;
+const int kLayoutWheel = 3;
+
+uniform int   layoutKind = 0;
+// The card's position in the view. Each card is its own draw call (see
+// CardPool::Draw), so this is set per draw rather than derived from an
+// instance ID.
+uniform int   cardIndex = 0;
+uniform float scrollOffset = 0.0;
+uniform vec2  cardSize = vec2(1.0, 1.0);
+uniform vec2  cardPitch = vec2(0.0, 0.0);
+uniform int   numColumns = 1;
+uniform float wheelRadius = 0.0;
+uniform float wheelAngleStep = 0.0;
+
 out vec2 uv;
 
 void main()
 {
     uv = texCoords;
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    if (layoutKind == 0)
+    {
+        gl_Position = projection * view * model * vec4(position, 1.0);
+        return;
+    }
+
+    vec2 centre = vec2(0.0, 0.0);
+    float angle = 0.0;
+    if (layoutKind == kLayoutRow)
+    {
+        centre.x = (float(cardIndex) - scrollOffset) * cardPitch.x;
+    }
+    else if (layoutKind == kLayoutGrid)
+    {
+        // Scrolled by rows, with the columns centred
+        int row = cardIndex / numColumns;
+        int column = cardIndex - row * numColumns;
+        centre.x = (float(column) - 0.5 * float(numColumns - 1)) * cardPitch.x;
+        centre.y = (float(row) - scrollOffset) * cardPitch.y;
+    }
+    else if (layoutKind == kLayoutWheel)
+    {
+        // Around a circle whose top is at the origin, each card upright
+        // relative to the rim
+        angle = (float(cardIndex) - scrollOffset) * wheelAngleStep;
+        centre = wheelRadius * vec2(sin(angle), 1.0 - cos(angle));
+    }
+
+    vec2 corner = (position.xy - vec2(0.5, 0.5)) * cardSize;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    gl_Position = projection * view * vec4(centre + rotation * corner, position.z, 1.0);
 }
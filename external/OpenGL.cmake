@@ -1,2 +1,13 @@
 cmake_minimum_required (VERSION 3.9 FATAL_ERROR)
 find_package(OpenGL REQUIRED)
+
+# EGL backs headless (offscreen) rendering, which is left out without it
+find_path(EGL_INCLUDE_DIR EGL/egl.h)
+find_library(EGL_LIBRARY NAMES EGL)
+if(EGL_INCLUDE_DIR AND EGL_LIBRARY)
+    include_directories(${EGL_INCLUDE_DIR})
+    add_definitions(-DFIVEDNINE_ENABLE_HEADLESS)
+else()
+    message(STATUS "EGL not found, building without headless rendering")
+    set(EGL_LIBRARY "")
+endif()
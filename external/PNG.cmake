@@ -0,0 +1,3 @@
+cmake_minimum_required (VERSION 3.9 FATAL_ERROR)
+find_package(PNG REQUIRED)
+include_directories(${PNG_INCLUDE_DIRS})
@@ -1,2 +0,0 @@
-find_package(SDL2_image REQUIRED)
-include_directories(${SDL2IMAGE_INCLUDE_DIR})
@@ -0,0 +1,3 @@
+cmake_minimum_required (VERSION 3.9 FATAL_ERROR)
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
@@ -0,0 +1,15 @@
+// carouselplugin.cpp
+//
+// Entry point for the carousel built as a selector plugin
+
+#include "carouselselector.h"
+
+extern "C" FDN_SELECTOR_EXPORT const FdnSelectorApi* fivednine_GetSelectorApi(uint32_t hostApiVersion)
+{
+    if (hostApiVersion != FDN_SELECTOR_API_VERSION)
+    {
+        return nullptr;
+    }
+
+    return CarouselSelector::GetSelectorApi();
+}
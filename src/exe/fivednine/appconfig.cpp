@@ -50,6 +50,32 @@ bool AppConfig::Parse(const std::string& configPath)
     }
     m_gamesDbPath = configData["gamesdb_path"].get<std::string>();
 
+    // Optional keys
+    if (configData.contains("launch_history_path"))
+    {
+        m_launchHistoryPath = configData["launch_history_path"].get<std::string>();
+    }
+
+    if (configData.contains("library_view"))
+    {
+        m_libraryViewName = configData["library_view"].get<std::string>();
+    }
+
+    if (configData.contains("asset_catalog_path"))
+    {
+        m_assetCatalogPath = configData["asset_catalog_path"].get<std::string>();
+    }
+
+    if (configData.contains("input_mapping_path"))
+    {
+        m_inputMappingPath = configData["input_mapping_path"].get<std::string>();
+    }
+
+    if (configData.contains("selector_plugin_path"))
+    {
+        m_selectorPluginPath = configData["selector_plugin_path"].get<std::string>();
+    }
+
     m_parsed = true;
     return true;
 }
@@ -72,4 +98,29 @@ const std::string& AppConfig::GetTexturesPath() const
 const std::string& AppConfig::GetGamesDbPath() const
 {
     return m_gamesDbPath;
-}
\ No newline at end of file
+}
+
+const std::string& AppConfig::GetLaunchHistoryPath() const
+{
+    return m_launchHistoryPath;
+}
+
+const std::string& AppConfig::GetLibraryViewName() const
+{
+    return m_libraryViewName;
+}
+
+const std::string& AppConfig::GetAssetCatalogPath() const
+{
+    return m_assetCatalogPath;
+}
+
+const std::string& AppConfig::GetInputMappingPath() const
+{
+    return m_inputMappingPath;
+}
+
+const std::string& AppConfig::GetSelectorPluginPath() const
+{
+    return m_selectorPluginPath;
+}
@@ -12,9 +12,24 @@ class AppConfig
         const std::string& GetTexturesPath() const;
         const std::string& GetGamesDbPath() const;
 
+        // Optional; empty if not configured
+        const std::string& GetLaunchHistoryPath() const;
+        const std::string& GetLibraryViewName() const;
+        const std::string& GetAssetCatalogPath() const;
+        const std::string& GetInputMappingPath() const;
+
+        // Shared object exporting a selector (see selectorapi.h). Reloaded
+        // whenever it's rebuilt; the built-in carousel is used if unset.
+        const std::string& GetSelectorPluginPath() const;
+
     private:
         bool m_parsed = false;
         std::string m_shadersPath;
         std::string m_texturesPath;
         std::string m_gamesDbPath;
+        std::string m_launchHistoryPath;
+        std::string m_libraryViewName;
+        std::string m_assetCatalogPath;
+        std::string m_inputMappingPath;
+        std::string m_selectorPluginPath;
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+// appevents.h
+//
+// Everything that goes through the app's event bus (see
+// fivednine/system/eventbus.h). Payloads are copied into fixed-size queue
+// slots, so they hold plain values only; names are truncated to fit and
+// always null-terminated.
+
+#pragma once
+
+#include "assetcatalog.h"
+#include "selectorevent.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <fivednine/system/eventbus.h>
+
+static constexpr size_t kMaxEventNameLength = 64;
+
+// An asset finished loading and can be looked up by name
+struct AssetLoadedEvent
+{
+    AssetCatalog::AssetKind Kind;
+    char                    Name[kMaxEventNameLength];
+};
+
+// A texture was dropped from storage to stay within budget; anything
+// drawing with it should fall back until it's loaded again
+struct TextureEvictedEvent
+{
+    char TextureName[kMaxEventNameLength];
+};
+
+struct GameProcessStartedEvent
+{
+    uint32_t GameIndex;
+    int32_t  ProcessId;
+};
+
+struct GameProcessExitedEvent
+{
+    uint32_t GameIndex;
+    int32_t  ProcessId;
+
+    // As from waitpid()
+    int32_t  ExitStatus;
+};
+
+// The config file was re-read; the new values are in the app's AppConfig
+struct ConfigReloadedEvent
+{
+    uint64_t TimestampNs;
+};
+
+typedef fivednine::system::EventBus<
+    SelectorInputEvent,
+    DisplayResizedEvent,
+    AssetLoadedEvent,
+    TextureEvictedEvent,
+    GameProcessStartedEvent,
+    GameProcessExitedEvent,
+    ConfigReloadedEvent> AppEventBus;
@@ -0,0 +1,365 @@
+#include "assetcatalog.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+
+namespace
+{
+    static constexpr uint32_t kCatalogVersion = 1;
+
+    bool IsTextureAssetPath(const std::filesystem::path& filePath)
+    {
+        // Just supports png files for the moment
+        return filePath.extension() == ".png";
+    }
+
+    bool IsShaderAssetPath(const std::filesystem::path& filePath)
+    {
+        // glsl only
+        return filePath.extension() == ".glsl";
+    }
+
+    bool IsAssetPath(const std::filesystem::path& filePath, AssetCatalog::AssetKind kind)
+    {
+        switch (kind)
+        {
+            case AssetCatalog::AssetKind::Texture:
+                return IsTextureAssetPath(filePath);
+            case AssetCatalog::AssetKind::Shader:
+                return IsShaderAssetPath(filePath);
+            default:
+                return false;
+        }
+    }
+
+    bool
+    ShaderProgramNameAndShaderTypeFromFilePath(
+        const std::filesystem::path& filePath,
+        std::string* pProgramNameOut,
+        std::string* pShaderTypeOut)
+    {
+        RELEASE_CHECK(pProgramNameOut != nullptr, "pProgramNameOut cannot be null");
+        *pProgramNameOut = "";
+
+        RELEASE_CHECK(pShaderTypeOut != nullptr, "pShaderTypeOut cannot be null");
+        *pShaderTypeOut = "";
+
+        const std::string StemString = filePath.stem().string();
+
+        // The expected format is <programname>_<shadertype>.<extension>
+        const size_t LastUnderscoreIndex = StemString.find_last_of('_');
+        if (LastUnderscoreIndex == std::string::npos)
+        {
+            RELEASE_LOG_WARNING(
+                LOG_DEFAULT,
+                "Improperly named shader: %s",
+                filePath.c_str());
+                return false;
+        }
+
+        *pProgramNameOut = StemString.substr(0, LastUnderscoreIndex);
+        *pShaderTypeOut = StemString.substr(LastUnderscoreIndex + 1);
+        return true;
+    }
+
+    // 64-bit FNV-1a. Only used to tell whether content changed, so it
+    // doesn't need to be cryptographic.
+    bool HashFileContents(const std::filesystem::path& filePath, uint64_t* pHashOut)
+    {
+        std::ifstream in(filePath, std::ios::binary);
+        if (!in)
+        {
+            return false;
+        }
+
+        uint64_t hash = 14695981039346656037ull;
+        char buffer[64 * 1024];
+        while (in)
+        {
+            in.read(buffer, sizeof(buffer));
+            const std::streamsize BytesRead = in.gcount();
+            for (std::streamsize i = 0; i < BytesRead; ++i)
+            {
+                hash ^= static_cast<uint8_t>(buffer[i]);
+                hash *= 1099511628211ull;
+            }
+        }
+
+        *pHashOut = hash;
+        return true;
+    }
+
+    int64_t ToModifiedTime(const std::filesystem::file_time_type& fileTime)
+    {
+        return static_cast<int64_t>(fileTime.time_since_epoch().count());
+    }
+
+    bool IsValidEntryData(const json& entryData)
+    {
+        return entryData.is_object() &&
+            entryData.contains("path") && entryData["path"].is_string() &&
+            entryData.contains("size") && entryData["size"].is_number_unsigned() &&
+            entryData.contains("mtime") && entryData["mtime"].is_number_integer() &&
+            entryData.contains("hash") && entryData["hash"].is_number_unsigned() &&
+            (!entryData.contains("program") ||
+                (entryData["program"].is_string() && entryData.contains("stage") && entryData["stage"].is_string()));
+    }
+
+    bool IsValidDirectoryData(const json& directoryData)
+    {
+        if (!directoryData.is_object() ||
+            !directoryData.contains("path") || !directoryData["path"].is_string() ||
+            !directoryData.contains("kind") || !directoryData["kind"].is_number_unsigned() ||
+            directoryData["kind"].get<uint64_t>() >= static_cast<uint64_t>(AssetCatalog::AssetKind::Max) ||
+            !directoryData.contains("mtime") || !directoryData["mtime"].is_number_integer() ||
+            !directoryData.contains("entries") || !directoryData["entries"].is_array())
+        {
+            return false;
+        }
+
+        return std::all_of(std::begin(directoryData["entries"]), std::end(directoryData["entries"]), IsValidEntryData);
+    }
+}
+
+bool AssetCatalog::Load(const std::string& catalogPath)
+{
+    m_directories.clear();
+    m_isDirty = false;
+
+    std::ifstream catalogIn(catalogPath);
+    if (!catalogIn)
+    {
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "No asset catalog at %s, scanning from scratch", catalogPath.c_str());
+        return true;
+    }
+
+    // Checked in full up front, so a catalog that's corrupt or from another
+    // version is rebuilt by rescanning rather than half trusted
+    json catalogData = json::parse(catalogIn, nullptr, false);
+    if (catalogData.is_discarded() ||
+        !catalogData.is_object() ||
+        !catalogData.contains("version") ||
+        !catalogData["version"].is_number_unsigned() ||
+        catalogData["version"].get<uint64_t>() != kCatalogVersion ||
+        !catalogData.contains("directories") ||
+        !catalogData["directories"].is_array() ||
+        !std::all_of(
+            std::begin(catalogData["directories"]),
+            std::end(catalogData["directories"]),
+            IsValidDirectoryData))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Ignoring stale or malformed asset catalog: %s", catalogPath.c_str());
+        m_isDirty = true;
+        return false;
+    }
+
+    for (const auto& directoryData : catalogData["directories"])
+    {
+        DirectoryRecord directoryRecord;
+        directoryRecord.Kind = static_cast<AssetKind>(directoryData["kind"].get<uint32_t>());
+        directoryRecord.ModifiedTime = directoryData["mtime"].get<int64_t>();
+        for (const auto& entryData : directoryData["entries"])
+        {
+            AssetEntry entry;
+            entry.Path = entryData["path"].get<std::string>();
+            entry.FileSize = entryData["size"].get<uint64_t>();
+            entry.ModifiedTime = entryData["mtime"].get<int64_t>();
+            entry.ContentHash = entryData["hash"].get<uint64_t>();
+            if (entryData.contains("program"))
+            {
+                entry.ShaderProgramName = entryData["program"].get<std::string>();
+                entry.ShaderType = entryData["stage"].get<std::string>();
+            }
+            directoryRecord.Entries.push_back(std::move(entry));
+        }
+
+        m_directories.emplace(directoryData["path"].get<std::string>(), std::move(directoryRecord));
+    }
+
+    return true;
+}
+
+bool AssetCatalog::Save(const std::string& catalogPath)
+{
+    if (!m_isDirty)
+    {
+        return true;
+    }
+
+    json directoriesData = json::array();
+    for (const auto& [directoryPath, directoryRecord] : m_directories)
+    {
+        json entriesData = json::array();
+        for (const AssetEntry& entry : directoryRecord.Entries)
+        {
+            json entryData = {
+                { "path", entry.Path },
+                { "size", entry.FileSize },
+                { "mtime", entry.ModifiedTime },
+                { "hash", entry.ContentHash },
+            };
+            if (directoryRecord.Kind == AssetKind::Shader)
+            {
+                entryData["program"] = entry.ShaderProgramName;
+                entryData["stage"] = entry.ShaderType;
+            }
+            entriesData.push_back(std::move(entryData));
+        }
+
+        directoriesData.push_back({
+            { "path", directoryPath },
+            { "kind", static_cast<uint32_t>(directoryRecord.Kind) },
+            { "mtime", directoryRecord.ModifiedTime },
+            { "entries", std::move(entriesData) },
+        });
+    }
+
+    // Write-then-rename so an interrupted save never leaves a torn catalog
+    const std::string TempPath = catalogPath + ".tmp";
+    {
+        std::ofstream catalogOut(TempPath, std::ios::trunc);
+        if (!catalogOut)
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Failed to write asset catalog: %s", TempPath.c_str());
+            return false;
+        }
+
+        json catalogData = { { "version", kCatalogVersion }, { "directories", std::move(directoriesData) } };
+        catalogOut << catalogData.dump();
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(TempPath, catalogPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Failed to replace asset catalog %s: %s",
+            catalogPath.c_str(),
+            errorCode.message().c_str());
+        return false;
+    }
+
+    m_isDirty = false;
+    return true;
+}
+
+const std::vector<AssetEntry>*
+AssetCatalog::GetDirectoryAssets(const std::string& directoryPath, AssetKind kind)
+{
+    std::error_code errorCode;
+    const std::filesystem::file_time_type DirectoryTime = std::filesystem::last_write_time(directoryPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Failed to stat asset directory %s: %s",
+            directoryPath.c_str(),
+            errorCode.message().c_str());
+        return nullptr;
+    }
+
+    const int64_t ModifiedTime = ToModifiedTime(DirectoryTime);
+    auto it = m_directories.find(directoryPath);
+    if (it == std::end(m_directories) || it->second.Kind != kind || it->second.ModifiedTime != ModifiedTime)
+    {
+        if (!ScanDirectory(directoryPath, kind, ModifiedTime))
+        {
+            return nullptr;
+        }
+        it = m_directories.find(directoryPath);
+    }
+    else
+    {
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Asset directory unchanged, using catalog: %s", directoryPath.c_str());
+    }
+
+    return &it->second.Entries;
+}
+
+bool AssetCatalog::ScanDirectory(const std::string& directoryPath, AssetKind kind, int64_t modifiedTime)
+{
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Scanning asset directory: %s", directoryPath.c_str());
+
+    std::error_code errorCode;
+    std::filesystem::directory_iterator directoryIterator(directoryPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Failed to read asset directory %s: %s",
+            directoryPath.c_str(),
+            errorCode.message().c_str());
+        return false;
+    }
+
+    // Files whose size and mtime match the previous scan keep their hash and
+    // parsed name, so only new or modified files are read.
+    DirectoryRecord& directoryRecord = m_directories[directoryPath];
+    std::unordered_map<std::string, AssetEntry> previousEntriesByPath;
+    if (directoryRecord.Kind == kind)
+    {
+        previousEntriesByPath.reserve(directoryRecord.Entries.size());
+        for (AssetEntry& previousEntry : directoryRecord.Entries)
+        {
+            std::string previousPath = previousEntry.Path;
+            previousEntriesByPath.emplace(std::move(previousPath), std::move(previousEntry));
+        }
+    }
+    directoryRecord.Entries.clear();
+
+    for (const auto& directoryEntry : directoryIterator)
+    {
+        const std::filesystem::path FilePath = directoryEntry.path();
+        if (!IsAssetPath(FilePath, kind) || !directoryEntry.is_regular_file(errorCode))
+        {
+            continue;
+        }
+
+        AssetEntry entry;
+        entry.Path = FilePath.string();
+        entry.FileSize = directoryEntry.file_size(errorCode);
+        entry.ModifiedTime = ToModifiedTime(directoryEntry.last_write_time(errorCode));
+
+        auto previousIt = previousEntriesByPath.find(entry.Path);
+        if (previousIt != std::end(previousEntriesByPath) &&
+            previousIt->second.FileSize == entry.FileSize &&
+            previousIt->second.ModifiedTime == entry.ModifiedTime)
+        {
+            directoryRecord.Entries.push_back(std::move(previousIt->second));
+            continue;
+        }
+
+        if (!HashFileContents(FilePath, &entry.ContentHash))
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Failed to read asset %s", entry.Path.c_str());
+            continue;
+        }
+
+        if (kind == AssetKind::Shader)
+        {
+            ShaderProgramNameAndShaderTypeFromFilePath(FilePath, &entry.ShaderProgramName, &entry.ShaderType);
+        }
+
+        directoryRecord.Entries.push_back(std::move(entry));
+    }
+
+    std::sort(std::begin(directoryRecord.Entries), std::end(directoryRecord.Entries),
+        [](const AssetEntry& lhs, const AssetEntry& rhs) -> bool
+        {
+            return lhs.Path < rhs.Path;
+        });
+    directoryRecord.Kind = kind;
+    directoryRecord.ModifiedTime = modifiedTime;
+    m_isDirty = true;
+    return true;
+}
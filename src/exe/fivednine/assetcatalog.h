@@ -0,0 +1,65 @@
+// assetcatalog.h
+//
+// Persisted record of the asset directories: each file's path, size,
+// modification time and content hash, plus the shader program/stage parsed
+// from shader file names. A directory is only re-enumerated when its own
+// modification time changes, which saves a stat per file on slow storage.
+//
+// Note that a directory's mtime changes when entries are added, removed or
+// renamed, not when an existing file is rewritten in place. Editors and
+// deploy tools which write-then-rename are picked up; anything else needs the
+// catalog file deleted to force a full rescan.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct AssetEntry
+{
+    std::string Path;
+    uint64_t    FileSize = 0;
+    int64_t     ModifiedTime = 0;
+    uint64_t    ContentHash = 0;
+
+    // Shaders only, from <programname>_<shadertype>.glsl. Empty if the file
+    // is improperly named.
+    std::string ShaderProgramName;
+    std::string ShaderType;
+};
+
+class AssetCatalog
+{
+public:
+    enum class AssetKind
+    {
+        Texture = 0,
+        Shader,
+        Max
+    };
+
+    // A missing catalog file isn't an error; everything will be scanned.
+    bool Load(const std::string& catalogPath);
+
+    // No-op unless something changed since the catalog was loaded.
+    bool Save(const std::string& catalogPath);
+
+    // Returns the assets of the given kind in a directory, sorted by path.
+    // Returns null if the directory can't be read.
+    const std::vector<AssetEntry>* GetDirectoryAssets(const std::string& directoryPath, AssetKind kind);
+
+private:
+    struct DirectoryRecord
+    {
+        AssetKind               Kind = AssetKind::Max;
+        int64_t                 ModifiedTime = 0;
+        std::vector<AssetEntry> Entries;
+    };
+
+    bool ScanDirectory(const std::string& directoryPath, AssetKind kind, int64_t modifiedTime);
+
+    std::unordered_map<std::string, DirectoryRecord> m_directories;
+    bool m_isDirty = false;
+};
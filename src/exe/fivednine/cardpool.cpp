@@ -0,0 +1,356 @@
+#include "cardpool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <fivednine/log/check.h>
+#include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/render/uniform.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+namespace
+{
+    uint32_t FindUniform(const ShaderPtr& spShader, const char* pUniformName)
+    {
+        return spShader ? spShader->GetUniform(pUniformName) : Shader::kInvalidHandleValue;
+    }
+
+    template<typename T>
+    void SetUniformIfUsed(uint32_t location, const T& value)
+    {
+        if (location != Shader::kInvalidHandleValue)
+        {
+            Uniform<T>::Set(location, value);
+        }
+    }
+}
+
+void
+CardPool::Initialize(
+    ShaderPtr spShader,
+    TextureStorage* pTextureStorage,
+    size_t numGames)
+{
+    RELEASE_CHECK(pTextureStorage != nullptr, "pTextureStorage cannot be null");
+    m_pTextureStorage = pTextureStorage;
+    m_spShader = spShader;
+
+    m_layoutUniforms.LayoutKind = FindUniform(spShader, "layoutKind");
+    m_layoutUniforms.ScrollOffset = FindUniform(spShader, "scrollOffset");
+    m_layoutUniforms.CardSize = FindUniform(spShader, "cardSize");
+    m_layoutUniforms.CardPitch = FindUniform(spShader, "cardPitch");
+    m_layoutUniforms.NumColumns = FindUniform(spShader, "numColumns");
+    m_layoutUniforms.WheelRadius = FindUniform(spShader, "wheelRadius");
+    m_layoutUniforms.WheelAngleStep = FindUniform(spShader, "wheelAngleStep");
+
+    m_layout = CardLayoutParams();
+    m_scrollOffset = m_previousScrollOffset = m_scrollTarget = 0.f;
+
+    m_cardLayouts.assign(numGames, CardLayout());
+    m_appearanceParamNames.clear();
+    m_appearanceParamNames.reserve(kMaxAppearanceParams);
+    m_numRebinds = 0;
+    m_hasPendingTextures = false;
+
+    // Never more than could be in the window at once
+    const size_t NumInstances = std::min<size_t>(numGames, kNumCardInstances);
+    m_cardInstances.clear();
+    m_cardInstances.resize(NumInstances);
+    for (CardInstance& instance : m_cardInstances)
+    {
+        instance.spGameCard.reset(new GameCard(spShader));
+        RELEASE_CHECK(instance.spGameCard != nullptr, "Failed to allocate game card");
+    }
+}
+
+void CardPool::SetPosition(uint32_t gameIndex, const glm::vec3& position)
+{
+    CardLayout& cardLayout = m_cardLayouts[gameIndex];
+    cardLayout.Position = position;
+    ++cardLayout.Version;
+}
+
+glm::vec3 CardPool::GetPosition(uint32_t gameIndex) const
+{
+    return m_cardLayouts[gameIndex].Position;
+}
+
+void CardPool::SetDimensions(uint32_t gameIndex, float width, float height)
+{
+    CardLayout& cardLayout = m_cardLayouts[gameIndex];
+    cardLayout.Dimensions = glm::vec2(width, height);
+    ++cardLayout.Version;
+}
+
+void CardPool::SetTexture(uint32_t gameIndex, TextureHandle textureHandle)
+{
+    CardLayout& cardLayout = m_cardLayouts[gameIndex];
+    cardLayout.TextureHandle = textureHandle;
+    ++cardLayout.Version;
+}
+
+bool CardPool::SetAppearanceParam1f(uint32_t gameIndex, const char* pParameterName, float* pValue)
+{
+    auto it = std::find(std::begin(m_appearanceParamNames), std::end(m_appearanceParamNames), pParameterName);
+    if (it == std::end(m_appearanceParamNames))
+    {
+        if (m_appearanceParamNames.size() == kMaxAppearanceParams)
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_API,
+                "Too many card appearance parameters, can't add %s (max %u)",
+                pParameterName,
+                kMaxAppearanceParams);
+            return false;
+        }
+
+        it = m_appearanceParamNames.insert(std::end(m_appearanceParamNames), pParameterName);
+    }
+
+    CardLayout& cardLayout = m_cardLayouts[gameIndex];
+    cardLayout.pAppearanceValues[std::distance(std::begin(m_appearanceParamNames), it)] = pValue;
+    ++cardLayout.Version;
+    return true;
+}
+
+void CardPool::ClearAppearanceParams()
+{
+    m_appearanceParamNames.clear();
+    for (CardLayout& cardLayout : m_cardLayouts)
+    {
+        std::fill(std::begin(cardLayout.pAppearanceValues), std::end(cardLayout.pAppearanceValues), nullptr);
+        ++cardLayout.Version;
+    }
+}
+
+bool CardPool::SetLayout(const CardLayoutParams& layout)
+{
+    if (layout.Kind >= CardLayoutKind::Max ||
+        (layout.Kind == CardLayoutKind::Grid && layout.NumColumns < 1))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "Invalid card layout %d", static_cast<int32_t>(layout.Kind));
+        return false;
+    }
+
+    if (layout.Kind != CardLayoutKind::PerCard && m_layoutUniforms.LayoutKind == Shader::kInvalidHandleValue)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "Card shader has no layout support");
+        return false;
+    }
+
+    m_layout = layout;
+    return true;
+}
+
+const CardLayoutParams& CardPool::GetLayout() const
+{
+    return m_layout;
+}
+
+void CardPool::SetScroll(float scrollOffset)
+{
+    m_scrollOffset = scrollOffset;
+    m_previousScrollOffset = scrollOffset;
+    m_scrollTarget = scrollOffset;
+}
+
+void CardPool::SetScrollTarget(float scrollOffset)
+{
+    m_scrollTarget = scrollOffset;
+}
+
+bool CardPool::IsScrolling() const
+{
+    return m_scrollOffset != m_scrollTarget || m_scrollOffset != m_previousScrollOffset;
+}
+
+glm::vec3 CardPool::GetLayoutPosition(uint32_t cardIndex) const
+{
+    // As in gamecard_vert.glsl
+    const glm::vec2 CardPitch = m_layout.CardSize + m_layout.Spacing;
+    const float CardIndex = static_cast<float>(cardIndex);
+    glm::vec2 centre(0.f);
+    switch (m_layout.Kind)
+    {
+        case CardLayoutKind::Row:
+            centre.x = (CardIndex - m_scrollTarget) * CardPitch.x;
+            break;
+        case CardLayoutKind::Grid:
+        {
+            const uint32_t NumColumns = static_cast<uint32_t>(m_layout.NumColumns);
+            const uint32_t Row = cardIndex / NumColumns;
+            const uint32_t Column = cardIndex % NumColumns;
+            centre.x = (static_cast<float>(Column) - 0.5f * static_cast<float>(NumColumns - 1)) * CardPitch.x;
+            centre.y = (static_cast<float>(Row) - m_scrollTarget) * CardPitch.y;
+        }
+            break;
+        case CardLayoutKind::Wheel:
+        {
+            const float Angle = (CardIndex - m_scrollTarget) * m_layout.WheelAngleStep;
+            centre = m_layout.WheelRadius * glm::vec2(std::sin(Angle), 1.f - std::cos(Angle));
+        }
+            break;
+        default:
+            break;
+    }
+
+    return glm::vec3(centre - 0.5f * m_layout.CardSize, 0.f);
+}
+
+void CardPool::Tick(float dtSeconds)
+{
+    m_previousScrollOffset = m_scrollOffset;
+
+    // Eased like the camera, so a layout scrolls the way a panning camera
+    // moves
+    const float kScrollRate = 10.f;
+    const float kMinDistance = 0.001f;
+    const float Delta = m_scrollTarget - m_scrollOffset;
+    if (std::abs(Delta) > kMinDistance)
+    {
+        m_scrollOffset += Delta * std::min(kScrollRate * dtSeconds, 1.f);
+    }
+    else
+    {
+        m_scrollOffset = m_scrollTarget;
+    }
+}
+
+void
+CardPool::Draw(
+    const std::vector<uint32_t>& view,
+    uint32_t selectedCardIndex,
+    float interpolationAlpha,
+    const glm::mat4& projMatrix,
+    const glm::mat4& viewMatrix)
+{
+    PROFILE_SCOPE("CardPool::Draw");
+    const uint32_t NumCards = static_cast<uint32_t>(view.size());
+    const uint32_t NumInstances = static_cast<uint32_t>(m_cardInstances.size());
+    if (NumCards == 0 || NumInstances == 0)
+    {
+        return;
+    }
+
+    // Centred on the selection where possible, and kept whole at either end
+    // of the view
+    const uint32_t WindowSize = std::min(NumCards, NumInstances);
+    const uint32_t HalfWindowSize = WindowSize / 2;
+    uint32_t firstCardIndex = selectedCardIndex > HalfWindowSize ? selectedCardIndex - HalfWindowSize : 0;
+    firstCardIndex = std::min(firstCardIndex, NumCards - WindowSize);
+
+    // Shared by every card, so set once on the program rather than per mesh
+    const bool IsLaidOut = m_layout.Kind != CardLayoutKind::PerCard;
+    if (IsLaidOut)
+    {
+        SetLayoutUniforms(m_previousScrollOffset + (m_scrollOffset - m_previousScrollOffset) * interpolationAlpha);
+    }
+
+    // Bound outward from the selection, so that's where covers arrive first
+    // when there are more to load than the budget allows
+    uint32_t numTextureLoads = 0;
+    m_hasPendingTextures = false;
+    auto bindCard = [&](uint32_t cardIndex)
+    {
+        const uint32_t GameIndex = view[cardIndex];
+        CardInstance& instance = m_cardInstances[cardIndex % NumInstances];
+        instance.CardIndex = static_cast<int32_t>(cardIndex);
+        if (instance.GameIndex != GameIndex ||
+            instance.LayoutVersion != m_cardLayouts[GameIndex].Version ||
+            instance.IsTexturePending)
+        {
+            if (BindInstance(&instance, GameIndex, numTextureLoads < kMaxTextureLoadsPerDraw))
+            {
+                ++numTextureLoads;
+            }
+            m_hasPendingTextures = m_hasPendingTextures || instance.IsTexturePending;
+        }
+    };
+
+    const uint32_t LastCardIndex = firstCardIndex + WindowSize - 1;
+    const uint32_t CentreCardIndex = std::clamp(selectedCardIndex, firstCardIndex, LastCardIndex);
+    bindCard(CentreCardIndex);
+    for (uint32_t step = 1; step < WindowSize; ++step)
+    {
+        if (CentreCardIndex + step <= LastCardIndex)
+        {
+            bindCard(CentreCardIndex + step);
+        }
+        if (CentreCardIndex >= firstCardIndex + step)
+        {
+            bindCard(CentreCardIndex - step);
+        }
+    }
+
+    for (uint32_t cardIndex = firstCardIndex; cardIndex <= LastCardIndex; ++cardIndex)
+    {
+        m_cardInstances[cardIndex % NumInstances].spGameCard->Draw(projMatrix, viewMatrix);
+    }
+
+    // The overlay draws with the same program, by model matrix
+    if (IsLaidOut)
+    {
+        m_spShader->Bind();
+        Uniform<int>::Set(m_layoutUniforms.LayoutKind, static_cast<int>(CardLayoutKind::PerCard));
+        m_spShader->Unbind();
+    }
+}
+
+void CardPool::SetLayoutUniforms(float scrollOffset)
+{
+    m_spShader->Bind();
+    Uniform<int>::Set(m_layoutUniforms.LayoutKind, static_cast<int>(m_layout.Kind));
+    SetUniformIfUsed(m_layoutUniforms.ScrollOffset, scrollOffset);
+    SetUniformIfUsed(m_layoutUniforms.CardSize, m_layout.CardSize);
+    SetUniformIfUsed(m_layoutUniforms.CardPitch, m_layout.CardSize + m_layout.Spacing);
+    SetUniformIfUsed(m_layoutUniforms.NumColumns, static_cast<int>(m_layout.NumColumns));
+    SetUniformIfUsed(m_layoutUniforms.WheelRadius, m_layout.WheelRadius);
+    SetUniformIfUsed(m_layoutUniforms.WheelAngleStep, m_layout.WheelAngleStep);
+    m_spShader->Unbind();
+}
+
+bool CardPool::HasPendingTextures() const
+{
+    return m_hasPendingTextures;
+}
+
+uint64_t CardPool::GetNumRebinds() const
+{
+    return m_numRebinds;
+}
+
+bool CardPool::BindInstance(CardInstance* pInstance, uint32_t gameIndex, bool canLoadTexture)
+{
+    const CardLayout& CardLayoutToBind = m_cardLayouts[gameIndex];
+    GameCard& gameCard = *pInstance->spGameCard;
+    gameCard.SetPosition(CardLayoutToBind.Position.x, CardLayoutToBind.Position.y, CardLayoutToBind.Position.z);
+    gameCard.SetDimensions(CardLayoutToBind.Dimensions.x, CardLayoutToBind.Dimensions.y);
+
+    // Replacing the previous game's texture frees it if it was streamed and
+    // no other instance holds it
+    const TextureHandle CardTextureHandle = CardLayoutToBind.TextureHandle;
+    const bool IsLoadNeeded =
+        m_pTextureStorage->IsValidTextureHandle(CardTextureHandle) &&
+        !m_pTextureStorage->IsTextureResident(CardTextureHandle);
+    pInstance->IsTexturePending = IsLoadNeeded && !canLoadTexture;
+    gameCard.SetTexture(pInstance->IsTexturePending ? nullptr : m_pTextureStorage->AcquireTexture(CardTextureHandle));
+
+    // Cleared first so nothing is left over from the previous game
+    gameCard.ClearUniformValues();
+    gameCard.SetUniformValue("cardIndex", UniformType::Int, &pInstance->CardIndex);
+    for (size_t i = 0; i < m_appearanceParamNames.size(); ++i)
+    {
+        if (CardLayoutToBind.pAppearanceValues[i])
+        {
+            gameCard.SetUniformValue1f(m_appearanceParamNames[i].c_str(), CardLayoutToBind.pAppearanceValues[i]);
+        }
+    }
+
+    pInstance->GameIndex = gameIndex;
+    pInstance->LayoutVersion = CardLayoutToBind.Version;
+    ++m_numRebinds;
+    return IsLoadNeeded && canLoadTexture;
+}
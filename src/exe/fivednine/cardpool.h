@@ -0,0 +1,205 @@
+// cardpool.h
+//
+// Game cards for a library of any size with a fixed number of meshes. What
+// the selector sets for each card (position, size, texture and appearance
+// parameters) is kept as a small per-game record, and a pool of GameCard
+// instances, each with its own mesh and GPU buffers, is bound to the games
+// in a window of the library view around the selected card. As the
+// selection moves, instances for games that leave the window are rebound to
+// the ones entering it.
+//
+// Only cards in the window are drawn. The window reaches well past what fits
+// on screen, so cards scrolling into view are already bound, but a camera
+// flying across a long jump passes over empty space until it settles.
+//
+// Instances hold the only references to streamed textures (see
+// TextureStorage::AddStreamedTextureFromImagePath), so a game's cover is
+// loaded when an instance is bound to it and freed when that instance is
+// rebound to another game. Cover memory then depends on the window size
+// rather than the library's. A few covers are loaded per frame at most,
+// nearest the selection first, so that a long jump doesn't stall a frame
+// decoding the whole window.
+//
+// Cards can instead be placed by a layout (see CardLayoutParams), computed
+// in the vertex shader from each card's position in the view. Scrolling a
+// layout, or switching to another, is a handful of uniform updates per
+// frame however many cards there are.
+
+#pragma once
+
+#include "gamecard.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <fivednine/render/shader.h>
+#include <fivednine/render/texturestorage.h>
+
+// Values match FDN_CARD_LAYOUT_* in selectorapi.h and the layout kinds in
+// gamecard_vert.glsl
+enum class CardLayoutKind : int32_t
+{
+    PerCard = 0, // Positions and dimensions as set for each card
+    Row,         // Left to right, scrolled by cards
+    Grid,        // NumColumns across, centred, scrolled by rows
+    Wheel,       // Around the rim of a wheel, scrolled by cards
+    Max
+};
+
+struct CardLayoutParams
+{
+    CardLayoutKind Kind = CardLayoutKind::PerCard;
+    glm::vec2      CardSize = glm::vec2(1.f);
+
+    // Between neighbouring cards' edges
+    glm::vec2      Spacing = glm::vec2(0.f);
+
+    // Grid only
+    int32_t        NumColumns = 1;
+
+    // Wheel only. Cards are spaced WheelAngleStep radians apart around a
+    // wheel of WheelRadius, whose top is where the scrolled-to card sits.
+    float          WheelRadius = 0.f;
+    float          WheelAngleStep = 0.f;
+};
+
+class CardPool
+{
+public:
+    // Instances, and so the size of the window
+    static constexpr uint32_t kNumCardInstances = 64;
+
+    // Distinct parameter names across all cards
+    static constexpr uint32_t kMaxAppearanceParams = 4;
+
+    // Textures loaded by Draw, beyond which instances are drawn without
+    // one until a later frame
+    static constexpr uint32_t kMaxTextureLoadsPerDraw = 4;
+
+    // The texture storage must outlive the pool
+    void
+    Initialize(
+        fivednine::render::ShaderPtr spShader,
+        fivednine::render::TextureStorage* pTextureStorage,
+        size_t numGames);
+
+    // Per game, taking effect the next time the game's card is drawn
+    void      SetPosition(uint32_t gameIndex, const glm::vec3& position);
+    glm::vec3 GetPosition(uint32_t gameIndex) const;
+    void      SetDimensions(uint32_t gameIndex, float width, float height);
+    void      SetTexture(uint32_t gameIndex, fivednine::render::TextureHandle textureHandle);
+
+    // pValue is read at draw time. False if there are already
+    // kMaxAppearanceParams other names in use.
+    bool SetAppearanceParam1f(uint32_t gameIndex, const char* pParameterName, float* pValue);
+
+    // Forgets every card's appearance values and parameter names
+    void ClearAppearanceParams();
+
+    // Replaces the per-card positions and dimensions until set back to
+    // CardLayoutKind::PerCard. False if the parameters are unusable.
+    bool SetLayout(const CardLayoutParams& layout);
+    const CardLayoutParams& GetLayout() const;
+
+    // In the layout's scroll units; the card (or row) at the offset is
+    // centred on the origin. SetScrollTarget eases there over a few frames.
+    void SetScroll(float scrollOffset);
+    void SetScrollTarget(float scrollOffset);
+    bool IsScrolling() const;
+
+    // Where the layout puts the card once scrolling settles: its top-left
+    // corner, before any rotation
+    glm::vec3 GetLayoutPosition(uint32_t cardIndex) const;
+
+    // Advances the scroll by one fixed timestep
+    void Tick(float dtSeconds);
+
+    // Binds instances to the games around selectedCardIndex in view, and
+    // draws them in view order. interpolationAlpha blends between the last
+    // two scroll offsets, as for the camera.
+    void
+    Draw(
+        const std::vector<uint32_t>& view,
+        uint32_t selectedCardIndex,
+        float interpolationAlpha,
+        const glm::mat4& projMatrix,
+        const glm::mat4& viewMatrix);
+
+    // Whether the last Draw left textures to load, so more frames are needed
+    bool HasPendingTextures() const;
+
+    // Instances rebound since construction, for gauging churn
+    uint64_t GetNumRebinds() const;
+
+private:
+    static constexpr uint32_t kUnboundGameIndex = UINT32_MAX;
+
+    struct CardLayout
+    {
+        glm::vec3                        Position = glm::vec3(0.f);
+        glm::vec2                        Dimensions = glm::vec2(1.f);
+        fivednine::render::TextureHandle TextureHandle = fivednine::render::kInvalidTextureHandle;
+
+        // Indexed as m_appearanceParamNames
+        float* pAppearanceValues[kMaxAppearanceParams] = {};
+
+        // Bumped on every change, so bound instances can tell they're stale
+        uint32_t Version = 1;
+    };
+
+    struct CardInstance
+    {
+        std::unique_ptr<GameCard> spGameCard;
+        uint32_t                  GameIndex = kUnboundGameIndex;
+        uint32_t                  LayoutVersion = 0;
+
+        // Bound without its texture for want of the frame's load budget
+        bool                      IsTexturePending = false;
+
+        // Position in the view, read into the shader's cardIndex uniform
+        // when this instance's card is drawn
+        int32_t                   CardIndex = 0;
+    };
+
+    // Shader uniform locations for the layout, or Shader::kInvalidHandleValue
+    // for any the shader doesn't use
+    struct LayoutUniforms
+    {
+        uint32_t LayoutKind;
+        uint32_t ScrollOffset;
+        uint32_t CardSize;
+        uint32_t CardPitch;
+        uint32_t NumColumns;
+        uint32_t WheelRadius;
+        uint32_t WheelAngleStep;
+    };
+
+    // True if it loaded the card's texture. Leaves the instance pending
+    // instead if that was needed but canLoadTexture is false.
+    bool BindInstance(CardInstance* pInstance, uint32_t gameIndex, bool canLoadTexture);
+    void SetLayoutUniforms(float scrollOffset);
+
+    fivednine::render::TextureStorage* m_pTextureStorage = nullptr;
+    fivednine::render::ShaderPtr       m_spShader;
+    LayoutUniforms                     m_layoutUniforms;
+
+    CardLayoutParams m_layout;
+    float            m_scrollOffset = 0.f;
+    float            m_previousScrollOffset = 0.f;
+    float            m_scrollTarget = 0.f;
+
+    // Indexed by game index
+    std::vector<CardLayout> m_cardLayouts;
+
+    // The card at view position i is drawn with instance i % kNumCardInstances,
+    // which is unique within any window of kNumCardInstances positions
+    std::vector<CardInstance> m_cardInstances;
+
+    std::vector<std::string> m_appearanceParamNames;
+    uint64_t                 m_numRebinds = 0;
+    bool                     m_hasPendingTextures = false;
+};
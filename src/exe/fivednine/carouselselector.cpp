@@ -1,150 +1,322 @@
 #include "carouselselector.h"
-#include "fivednineapp.h"
-#include <fivednine/log/check.h>
 
-CarouselSelector::CarouselSelector(fivednineApp* pApp, EventPump* pEventPump)
-    : m_pApp(pApp), m_pEventPump(pEventPump)
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
 {
-    RELEASE_CHECK(m_pApp, "App pointer cannot be null in carousel selector");
-    RELEASE_CHECK(m_pEventPump, "Event pump pointer cannot be null in carousel selector");
-}
+    // Appearance values are read at draw time, so these have to stay put
+    float Tinted = 0.3f;
+    float UnTinted = 1.0f;
 
-float Tinted = 0.3f;
-float UnTinted = 1.0f;
+    static const float kGameCardPaddingX = 20.f;
+    static const uint32_t kInitialCardWidth = 200;
+    static const uint32_t kInitialCardHeight = 360;
 
-static const float kGameCardPaddingX = 20.f;
-static const uint32_t kInitialCardWidth = 200;
-static const uint32_t kInitialCardHeight = 360;
+    // What carries over a reload
+    struct CarouselState
+    {
+        static constexpr uint32_t kMagic = 0x4C535243; // "CRSL"
+        static constexpr uint32_t kVersion = 1;
 
-bool CarouselSelector::Initialize()
-{
-    uint32_t width;
-    uint32_t height;
-    m_pApp->Selector_GetDisplayDimensions(&width, &height);
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t LibraryView;
+        uint32_t SelectedIndex;
+    };
 
-    const uint32_t NumCards = m_pApp->Selector_GetNumCards();
-    const uint32_t MiddleCardIndex = NumCards / 2;
+    void* CreateSelector(const FdnHostApi* pHostApi)
+    {
+        if (!pHostApi || pHostApi->Version != FDN_SELECTOR_API_VERSION || pHostApi->Size < sizeof(FdnHostApi))
+        {
+            return nullptr;
+        }
 
-    // TODO: Align the center card with (0,0)
-    const float kInitialCardX = MiddleCardIndex * -1.f * (kInitialCardWidth + kGameCardPaddingX);
-    const float cardY = kInitialCardHeight / -2.f;
-    const float cardZ = 0.f;
+        return new CarouselSelector(pHostApi);
+    }
 
-    for (uint32_t i = 0; i < NumCards; ++i)
+    void DestroySelector(void* pSelector)
+    {
+        delete static_cast<CarouselSelector*>(pSelector);
+    }
+
+    int InitializeSelector(void* pSelector, const void* pState, size_t stateSize)
+    {
+        return static_cast<CarouselSelector*>(pSelector)->Initialize(pState, stateSize) ? 1 : 0;
+    }
+
+    void TickSelector(void* pSelector, float dtSeconds)
     {
-        const float cardX = kInitialCardX + static_cast<float>(i * (kInitialCardWidth + kGameCardPaddingX));
-        m_pApp->Selector_SetCardPosition(i, cardX, cardY, cardZ);
-        m_pApp->Selector_SetCardDimensions(i, kInitialCardWidth, kInitialCardHeight);
+        static_cast<CarouselSelector*>(pSelector)->Tick(dtSeconds);
+    }
 
-        // TODO: SetCardAppearanceParam shouldn't require a pointer argument for the uniform value
-        float& TintValue = (i == MiddleCardIndex) ? UnTinted : Tinted;
-        m_pApp->Selector_SetCardAppearanceParam1f(i, "tint", &TintValue);
+    void HandleSelectorInputEvent(void* pSelector, const FdnSelectorInputEvent* pEvent)
+    {
+        static_cast<CarouselSelector*>(pSelector)->HandleInputEvent(*pEvent);
+    }
 
-        GameInfo gameInfo;
-        if (!m_pApp->Selector_GetCardGameInfo(i, &gameInfo))
+    void HandleSelectorDisplayResized(void* pSelector, uint32_t width, uint32_t height)
+    {
+        static_cast<CarouselSelector*>(pSelector)->HandleDisplayResized(width, height);
+    }
+
+    size_t SaveSelectorState(void* pSelector, void* pStateOut, size_t stateCapacity)
+    {
+        return static_cast<CarouselSelector*>(pSelector)->SaveState(pStateOut, stateCapacity);
+    }
+
+    const FdnSelectorApi kCarouselSelectorApi =
+    {
+        FDN_SELECTOR_API_VERSION,
+        sizeof(FdnSelectorApi),
+        "carousel",
+        CreateSelector,
+        DestroySelector,
+        InitializeSelector,
+        TickSelector,
+        HandleSelectorInputEvent,
+        HandleSelectorDisplayResized,
+        SaveSelectorState
+    };
+}
+
+CarouselSelector::CarouselSelector(const FdnHostApi* pHostApi)
+    : m_pHostApi(pHostApi), m_pHost(pHostApi->pHost)
+{
+}
+
+const FdnSelectorApi* CarouselSelector::GetSelectorApi()
+{
+    return &kCarouselSelectorApi;
+}
+
+bool CarouselSelector::Initialize(const void* pState, size_t stateSize)
+{
+    m_pHostApi->GetDisplayDimensions(m_pHost, &m_displayWidth, &m_displayHeight);
+
+    // Anything from an incompatible build is ignored rather than trusted
+    CarouselState state;
+    if (pState && stateSize == sizeof(state))
+    {
+        std::memcpy(&state, pState, sizeof(state));
+        if (state.Magic == CarouselState::kMagic && state.Version == CarouselState::kVersion)
         {
-            continue;
+            if (state.LibraryView != m_pHostApi->GetLibraryView(m_pHost))
+            {
+                m_pHostApi->SetLibraryView(m_pHost, state.LibraryView);
+            }
+
+            const uint32_t NumCards = m_pHostApi->GetNumCards(m_pHost);
+            LayoutCards(std::min(state.SelectedIndex, NumCards > 0 ? NumCards - 1 : 0));
+            return true;
         }
-        
-        // We're using 600x900 textures for the carousel
-        const std::string CardTexture = gameInfo.TexturePrefix + "_600x900";
-        m_pApp->Selector_SetCardTexture(i, CardTexture.c_str());
     }
 
-    m_pApp->Selector_SelectIndex(MiddleCardIndex);
-    SnapCameraToCard(MiddleCardIndex);
+    LayoutCards(m_pHostApi->GetNumCards(m_pHost) / 2);
     return true;
 }
 
-void CarouselSelector::Tick(float dtSeconds)
+size_t CarouselSelector::SaveState(void* pStateOut, size_t stateCapacity) const
 {
-    SelectorEvent event;
-    while (m_pEventPump->GetNextEvent(&event))
+    CarouselState state;
+    state.Magic = CarouselState::kMagic;
+    state.Version = CarouselState::kVersion;
+    state.LibraryView = m_pHostApi->GetLibraryView(m_pHost);
+    state.SelectedIndex = m_pHostApi->GetSelectedIndex(m_pHost);
+    if (pStateOut && stateCapacity >= sizeof(state))
     {
-        switch(event.EventType)
-        {
-            case SelectorEventType::Input:
-                HandleInputEvent(event.EventPayload.InputEventPayload);
-                break;
-            default:
-                break;
-        }
+        std::memcpy(pStateOut, &state, sizeof(state));
     }
+
+    return sizeof(state);
 }
 
-void CarouselSelector::HandleInputEvent(const SelectorInputEventPayload& inputEventPayload)
+void CarouselSelector::LayoutCards(uint32_t selectedCardIndex)
 {
-    switch(inputEventPayload.InputEventType)
+    const uint32_t NumCards = m_pHostApi->GetNumCards(m_pHost);
+    if (NumCards == 0)
     {
-        case SelectorInputEventType::NextSelection:
-        {
-            const uint32_t NumCards = m_pApp->Selector_GetNumCards();
-            const uint32_t CurrentCardIndex = m_pApp->Selector_GetSelectedIndex();
+        return;
+    }
+    FdnCardLayout layout;
+    layout.Kind = FDN_CARD_LAYOUT_ROW;
+    layout.CardWidth = static_cast<float>(kInitialCardWidth);
+    layout.CardHeight = static_cast<float>(kInitialCardHeight);
+    layout.SpacingX = kGameCardPaddingX;
+    layout.SpacingY = 0.f;
+    layout.NumColumns = 1;
+    layout.WheelRadius = 0.f;
+    layout.WheelAngleStep = 0.f;
+    m_pHostApi->SetCardLayout(m_pHost, &layout);
 
-            if (CurrentCardIndex < (NumCards - 1))
-            {
-                const uint32_t NewSelectedIndex = CurrentCardIndex + 1;
-                m_pApp->Selector_SelectIndex(NewSelectedIndex);
-                m_pApp->Selector_SetCardAppearanceParam1f(CurrentCardIndex, "tint", &Tinted);
-                m_pApp->Selector_SetCardAppearanceParam1f(NewSelectedIndex, "tint", &UnTinted);
+    // Textures are all that's left to hand over per card, in one bulk call
+    m_layoutTextureHandles.resize(NumCards);
+    for (uint32_t i = 0; i < NumCards; ++i)
+    {
+        FdnCardInfo cardInfo;
+        m_layoutTextureHandles[i] =
+            m_pHostApi->GetCardInfo(m_pHost, i, &cardInfo) ? cardInfo.CardTextureHandle : FDN_INVALID_TEXTURE_HANDLE;
+    }
 
-                MoveCameraToCard(NewSelectedIndex);
-            }
+    m_pHostApi->SetCardRangeTextures(m_pHost, 0, NumCards, m_layoutTextureHandles.data(), sizeof(FdnTextureHandle));
+
+    m_pHostApi->SetCardRangeAppearanceParam1f(m_pHost, 0, NumCards, "tint", &Tinted, 0 /* strideBytes */);
+    m_pHostApi->SetCardAppearanceParam1f(m_pHost, selectedCardIndex, "tint", &UnTinted);
+
+    m_pHostApi->SelectIndex(m_pHost, selectedCardIndex);
+    m_pHostApi->SetCardLayoutScroll(m_pHost, static_cast<float>(selectedCardIndex));
+    CentreCamera();
+}
+
+void CarouselSelector::CycleLibraryView()
+{
+    // Skip over views which have no entries, e.g. when nothing is supported
+    const uint32_t NumViews = m_pHostApi->GetNumLibraryViews(m_pHost);
+    const uint32_t CurrentView = m_pHostApi->GetLibraryView(m_pHost);
+    for (uint32_t i = 1; i < NumViews; ++i)
+    {
+        if (m_pHostApi->SetLibraryView(m_pHost, (CurrentView + i) % NumViews))
+        {
+            LayoutCards(m_pHostApi->GetNumCards(m_pHost) / 2);
+            return;
         }
+    }
+}
+
+void CarouselSelector::Tick(float /* dtSeconds */)
+{
+}
+
+void CarouselSelector::HandleDisplayResized(uint32_t width, uint32_t height)
+{
+    m_displayWidth = width;
+    m_displayHeight = height;
+
+    // Keep the selection centred
+    CentreCamera();
+}
+
+void CarouselSelector::HandleInputEvent(const FdnSelectorInputEvent& inputEvent)
+{
+    // Coalesced moves are applied in one step, so a burst of repeats costs a
+    // single tint swap and scroll retarget
+    const uint64_t Count = inputEvent.Count;
+    switch(inputEvent.InputEventType)
+    {
+        case FDN_SELECTOR_INPUT_NEXT_SELECTION:
+            SelectCard(GetIndexAfter(Count));
+            break;
+        case FDN_SELECTOR_INPUT_PREVIOUS_SELECTION:
+            SelectCard(GetIndexBefore(Count));
             break;
-        case SelectorInputEventType::PreviousSelection:
+        case FDN_SELECTOR_INPUT_NEXT_PAGE:
+            SelectCard(GetIndexAfter(Count * GetCardsPerPage()));
+            break;
+        case FDN_SELECTOR_INPUT_PREVIOUS_PAGE:
+            SelectCard(GetIndexBefore(Count * GetCardsPerPage()));
+            break;
+        case FDN_SELECTOR_INPUT_SEARCH:
         {
-            const uint32_t CurrentCardIndex = m_pApp->Selector_GetSelectedIndex();
-
-            if (CurrentCardIndex > 0)
+            uint32_t cardIndex = m_pHostApi->GetSelectedIndex(m_pHost);
+            for (uint64_t i = 0; i < Count; ++i)
             {
-                const uint32_t NewSelectedIndex = CurrentCardIndex - 1;
-                m_pApp->Selector_SelectIndex(NewSelectedIndex);
-                m_pApp->Selector_SetCardAppearanceParam1f(CurrentCardIndex, "tint", &Tinted);
-                m_pApp->Selector_SetCardAppearanceParam1f(NewSelectedIndex, "tint", &UnTinted);
-
-                MoveCameraToCard(NewSelectedIndex);
+                const uint32_t NextCardIndex = FindNextInitialLetter(cardIndex);
+                if (NextCardIndex == cardIndex)
+                {
+                    break;
+                }
+                cardIndex = NextCardIndex;
             }
+            SelectCard(cardIndex);
         }
             break;
-        case SelectorInputEventType::ConfirmCurrent:
-            // TODO
+        case FDN_SELECTOR_INPUT_CONFIRM_CURRENT:
+            // Confirming updates launch stats, which can reorder the view.
+            m_pHostApi->ConfirmCurrentSelection(m_pHost);
+            LayoutCards(m_pHostApi->GetSelectedIndex(m_pHost));
+            break;
+        case FDN_SELECTOR_INPUT_NEXT_LIBRARY_VIEW:
+            CycleLibraryView();
             break;
         default:
             break;
     }
+
+    // Whatever changed will be in the next presented frame
+    m_pHostApi->AcknowledgeInput(m_pHost, inputEvent.TimestampNs);
 }
 
-void CarouselSelector::MoveCameraToCard(uint32_t cardIndex)
+void CarouselSelector::SelectCard(uint32_t cardIndex)
 {
-    glm::vec3 newSelectedCardPosition;
-    if (m_pApp->Selector_GetCardPosition(cardIndex, &newSelectedCardPosition))
+    const uint32_t CurrentCardIndex = m_pHostApi->GetSelectedIndex(m_pHost);
+    if (cardIndex == CurrentCardIndex)
     {
-        uint32_t width;
-        uint32_t height;
-        m_pApp->Selector_GetDisplayDimensions(&width, &height);
-
-        // TODO: account for current camera position
-        newSelectedCardPosition[0] += kInitialCardWidth / 2.f - static_cast<float>(width) / 2.f;
-        newSelectedCardPosition[1] += kInitialCardHeight / 2.f - static_cast<float>(height) / 2.f;
-        newSelectedCardPosition[2] = 1.f;
-        m_pApp->Selector_SetCameraTarget(newSelectedCardPosition);
+        return;
     }
+
+    m_pHostApi->SelectIndex(m_pHost, cardIndex);
+    m_pHostApi->SetCardAppearanceParam1f(m_pHost, CurrentCardIndex, "tint", &Tinted);
+    m_pHostApi->SetCardAppearanceParam1f(m_pHost, cardIndex, "tint", &UnTinted);
+
+    m_pHostApi->SetCardLayoutScrollTarget(m_pHost, static_cast<float>(cardIndex));
 }
 
-void CarouselSelector::SnapCameraToCard(uint32_t cardIndex)
+uint32_t CarouselSelector::GetIndexAfter(uint64_t numCards)
 {
-    glm::vec3 newSelectedCardPosition;
-    if (m_pApp->Selector_GetCardPosition(cardIndex, &newSelectedCardPosition))
+    const uint64_t LastCardIndex = m_pHostApi->GetNumCards(m_pHost) - 1;
+    const uint64_t CurrentCardIndex = m_pHostApi->GetSelectedIndex(m_pHost);
+    return static_cast<uint32_t>(std::min(CurrentCardIndex + numCards, LastCardIndex));
+}
+
+uint32_t CarouselSelector::GetIndexBefore(uint64_t numCards)
+{
+    const uint64_t CurrentCardIndex = m_pHostApi->GetSelectedIndex(m_pHost);
+    return static_cast<uint32_t>(CurrentCardIndex > numCards ? CurrentCardIndex - numCards : 0);
+}
+
+uint32_t CarouselSelector::GetCardsPerPage()
+{
+    const uint32_t CardsPerPage = static_cast<uint32_t>(m_displayWidth / (kInitialCardWidth + kGameCardPaddingX));
+    return std::max<uint32_t>(CardsPerPage, 1);
+}
+
+uint32_t CarouselSelector::FindNextInitialLetter(uint32_t cardIndex)
+{
+    // A stick can't type, so search steps through initial letters instead,
+    // wrapping around at the end
+    const uint32_t NumCards = m_pHostApi->GetNumCards(m_pHost);
+    FdnCardInfo cardInfo;
+    if (!m_pHostApi->GetCardInfo(m_pHost, cardIndex, &cardInfo))
     {
-        uint32_t width;
-        uint32_t height;
-        m_pApp->Selector_GetDisplayDimensions(&width, &height);
+        return cardIndex;
+    }
 
-        // TODO: account for current camera position
-        newSelectedCardPosition[0] += kInitialCardWidth / 2.f - static_cast<float>(width) / 2.f;
-        newSelectedCardPosition[1] += kInitialCardHeight / 2.f - static_cast<float>(height) / 2.f;
-        newSelectedCardPosition[2] = 1.f;
-        m_pApp->Selector_SetCameraPosition(newSelectedCardPosition);
+    const int CurrentInitial = std::tolower(static_cast<unsigned char>(cardInfo.pTitle[0]));
+    for (uint32_t i = 1; i < NumCards; ++i)
+    {
+        const uint32_t CandidateIndex = (cardIndex + i) % NumCards;
+        if (!m_pHostApi->GetCardInfo(m_pHost, CandidateIndex, &cardInfo))
+        {
+            continue;
+        }
+
+        const int Initial = std::tolower(static_cast<unsigned char>(cardInfo.pTitle[0]));
+        if (Initial != CurrentInitial)
+        {
+            return CandidateIndex;
+        }
     }
-}
\ No newline at end of file
+
+    return cardIndex;
+}
+
+void CarouselSelector::CentreCamera()
+{
+    // The row scrolls the selected card to the origin
+    m_pHostApi->SetCameraPosition(
+        m_pHost,
+        static_cast<float>(m_displayWidth) / -2.f,
+        static_cast<float>(m_displayHeight) / -2.f,
+        1.f);
+}
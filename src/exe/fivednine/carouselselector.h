@@ -1,26 +1,53 @@
+// carouselselector.h
+//
+// The default selector: a row of cards with the selected one untinted and
+// centred. The row is laid out on the GPU, so moving the selection only
+// retargets the row's scroll; the camera stays put. It only talks to the
+// app through the selector C API (see selectorapi.h), so the same code is
+// built into the app and into the carousel plugin (src/exe/carouselplugin)
+// for hot-reloading.
+
 #pragma once
 
-#include "selectorevent.h"
+#include "selectorapi.h"
 #include <cstddef>
 #include <cstdint>
-
-struct GameInfo;
-class  EventPump;
-class  fivednineApp;
+#include <vector>
 
 class CarouselSelector
 {
 public:
-    CarouselSelector(fivednineApp* pApp, EventPump* pEventPump);
-    bool Initialize();
+    explicit CarouselSelector(const FdnHostApi* pHostApi);
+
+    // pState is from SaveState, possibly by another build; null lays out
+    // from scratch
+    bool Initialize(const void* pState, size_t stateSize);
 
     void Tick(float dtSeconds);
+    void HandleInputEvent(const FdnSelectorInputEvent& inputEvent);
+    void HandleDisplayResized(uint32_t width, uint32_t height);
+    size_t SaveState(void* pStateOut, size_t stateCapacity) const;
+
+    // Function table for the carousel, whether built in or exported by the
+    // plugin
+    static const FdnSelectorApi* GetSelectorApi();
 
 private:
-    void HandleInputEvent(const SelectorInputEventPayload& inputEventPayload);
-    void MoveCameraToCard(uint32_t cardIndex);
-    void SnapCameraToCard(uint32_t cardIndex);
+    void LayoutCards(uint32_t selectedCardIndex);
+    void CycleLibraryView();
+    void SelectCard(uint32_t cardIndex);
+    uint32_t GetIndexAfter(uint64_t numCards);
+    uint32_t GetIndexBefore(uint64_t numCards);
+    uint32_t GetCardsPerPage();
+    uint32_t FindNextInitialLetter(uint32_t cardIndex);
+    void CentreCamera();
+
+    const FdnHostApi* m_pHostApi = nullptr;
+    void*             m_pHost = nullptr;
+
+    // Scratch for LayoutCards, kept to reuse the allocations
+    std::vector<FdnTextureHandle> m_layoutTextureHandles;
 
-    fivednineApp* m_pApp = nullptr;
-    EventPump*    m_pEventPump = nullptr;
-};
\ No newline at end of file
+    uint32_t m_displayWidth = 0;
+    uint32_t m_displayHeight = 0;
+};
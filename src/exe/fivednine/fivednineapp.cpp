@@ -1,73 +1,221 @@
 #include "fivednineapp.h"
 #include "appconfig.h"
+#include "carouselselector.h"
+#include "gamesdb.h"
 
 #include <algorithm>
 #include <filesystem>
 #include <vector>
 #include <fstream>
 #include <sstream>
-
-#include <json/json.hpp>
+#include <type_traits>
 
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <fivednine/render/window.h>
 #include <fivednine/log/log.h>
 #include <fivednine/log/check.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/system/memory.h>
+#include <fivednine/system/time.h>
 
-using json = nlohmann::json;
 using namespace fivednine;
 using namespace fivednine::render;
 
-namespace 
+namespace
 {
-    bool IsTextureAssetPath(const std::filesystem::path& filePath)
+    void LogMemoryUsage(const char* pStage)
+    {
+        constexpr double BytesPerMiB = 1024.0 * 1024.0;
+        RELEASE_LOGLINE_INFO(
+            LOG_DEFAULT,
+            "%s: RSS %.1f MiB, peak RSS %.1f MiB",
+            pStage,
+            system::memory::GetCurrentRssBytes() / BytesPerMiB,
+            system::memory::GetPeakRssBytes() / BytesPerMiB);
+    }
+
+    // Element i of a caller's array with strideBytes between elements
+    template<typename T>
+    T* StridedElement(T* pFirst, size_t strideBytes, uint32_t i)
+    {
+        typedef std::conditional_t<std::is_const_v<T>, const uint8_t, uint8_t> ByteType;
+        return reinterpret_cast<T*>(reinterpret_cast<ByteType*>(pFirst) + strideBytes * i);
+    }
+
+    // FdnHostApi entry points, each forwarding to the app's Selector_* call
+    static_assert(std::is_same_v<FdnTextureHandle, TextureHandle>, "Texture handles pass straight through");
+
+    fivednineApp* AppFromHost(void* pHost)
+    {
+        return static_cast<fivednineApp*>(pHost);
+    }
+
+    void ResetHostForSelector(void* pUserPointer)
+    {
+        AppFromHost(pUserPointer)->Selector_ResetCards();
+    }
+
+    uint32_t HostGetNumCards(void* pHost)
+    {
+        return AppFromHost(pHost)->Selector_GetNumCards();
+    }
+
+    void HostSelectIndex(void* pHost, uint32_t index)
+    {
+        AppFromHost(pHost)->Selector_SelectIndex(index);
+    }
+
+    uint32_t HostGetSelectedIndex(void* pHost)
     {
-        // Just supports png files for the moment
-        return filePath.extension() == ".png";
+        return AppFromHost(pHost)->Selector_GetSelectedIndex();
     }
 
-    bool IsShaderAssetPath(const std::filesystem::path& filePath)
+    void HostConfirmCurrentSelection(void* pHost)
     {
-        // glsl only
-        return filePath.extension() == ".glsl";
+        AppFromHost(pHost)->Selector_ConfirmCurrentSelection();
     }
 
-    bool 
-    ShaderProgramNameAndShaderTypeFromFilePath(
-        const std::filesystem::path& filePath,
-        std::string* pProgramNameOut,
-        std::string* pShaderTypeOut)
+    void HostAcknowledgeInput(void* pHost, uint64_t inputTimestampNs)
     {
-        RELEASE_CHECK(pProgramNameOut != nullptr, "pProgramNameOut cannot be null");
-        *pProgramNameOut = "";
+        AppFromHost(pHost)->Selector_AcknowledgeInput(inputTimestampNs);
+    }
 
-        RELEASE_CHECK(pShaderTypeOut != nullptr, "pShaderTypeOut cannot be null");
-        *pShaderTypeOut = "";
+    uint32_t HostGetNumLibraryViews(void* /* pHost */)
+    {
+        return static_cast<uint32_t>(LibraryView::Max);
+    }
 
-        const std::string StemString = filePath.stem().string();
+    uint32_t HostGetLibraryView(void* pHost)
+    {
+        return static_cast<uint32_t>(AppFromHost(pHost)->Selector_GetLibraryView());
+    }
 
-        // The expected format is <programname>_<shadertype>.<extension>
-        const size_t LastUnderscoreIndex = StemString.find_last_of('_');
-        if (LastUnderscoreIndex == std::string::npos)
+    int HostSetLibraryView(void* pHost, uint32_t view)
+    {
+        return AppFromHost(pHost)->Selector_SetLibraryView(static_cast<LibraryView>(view));
+    }
+
+    void HostGetDisplayDimensions(void* pHost, uint32_t* pWidthOut, uint32_t* pHeightOut)
+    {
+        AppFromHost(pHost)->Selector_GetDisplayDimensions(pWidthOut, pHeightOut);
+    }
+
+    int HostGetCardInfo(void* pHost, uint32_t index, FdnCardInfo* pCardInfoOut)
+    {
+        return AppFromHost(pHost)->Selector_GetCardInfo(index, pCardInfoOut);
+    }
+
+    int HostGetCardPosition(void* pHost, uint32_t index, float* pPositionOut)
+    {
+        glm::vec3 cardPosition;
+        if (!pPositionOut || !AppFromHost(pHost)->Selector_GetCardPosition(index, &cardPosition))
         {
-            RELEASE_LOG_WARNING(
-                LOG_DEFAULT,
-                "Improperly named shader: %s",
-                filePath.c_str());
-                return false;
+            return 0;
         }
 
-        *pProgramNameOut = StemString.substr(0, LastUnderscoreIndex);
-        *pShaderTypeOut = StemString.substr(LastUnderscoreIndex + 1);
-        return true;
+        pPositionOut[0] = cardPosition.x;
+        pPositionOut[1] = cardPosition.y;
+        pPositionOut[2] = cardPosition.z;
+        return 1;
+    }
+
+    int HostSetCardAppearanceParam1f(void* pHost, uint32_t index, const char* pParameterName, float* pValue)
+    {
+        return AppFromHost(pHost)->Selector_SetCardAppearanceParam1f(index, pParameterName, pValue);
+    }
+
+    int HostSetCardRangePositions(void* pHost, uint32_t firstIndex, uint32_t numCards, const float* pPositions, size_t strideBytes)
+    {
+        return AppFromHost(pHost)->Selector_SetCardRangePositions(firstIndex, numCards, pPositions, strideBytes);
+    }
+
+    int HostSetCardRangeDimensions(void* pHost, uint32_t firstIndex, uint32_t numCards, const float* pDimensions, size_t strideBytes)
+    {
+        return AppFromHost(pHost)->Selector_SetCardRangeDimensions(firstIndex, numCards, pDimensions, strideBytes);
+    }
+
+    int
+    HostSetCardRangeAppearanceParam1f(
+        void* pHost,
+        uint32_t firstIndex,
+        uint32_t numCards,
+        const char* pParameterName,
+        float* pValues,
+        size_t strideBytes)
+    {
+        return AppFromHost(pHost)->Selector_SetCardRangeAppearanceParam1f(
+            firstIndex, numCards, pParameterName, pValues, strideBytes);
+    }
+
+    int
+    HostSetCardRangeTextures(
+        void* pHost,
+        uint32_t firstIndex,
+        uint32_t numCards,
+        const FdnTextureHandle* pTextureHandles,
+        size_t strideBytes)
+    {
+        return AppFromHost(pHost)->Selector_SetCardRangeTextures(firstIndex, numCards, pTextureHandles, strideBytes);
+    }
+
+    FdnTextureHandle HostFindTextureHandle(void* pHost, const char* pTextureName)
+    {
+        return AppFromHost(pHost)->Selector_FindTextureHandle(pTextureName);
+    }
+
+    void HostSetCameraPosition(void* pHost, float x, float y, float z)
+    {
+        AppFromHost(pHost)->Selector_SetCameraPosition(glm::vec3(x, y, z));
+    }
+
+    void HostSetCameraTarget(void* pHost, float x, float y, float z)
+    {
+        AppFromHost(pHost)->Selector_SetCameraTarget(glm::vec3(x, y, z));
+    }
+
+    static_assert(static_cast<uint32_t>(CardLayoutKind::PerCard) == FDN_CARD_LAYOUT_PER_CARD &&
+                  static_cast<uint32_t>(CardLayoutKind::Row) == FDN_CARD_LAYOUT_ROW &&
+                  static_cast<uint32_t>(CardLayoutKind::Grid) == FDN_CARD_LAYOUT_GRID &&
+                  static_cast<uint32_t>(CardLayoutKind::Wheel) == FDN_CARD_LAYOUT_WHEEL,
+                  "Card layout kinds are passed through as is");
+
+    int HostSetCardLayout(void* pHost, const FdnCardLayout* pLayout)
+    {
+        if (!pLayout)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_API, "pLayout cannot be null");
+            return 0;
+        }
+
+        CardLayoutParams layout;
+        layout.Kind = static_cast<CardLayoutKind>(pLayout->Kind);
+        layout.CardSize = glm::vec2(pLayout->CardWidth, pLayout->CardHeight);
+        layout.Spacing = glm::vec2(pLayout->SpacingX, pLayout->SpacingY);
+        layout.NumColumns = static_cast<int32_t>(pLayout->NumColumns);
+        layout.WheelRadius = pLayout->WheelRadius;
+        layout.WheelAngleStep = pLayout->WheelAngleStep;
+        return AppFromHost(pHost)->Selector_SetCardLayout(layout);
+    }
+
+    void HostSetCardLayoutScroll(void* pHost, float scrollOffset)
+    {
+        AppFromHost(pHost)->Selector_SetCardLayoutScroll(scrollOffset);
+    }
+
+    void HostSetCardLayoutScrollTarget(void* pHost, float scrollOffset)
+    {
+        AppFromHost(pHost)->Selector_SetCardLayoutScrollTarget(scrollOffset);
     }
 }
 
 bool fivednineApp::Initialize(const AppConfig& configuration, Window* pWindow)
 {
+    PROFILE_SCOPE("fivednineApp::Initialize");
     RELEASE_CHECK(pWindow, "pWindow cannot be null");
     m_pWindow = pWindow;
+    m_startupTimings.clear();
+    m_startupStageStartNs = system::time::GetTicksNs();
 
     if (!configuration.GetIsParsed())
     {
@@ -75,53 +223,74 @@ bool fivednineApp::Initialize(const AppConfig& configuration, Window* pWindow)
         return false;
     }
 
+    LoadAssetCatalog(configuration);
+    EndStartupStage("LoadAssetCatalog");
+
     if (!LoadTextures(configuration))
     {
         return false;
     }
+    EndStartupStage("LoadTextures");
 
     if (!LoadShaders(configuration))
     {
         return false;
     }
+    EndStartupStage("LoadShaders");
+
+    SaveAssetCatalog(configuration);
+    EndStartupStage("SaveAssetCatalog");
+
+    // Launch stats are applied as games are loaded, so that the library views
+    // are built once.
+    LoadLaunchHistory(configuration);
+    EndStartupStage("LoadLaunchHistory");
 
     if (!LoadGamesInfo(configuration))
     {
         return false;
     }
+    SetInitialLibraryView(configuration);
+    EndStartupStage("LoadGamesInfo");
 
-    // Initialize projection matrix
-    // TODO: Decouple from window size
+    // Initialize projection matrix, which follows the window size
     uint32_t windowWidth, windowHeight;
     m_pWindow->GetWindowDimensions(&windowWidth, &windowHeight);
-    m_projectionMatrix = glm::ortho(
-        0.f, static_cast<float>(windowWidth),
-        static_cast<float>(windowHeight), 0.f,
-        0.1f, 1000.f
-    );
+    UpdateProjection(windowWidth, windowHeight);
 
     // Initialize camera
     m_camera.SetTranslation(glm::vec3(windowWidth / -2.f, windowHeight / -2.f, 1.f));
 
     // Initialize game cards
     ShaderPtr spGameCardShader = m_shaderStorage.FindShaderByName("gamecard");
-    for (uint32_t i = 0; i < m_numGameInfos; ++i)
+    m_cardPool.Initialize(spGameCardShader, &m_textureStorage, m_gameInfos.size());
+    EndStartupStage("CreateGameCards");
+
+    // Not fatal; the app is still usable without timing visuals
+    if (!m_frameTimeOverlay.Initialize(&m_textureStorage, spGameCardShader))
     {
-        m_gameCards.emplace_back(new GameCard(spGameCardShader));
-        RELEASE_CHECK(m_gameCards.back() != nullptr, "Failed to allocate game card");
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Failed to initialize frame time overlay");
     }
-    m_spSelector.reset(new CarouselSelector(this, &m_selectorEventPump));
-    RELEASE_CHECK(m_spSelector != nullptr, "Failed to allocate selector");
+    m_targetFrameMs = static_cast<float>(1000.0 / m_pWindow->GetRefreshRateHz(60.0));
 
-    if (!m_spSelector->Initialize())
+    if (!m_eventBus.Subscribe<SelectorInputEvent>(HandleSelectorInputEvent, this) ||
+        !m_eventBus.Subscribe<DisplayResizedEvent>(HandleDisplayResizedEvent, this))
     {
-        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to initialize selector");
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to subscribe to selector events");
         return false;
     }
 
-    // TODO: Factor out all of the input goo
-    m_pWindow->SetKeyStateChangedHandler(HandleKeypress);
+    if (!LoadSelector(configuration))
+    {
+        return false;
+    }
+    EndStartupStage("InitializeSelector");
+
+    m_pWindow->SetInputEventHandler(HandleInputEvent);
     m_pWindow->SetUserPointer(this);
+    m_pWindow->AddEventListener(HandleWindowEvent, this);
+
+    LogMemoryUsage("Initialized");
 
     m_isInitialized = true;
     return true;
@@ -129,22 +298,127 @@ bool fivednineApp::Initialize(const AppConfig& configuration, Window* pWindow)
 
 void fivednineApp::Tick(float dtSeconds)
 {
+    PROFILE_SCOPE("fivednineApp::Tick");
     RELEASE_CHECK(m_isInitialized, "Attempting to tick app without having initialized");
-    m_spSelector->Tick(dtSeconds);
+
+    // Repeats are posted ahead of dispatch so they're handled in the same
+    // step, as one event however many are due
+    input::ActionType repeatedAction;
+    const uint32_t NumRepeats = m_actionRepeater.Tick(dtSeconds, &repeatedAction);
+    if (NumRepeats > 0)
+    {
+        PostSelectorAction(repeatedAction, 0 /* timestampNs */, NumRepeats);
+    }
+
+    // Before dispatch, so that input goes to the selector it was meant for
+    m_selectorPlugin.ReloadIfChanged();
+
+    m_eventBus.Dispatch();
+    m_selectorPlugin.Tick(dtSeconds);
+
+    // Reported here since posting threads shouldn't be logging
+    const uint64_t NumDroppedEvents = m_eventBus.GetNumDroppedEvents();
+    if (NumDroppedEvents != m_numDroppedEventsReported)
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Event bus full, dropped %llu events",
+            static_cast<unsigned long long>(NumDroppedEvents - m_numDroppedEventsReported));
+        m_numDroppedEventsReported = NumDroppedEvents;
+    }
     m_camera.Tick(dtSeconds);
+    m_cardPool.Tick(dtSeconds);
+
+    if (m_launchHistory.IsOpen())
+    {
+        m_launchHistory.Update(LaunchHistory::GetCurrentTimestamp());
+    }
 }
 
-void fivednineApp::Draw()
+void fivednineApp::Draw(float interpolationAlpha)
 {
+    PROFILE_SCOPE("fivednineApp::Draw");
     RELEASE_CHECK(m_isInitialized, "Attempting to draw app without having initialized");
-    for (auto spGameCard : m_gameCards)
+    const glm::mat4 ViewMatrix = m_camera.InterpolatedViewMatrix4(interpolationAlpha);
+    m_cardPool.Draw(
+        *m_pActiveLibraryView,
+        m_currentSelectedCardIndex,
+        interpolationAlpha,
+        m_projectionMatrix,
+        ViewMatrix);
+
+    if (m_frameTimeOverlay.IsVisible())
+    {
+        uint32_t windowWidth, windowHeight;
+        m_pWindow->GetWindowDimensions(&windowWidth, &windowHeight);
+        m_frameTimeOverlay.Draw(m_frameTimings, m_targetFrameMs, windowWidth, windowHeight);
+    }
+}
+
+bool fivednineApp::IsIdle() const
+{
+    RELEASE_CHECK(m_isInitialized, "Attempting to query idle state without having initialized");
+    // The overlay graph scrolls every frame
+    return m_eventBus.IsEmpty() &&
+        !m_selectorPlugin.IsReloadPending() &&
+        !m_actionRepeater.IsRepeating() &&
+        !m_camera.IsMoving() &&
+        !m_cardPool.IsScrolling() &&
+        !m_cardPool.HasPendingTextures() &&
+        !m_frameTimeOverlay.IsVisible();
+}
+
+void fivednineApp::PrepareForIdle()
+{
+    // Launches are batched on a timer which won't fire while blocked
+    if (m_launchHistory.IsOpen())
+    {
+        m_launchHistory.Flush();
+    }
+}
+
+FrameTimings& fivednineApp::GetFrameTimings()
+{
+    return m_frameTimings;
+}
+
+void fivednineApp::OnFramePresented(uint64_t presentTimestampNs)
+{
+    for (uint64_t inputTimestampNs : m_unpresentedInputTimestampsNs)
     {
-        spGameCard->Draw(m_projectionMatrix, m_camera.ViewMatrix4());
+        const double LatencyMs =
+            static_cast<double>(presentTimestampNs - inputTimestampNs) / system::time::kNanosecondsPerMillisecond;
+        m_frameTimings.AddInputLatency(LatencyMs);
     }
+    m_unpresentedInputTimestampsNs.clear();
+
+    m_selectorPlugin.OnFramePresented(presentTimestampNs);
+}
+
+const std::vector<StartupStageTiming>& fivednineApp::GetStartupTimings() const
+{
+    return m_startupTimings;
+}
+
+uint64_t fivednineApp::GetEstimatedVramBytes() const
+{
+    return m_textureStorage.GetEstimatedVramBytes();
+}
+
+void fivednineApp::EndStartupStage(const char* pStageName)
+{
+    const uint64_t NowNs = system::time::GetTicksNs();
+    m_startupTimings.push_back({
+        pStageName,
+        static_cast<double>(NowNs - m_startupStageStartNs) / system::time::kNanosecondsPerMillisecond });
+    m_startupStageStartNs = NowNs;
+
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Startup stage %s: %.2f ms", pStageName, m_startupTimings.back().Milliseconds);
 }
 
 bool fivednineApp::LoadTextures(const AppConfig& configuration)
 {
+    PROFILE_SCOPE("fivednineApp::LoadTextures");
     // Load textures
     const std::string& TexturesPath = configuration.GetTexturesPath();
     if (!std::filesystem::exists(TexturesPath))
@@ -156,35 +430,59 @@ bool fivednineApp::LoadTextures(const AppConfig& configuration)
         return false;
     }
 
-    for (const auto& directoryEntry : std::filesystem::directory_iterator(TexturesPath))
+    const std::vector<AssetEntry>* pTextureAssets =
+        m_assetCatalog.GetDirectoryAssets(TexturesPath, AssetCatalog::AssetKind::Texture);
+    if (!pTextureAssets)
+    {
+        return false;
+    }
+
+    for (const AssetEntry& textureAsset : *pTextureAssets)
     {
-        const std::filesystem::path FilePath = directoryEntry.path();
-        if (directoryEntry.is_regular_file() && IsTextureAssetPath(FilePath))
+        const std::filesystem::path FilePath = textureAsset.Path;
+        const std::string& textureName = FilePath.stem().string();
+
+        // Covers are only loaded while a card in the pool's window shows
+        // them (see cardpool.h), so their memory doesn't grow with the
+        // library
+        if (textureName.ends_with(kCardTextureSuffix))
         {
-            const std::string& textureName = FilePath.stem().string();
-            if (!m_textureStorage.AddTextureFromImagePath(FilePath.c_str(), textureName))
+            if (m_textureStorage.AddStreamedTextureFromImagePath(FilePath.c_str(), textureName) == kInvalidTextureHandle)
             {
                 RELEASE_LOGLINE_WARNING(
                     LOG_DEFAULT,
                     "Failed to add texture from file %s",
                     FilePath.c_str());
             }
-            else
-            {
-                RELEASE_LOGLINE_INFO(
-                    LOG_DEFAULT,
-                    "Successfully added texture %s",
-                    textureName.c_str()
-                );
-            }
+            continue;
+        }
+
+        if (!m_textureStorage.AddTextureFromImagePath(FilePath.c_str(), textureName))
+        {
+            RELEASE_LOGLINE_WARNING(
+                LOG_DEFAULT,
+                "Failed to add texture from file %s",
+                FilePath.c_str());
+        }
+        else
+        {
+            RELEASE_LOGLINE_INFO(
+                LOG_DEFAULT,
+                "Successfully added texture %s",
+                textureName.c_str()
+            );
         }
     }
 
+    m_textureStorage.ReleaseStagingMemory();
+    LogMemoryUsage("Textures loaded");
+
     return true;
 }
 
 bool fivednineApp::LoadShaders(const AppConfig& configuration)
 {
+    PROFILE_SCOPE("fivednineApp::LoadShaders");
     // Load shaders
     const std::string& ShadersPath = configuration.GetShadersPath();
     if (!std::filesystem::exists(ShadersPath))
@@ -209,45 +507,48 @@ bool fivednineApp::LoadShaders(const AppConfig& configuration)
     std::vector<ShaderProgramLookup> shaderLookupStates;
 
     // Find shader files in the target directory
-    for (const auto& directoryEntry : std::filesystem::directory_iterator(ShadersPath))
+    const std::vector<AssetEntry>* pShaderAssets =
+        m_assetCatalog.GetDirectoryAssets(ShadersPath, AssetCatalog::AssetKind::Shader);
+    if (!pShaderAssets)
     {
-        const std::filesystem::path FilePath = directoryEntry.path();
-        if (directoryEntry.is_regular_file() && IsShaderAssetPath(FilePath))
+        return false;
+    }
+
+    for (const AssetEntry& shaderAsset : *pShaderAssets)
+    {
+        const std::string& ProgramName = shaderAsset.ShaderProgramName;
+        if (ProgramName.empty())
         {
-            std::string programName;
-            std::string shaderType;
-            if (!ShaderProgramNameAndShaderTypeFromFilePath(FilePath, &programName, &shaderType))
-            {
-                continue;
-            }
+            // Improperly named, warned about when cataloged
+            continue;
+        }
 
-            auto it = std::find_if(std::begin(shaderLookupStates), std::end(shaderLookupStates),
-                [programName](const ShaderProgramLookup& lookup) -> bool
-                {
-                    return lookup.ProgramName == programName;
-                }
-            );
-            if (it == std::end(shaderLookupStates))
+        auto it = std::find_if(std::begin(shaderLookupStates), std::end(shaderLookupStates),
+            [&ProgramName](const ShaderProgramLookup& lookup) -> bool
             {
-                shaderLookupStates.emplace_back(programName);
-                it = std::end(shaderLookupStates) - 1;
+                return lookup.ProgramName == ProgramName;
             }
+        );
+        if (it == std::end(shaderLookupStates))
+        {
+            shaderLookupStates.emplace_back(ProgramName);
+            it = std::end(shaderLookupStates) - 1;
+        }
 
-            if (shaderType == "vert")
-            {
-                it->VertexShaderPath = FilePath.string();
-            }
-            else if (shaderType == "frag")
-            {
-                it->FragmentShaderPath = FilePath.string();
-            }
-            else
-            {
-                RELEASE_LOGLINE_WARNING(
-                    LOG_DEFAULT,
-                    "Unexpected shader type for file %s",
-                    FilePath.string().c_str());
-            }
+        if (shaderAsset.ShaderType == "vert")
+        {
+            it->VertexShaderPath = shaderAsset.Path;
+        }
+        else if (shaderAsset.ShaderType == "frag")
+        {
+            it->FragmentShaderPath = shaderAsset.Path;
+        }
+        else
+        {
+            RELEASE_LOGLINE_WARNING(
+                LOG_DEFAULT,
+                "Unexpected shader type for file %s",
+                shaderAsset.Path.c_str());
         }
     }
 
@@ -318,83 +619,58 @@ bool fivednineApp::LoadShaders(const AppConfig& configuration)
     return true;
 }
 
-bool fivednineApp::LoadGamesInfo(const AppConfig& configuration)
+void fivednineApp::LoadAssetCatalog(const AppConfig& configuration)
 {
-    const std::string& GamesDBPath = configuration.GetGamesDbPath();
-    if (!std::filesystem::exists(GamesDBPath))
+    PROFILE_SCOPE("fivednineApp::LoadAssetCatalog");
+    // Without a configured catalog path everything is scanned each run
+    const std::string& AssetCatalogPath = configuration.GetAssetCatalogPath();
+    if (AssetCatalogPath.empty())
     {
-        RELEASE_LOGLINE_ERROR(
-            LOG_DEFAULT,
-            "Games database configuration path does not exist: %s",
-            GamesDBPath.c_str());
-        return false;
+        return;
     }
 
-    std::ifstream gamesDbIn(GamesDBPath);
-    json gamesDbData = json::parse(gamesDbIn);
-    if (!gamesDbData.contains("games"))
+    m_assetCatalog.Load(AssetCatalogPath);
+}
+
+void fivednineApp::SaveAssetCatalog(const AppConfig& configuration)
+{
+    const std::string& AssetCatalogPath = configuration.GetAssetCatalogPath();
+    if (AssetCatalogPath.empty())
     {
-        RELEASE_LOGLINE_ERROR(
-            LOG_DEFAULT,
-            "Games database missing required field 'games': %s",
-            GamesDBPath.c_str());
-        return false;
+        return;
     }
 
-    // Again, defer failure so we can log as much info as possible
-    bool failedParseGames = false;
-    json gamesArray = gamesDbData["games"];
-    for (const auto& gameEntry : gamesArray)
-    {
-        if (m_numGameInfos >= kMaxGameInfoEntries)
-        {
-            // Don't fail here, but do log a warning.
-            RELEASE_LOGLINE_WARNING(
-                LOG_DEFAULT,
-                "Reached maximum number of supported selectable games. Stopping.");
-            return true;
-        }
+    // Not fatal; the next run will just rescan
+    m_assetCatalog.Save(AssetCatalogPath);
+}
 
-        GameInfo gameInfo;
-        if (!gameEntry.contains("title"))
-        {
-            RELEASE_LOGLINE_ERROR(
-                LOG_DEFAULT,
-                "Game DB entry is missing required field: 'title'");
-            failedParseGames = true;
-            continue;
-        }
-        gameInfo.Title = gameEntry["title"].get<std::string>();
+bool fivednineApp::LoadGamesInfo(const AppConfig& configuration)
+{
+    PROFILE_SCOPE("fivednineApp::LoadGamesInfo");
+    uint32_t numSkipped = 0;
+    if (!LoadGamesDb(configuration.GetGamesDbPath(), &m_gameInfos, &numSkipped))
+    {
+        return false;
+    }
 
-        if (!gameEntry.contains("alias"))
+    for (size_t gameIndex = 0; gameIndex < m_gameInfos.size(); ++gameIndex)
+    {
+        GameInfo& gameInfo = m_gameInfos[gameIndex];
+        if (const LaunchStats* pLaunchStats = m_launchHistory.FindStats(gameInfo.Alias))
         {
-            RELEASE_LOGLINE_ERROR(
-                LOG_DEFAULT,
-                "Game DB entry %s is missing required field: 'alias'",
-                gameInfo.Title.c_str());
-            failedParseGames = true;
-            continue;
+            gameInfo.LaunchCount = pLaunchStats->LaunchCount;
+            gameInfo.LastLaunchedTime = pLaunchStats->LastLaunchedTime;
         }
-        gameInfo.Alias = gameEntry["alias"].get<std::string>();
 
-        if (!gameEntry.contains("texture_prefix"))
-        {
-            RELEASE_LOGLINE_ERROR(
-                LOG_DEFAULT,
-                "Game DB entry %s is missing required field: 'texture_prefix'",
-                gameInfo.Title.c_str());
-            failedParseGames = true;
-            continue;
-        }
-        gameInfo.TexturePrefix = gameEntry["texture_prefix"].get<std::string>();
+        // Resolved here once rather than by name on every layout
+        gameInfo.CardTextureHandle = m_textureStorage.FindTextureHandle(gameInfo.TexturePrefix + kCardTextureSuffix);
 
-        m_gameInfoArray[m_numGameInfos] = gameInfo;
-        ++m_numGameInfos;
+        m_libraryViews.AddGame(static_cast<uint32_t>(gameIndex), gameInfo);
     }
 
-    if (failedParseGames)
+    if (numSkipped > 0)
     {
-        if (m_numGameInfos == 0)
+        if (m_gameInfos.empty())
         {
             RELEASE_LOGLINE_ERROR(
                 LOG_DEFAULT,
@@ -414,15 +690,129 @@ bool fivednineApp::LoadGamesInfo(const AppConfig& configuration)
     return true;
 }
 
+void fivednineApp::LoadLaunchHistory(const AppConfig& configuration)
+{
+    PROFILE_SCOPE("fivednineApp::LoadLaunchHistory");
+    const std::string& LaunchHistoryPath = configuration.GetLaunchHistoryPath();
+    if (LaunchHistoryPath.empty())
+    {
+        return;
+    }
+
+    // Not fatal; we just won't have recency or popularity ordering.
+    if (!m_launchHistory.Open(LaunchHistoryPath))
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Failed to open launch history %s. Launches will not be recorded.",
+            LaunchHistoryPath.c_str());
+    }
+}
+
+bool fivednineApp::LoadSelector(const AppConfig& configuration)
+{
+    PROFILE_SCOPE("fivednineApp::LoadSelector");
+    m_selectorHostApi = FdnHostApi();
+    m_selectorHostApi.Version = FDN_SELECTOR_API_VERSION;
+    m_selectorHostApi.Size = sizeof(FdnHostApi);
+    m_selectorHostApi.pHost = this;
+    m_selectorHostApi.GetNumCards = HostGetNumCards;
+    m_selectorHostApi.SelectIndex = HostSelectIndex;
+    m_selectorHostApi.GetSelectedIndex = HostGetSelectedIndex;
+    m_selectorHostApi.ConfirmCurrentSelection = HostConfirmCurrentSelection;
+    m_selectorHostApi.AcknowledgeInput = HostAcknowledgeInput;
+    m_selectorHostApi.GetNumLibraryViews = HostGetNumLibraryViews;
+    m_selectorHostApi.GetLibraryView = HostGetLibraryView;
+    m_selectorHostApi.SetLibraryView = HostSetLibraryView;
+    m_selectorHostApi.GetDisplayDimensions = HostGetDisplayDimensions;
+    m_selectorHostApi.GetCardInfo = HostGetCardInfo;
+    m_selectorHostApi.GetCardPosition = HostGetCardPosition;
+    m_selectorHostApi.SetCardAppearanceParam1f = HostSetCardAppearanceParam1f;
+    m_selectorHostApi.SetCardRangePositions = HostSetCardRangePositions;
+    m_selectorHostApi.SetCardRangeDimensions = HostSetCardRangeDimensions;
+    m_selectorHostApi.SetCardRangeAppearanceParam1f = HostSetCardRangeAppearanceParam1f;
+    m_selectorHostApi.SetCardRangeTextures = HostSetCardRangeTextures;
+    m_selectorHostApi.FindTextureHandle = HostFindTextureHandle;
+    m_selectorHostApi.SetCameraPosition = HostSetCameraPosition;
+    m_selectorHostApi.SetCameraTarget = HostSetCameraTarget;
+    m_selectorHostApi.SetCardLayout = HostSetCardLayout;
+    m_selectorHostApi.SetCardLayoutScroll = HostSetCardLayoutScroll;
+    m_selectorHostApi.SetCardLayoutScrollTarget = HostSetCardLayoutScrollTarget;
+
+    m_selectorPlugin.SetHostResetHandler(ResetHostForSelector, this);
+
+    // A broken plugin shouldn't leave nothing to pick games with
+    const std::string& SelectorPluginPath = configuration.GetSelectorPluginPath();
+    if (!SelectorPluginPath.empty())
+    {
+        if (m_selectorPlugin.Load(SelectorPluginPath, &m_selectorHostApi, m_pWindow))
+        {
+            return true;
+        }
+
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Falling back to the built-in selector");
+    }
+
+    if (!m_selectorPlugin.LoadBuiltIn(CarouselSelector::GetSelectorApi(), &m_selectorHostApi))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to initialize selector");
+        return false;
+    }
+
+    return true;
+}
+
+void fivednineApp::SetInitialLibraryView(const AppConfig& configuration)
+{
+    m_pActiveLibraryView = &m_libraryViews.GetView(m_activeLibraryView);
+
+    const std::string& LibraryViewName = configuration.GetLibraryViewName();
+    if (LibraryViewName.empty())
+    {
+        return;
+    }
+
+    LibraryView libraryView;
+    if (!GameLibraryViews::ViewFromString(LibraryViewName, &libraryView))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Unknown library view: %s", LibraryViewName.c_str());
+        return;
+    }
+
+    // Falls back to the database order if the view is empty
+    Selector_SetLibraryView(libraryView);
+}
+
 // API METHODS
+bool fivednineApp::IsValidCardIndex(uint32_t cardIndex) const
+{
+    return cardIndex < m_pActiveLibraryView->size();
+}
+
+bool fivednineApp::IsValidCardRange(uint32_t firstIndex, uint32_t numCards) const
+{
+    if (static_cast<uint64_t>(firstIndex) + numCards > m_pActiveLibraryView->size())
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "Game card range out of bounds: %u + %u", firstIndex, numCards);
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t fivednineApp::GameIndexFromCardIndex(uint32_t cardIndex) const
+{
+    return (*m_pActiveLibraryView)[cardIndex];
+}
+
 uint32_t fivednineApp::Selector_GetNumCards()
 {
-    return m_numGameInfos;
+    return static_cast<uint32_t>(m_pActiveLibraryView->size());
 }
 
 void fivednineApp::Selector_SelectIndex(uint32_t index)
 {
-    RELEASE_CHECK(index >= 0 && index < m_numGameInfos, "Invalid card index: %u", index);
+    RELEASE_CHECK(IsValidCardIndex(index), "Invalid card index: %u", index);
     m_currentSelectedCardIndex = index;
 }
 
@@ -433,7 +823,71 @@ uint32_t fivednineApp::Selector_GetSelectedIndex()
 
 void fivednineApp::Selector_ConfirmCurrentSelection()
 {
-    // TODO
+    const uint32_t GameIndex = GameIndexFromCardIndex(m_currentSelectedCardIndex);
+    GameInfo& gameInfo = m_gameInfos[GameIndex];
+
+    // TODO: actually launch the game once process management exists
+    RELEASE_LOGLINE_INFO(LOG_API, "Confirmed selection: %s", gameInfo.Title.c_str());
+
+    const uint64_t Now = LaunchHistory::GetCurrentTimestamp();
+    if (m_launchHistory.IsOpen())
+    {
+        m_launchHistory.RecordLaunch(gameInfo.Alias, Now);
+    }
+
+    ++gameInfo.LaunchCount;
+    gameInfo.LastLaunchedTime = Now;
+    m_libraryViews.UpdateGame(GameIndex, gameInfo);
+
+    // The launch may have reordered the active view; follow the game.
+    const std::vector<uint32_t>& ActiveView = *m_pActiveLibraryView;
+    auto it = std::find(std::begin(ActiveView), std::end(ActiveView), GameIndex);
+    m_currentSelectedCardIndex = static_cast<uint32_t>(std::distance(std::begin(ActiveView), it));
+}
+
+void fivednineApp::Selector_AcknowledgeInput(uint64_t inputTimestampNs)
+{
+    // Input the app made up itself has no latency to measure
+    if (inputTimestampNs != 0)
+    {
+        m_unpresentedInputTimestampsNs.push_back(inputTimestampNs);
+    }
+}
+
+bool fivednineApp::Selector_SetLibraryView(LibraryView view)
+{
+    if (view >= LibraryView::Max)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "Invalid library view: %u", static_cast<uint32_t>(view));
+        return false;
+    }
+
+    const std::vector<uint32_t>& NewView = m_libraryViews.GetView(view);
+    if (NewView.empty())
+    {
+        RELEASE_LOGLINE_INFO(
+            LOG_API,
+            "Library view %s has no entries",
+            GameLibraryViews::ViewToString(view));
+        return false;
+    }
+
+    m_activeLibraryView = view;
+    m_pActiveLibraryView = &NewView;
+
+    // Selection is a position in the view, so keep it in range. The selector
+    // is expected to re-lay out its cards after a view change.
+    if (!IsValidCardIndex(m_currentSelectedCardIndex))
+    {
+        m_currentSelectedCardIndex = 0;
+    }
+
+    return true;
+}
+
+LibraryView fivednineApp::Selector_GetLibraryView()
+{
+    return m_activeLibraryView;
 }
 
 void fivednineApp::Selector_GetDisplayDimensions(uint32_t* pWidthOut, uint32_t* pHeightOut)
@@ -449,31 +903,51 @@ bool fivednineApp::Selector_GetCardGameInfo(uint32_t index, GameInfo* pGameInfoO
         return false;
     }
 
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
+        return false;
+    }
+
+    *pGameInfoOut = m_gameInfos[GameIndexFromCardIndex(index)];
+    return true;
+}
+
+bool fivednineApp::Selector_GetCardInfo(uint32_t index, FdnCardInfo* pCardInfoOut)
+{
+    if (!pCardInfoOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pCardInfoOut cannot be null");
+        return false;
+    }
+
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
     }
 
-    *pGameInfoOut = m_gameInfoArray[index];
+    const GameInfo& CardGameInfo = m_gameInfos[GameIndexFromCardIndex(index)];
+    pCardInfoOut->pTitle = CardGameInfo.Title.c_str();
+    pCardInfoOut->pTexturePrefix = CardGameInfo.TexturePrefix.c_str();
+    pCardInfoOut->CardTextureHandle = CardGameInfo.CardTextureHandle;
     return true;
 }
 
 bool fivednineApp::Selector_SetCardAppearanceParam1f(uint32_t index, const char* pParameterName, float *pValue)
 {
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
     }
 
-    m_gameCards[index]->SetUniformValue1f(pParameterName, pValue);
-    return false;
+    return m_cardPool.SetAppearanceParam1f(GameIndexFromCardIndex(index), pParameterName, pValue);
 }
 
 bool fivednineApp::Selector_GetCardPosition(uint32_t index, glm::vec3* pCardPositionOut)
 {
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
@@ -485,53 +959,197 @@ bool fivednineApp::Selector_GetCardPosition(uint32_t index, glm::vec3* pCardPosi
         return false;
     }
 
-    *pCardPositionOut = m_gameCards[index]->GetPosition();
+    if (m_cardPool.GetLayout().Kind != CardLayoutKind::PerCard)
+    {
+        *pCardPositionOut = m_cardPool.GetLayoutPosition(index);
+        return true;
+    }
+
+    *pCardPositionOut = m_cardPool.GetPosition(GameIndexFromCardIndex(index));
     return true;
 }
 
 bool fivednineApp::Selector_SetCardPosition(uint32_t index, float x, float y, float z)
 {
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
     }
 
-    m_gameCards[index]->SetPosition(x, y, z);
+    m_cardPool.SetPosition(GameIndexFromCardIndex(index), glm::vec3(x, y, z));
     return true;
 }
 
 bool fivednineApp::Selector_SetCardDimensions(uint32_t index, float width, float height)
 {
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
     }
 
-    m_gameCards[index]->SetDimensions(width, height);
-    return false;
+    m_cardPool.SetDimensions(GameIndexFromCardIndex(index), width, height);
+    return true;
 }
 
 bool fivednineApp::Selector_SetCardTexture(uint32_t index, const char* pTextureName)
 {
-    if (index > m_numGameInfos)
+    if (!IsValidCardIndex(index))
     {
         RELEASE_LOGLINE_ERROR(LOG_API, "Game card index out of bounds: %u", index);
         return false;
     }
 
-    TexturePtr spTexture = m_textureStorage.FindTextureByName(pTextureName);
-    if (!spTexture)
+    const TextureHandle CardTextureHandle = m_textureStorage.FindTextureHandle(pTextureName);
+    if (CardTextureHandle == kInvalidTextureHandle)
     {
         RELEASE_LOGLINE_WARNING(LOG_API, "Failed to find texture %s", pTextureName);
         return false;
     }
 
-    m_gameCards[index]->SetTexture(spTexture);
+    m_cardPool.SetTexture(GameIndexFromCardIndex(index), CardTextureHandle);
+    return true;
+}
+
+bool
+fivednineApp::Selector_SetCardRangePositions(
+    uint32_t firstIndex,
+    uint32_t numCards,
+    const float* pPositions,
+    size_t strideBytes)
+{
+    if (!pPositions)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pPositions cannot be null");
+        return false;
+    }
+
+    if (!IsValidCardRange(firstIndex, numCards))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numCards; ++i)
+    {
+        const float* pPosition = StridedElement(pPositions, strideBytes, i);
+        m_cardPool.SetPosition(GameIndexFromCardIndex(firstIndex + i), glm::vec3(pPosition[0], pPosition[1], pPosition[2]));
+    }
+    return true;
+}
+
+bool
+fivednineApp::Selector_SetCardRangeDimensions(
+    uint32_t firstIndex,
+    uint32_t numCards,
+    const float* pDimensions,
+    size_t strideBytes)
+{
+    if (!pDimensions)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pDimensions cannot be null");
+        return false;
+    }
+
+    if (!IsValidCardRange(firstIndex, numCards))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numCards; ++i)
+    {
+        const float* pCardDimensions = StridedElement(pDimensions, strideBytes, i);
+        m_cardPool.SetDimensions(GameIndexFromCardIndex(firstIndex + i), pCardDimensions[0], pCardDimensions[1]);
+    }
+    return true;
+}
+
+bool
+fivednineApp::Selector_SetCardRangeAppearanceParam1f(
+    uint32_t firstIndex,
+    uint32_t numCards,
+    const char* pParameterName,
+    float* pValues,
+    size_t strideBytes)
+{
+    if (!pParameterName || !pValues)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pParameterName and pValues cannot be null");
+        return false;
+    }
+
+    if (!IsValidCardRange(firstIndex, numCards))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numCards; ++i)
+    {
+        // Only the first can fail, before anything has changed
+        if (!m_cardPool.SetAppearanceParam1f(
+                GameIndexFromCardIndex(firstIndex + i),
+                pParameterName,
+                StridedElement(pValues, strideBytes, i)))
+        {
+            return false;
+        }
+    }
     return true;
 }
 
+bool
+fivednineApp::Selector_SetCardRangeTextures(
+    uint32_t firstIndex,
+    uint32_t numCards,
+    const TextureHandle* pTextureHandles,
+    size_t strideBytes)
+{
+    if (!pTextureHandles)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pTextureHandles cannot be null");
+        return false;
+    }
+
+    if (!IsValidCardRange(firstIndex, numCards))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numCards; ++i)
+    {
+        const TextureHandle CardTextureHandle = *StridedElement(pTextureHandles, strideBytes, i);
+        if (CardTextureHandle == kInvalidTextureHandle)
+        {
+            continue;
+        }
+
+        if (!m_textureStorage.IsValidTextureHandle(CardTextureHandle))
+        {
+            RELEASE_LOGLINE_WARNING(LOG_API, "Invalid texture handle for card %u: %u", firstIndex + i, CardTextureHandle);
+            continue;
+        }
+
+        m_cardPool.SetTexture(GameIndexFromCardIndex(firstIndex + i), CardTextureHandle);
+    }
+    return true;
+}
+
+TextureHandle fivednineApp::Selector_FindTextureHandle(const char* pTextureName)
+{
+    if (!pTextureName)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_API, "pTextureName cannot be null");
+        return kInvalidTextureHandle;
+    }
+
+    const TextureHandle FoundTextureHandle = m_textureStorage.FindTextureHandle(pTextureName);
+    if (FoundTextureHandle == kInvalidTextureHandle)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_API, "Failed to find texture %s", pTextureName);
+    }
+    return FoundTextureHandle;
+}
+
 void fivednineApp::Selector_SetCameraTarget(const glm::vec3& target)
 {
     m_camera.SetTranslationTarget(target);
@@ -542,48 +1160,137 @@ void fivednineApp::Selector_SetCameraPosition(const glm::vec3& position)
     m_camera.SetTranslation(position);
 }
 
-void 
-fivednineApp::HandleKeypress(
-    Window::EventType eventType,
-    Window::KeyType keyType,
-    void* pUserPointer)
+void fivednineApp::Selector_ResetCards()
+{
+    m_cardPool.ClearAppearanceParams();
+    m_cardPool.SetLayout(CardLayoutParams());
+}
+
+bool fivednineApp::Selector_SetCardLayout(const CardLayoutParams& layout)
+{
+    return m_cardPool.SetLayout(layout);
+}
+
+void fivednineApp::Selector_SetCardLayoutScroll(float scrollOffset)
+{
+    m_cardPool.SetScroll(scrollOffset);
+}
+
+void fivednineApp::Selector_SetCardLayoutScrollTarget(float scrollOffset)
+{
+    m_cardPool.SetScrollTarget(scrollOffset);
+}
+
+bool fivednineApp::PostSelectorAction(input::ActionType actionType, uint64_t timestampNs, uint32_t count)
 {
-    if (eventType == Window::EventType::KeyDown && pUserPointer)
+    SelectorInputEventType inputEventType;
+    switch (actionType)
     {
-        switch (keyType)
-        {
-            case Window::KeyType::Q:
-            {
-                Window* pWindow = static_cast<fivednineApp*>(pUserPointer)->m_pWindow;
-                pWindow->Quit();
-                break;
-            }
-            case Window::KeyType::Left:
-                // fallthrough
-            case Window::KeyType::A:
-            {
-                EventPump& eventPump = static_cast<fivednineApp*>(pUserPointer)->m_selectorEventPump;
+        case input::ActionType::Previous:
+            inputEventType = SelectorInputEventType::PreviousSelection;
+            break;
+        case input::ActionType::Next:
+            inputEventType = SelectorInputEventType::NextSelection;
+            break;
+        case input::ActionType::PagePrevious:
+            inputEventType = SelectorInputEventType::PreviousPage;
+            break;
+        case input::ActionType::PageNext:
+            inputEventType = SelectorInputEventType::NextPage;
+            break;
+        case input::ActionType::Search:
+            inputEventType = SelectorInputEventType::Search;
+            break;
+        case input::ActionType::Confirm:
+            inputEventType = SelectorInputEventType::ConfirmCurrent;
+            break;
+        case input::ActionType::NextLibraryView:
+            inputEventType = SelectorInputEventType::NextLibraryView;
+            break;
+        default:
+            return false;
+    }
 
-                SelectorEvent event;
-                event.EventType = SelectorEventType::Input;
-                event.EventPayload.InputEventPayload.InputEventType = SelectorInputEventType::PreviousSelection;
-                eventPump.PostEvent(event);
-                break;
-            }
-            case Window::KeyType::Right:
-                // fallthrough
-            case Window::KeyType::D:
-            {
-                EventPump& eventPump = static_cast<fivednineApp*>(pUserPointer)->m_selectorEventPump;
+    SelectorInputEvent event;
+    event.InputEventType = inputEventType;
+    event.TimestampNs = timestampNs;
+    event.Count = count;
+    m_eventBus.Post(event);
+    return true;
+}
 
-                SelectorEvent event;
-                event.EventType = SelectorEventType::Input;
-                event.EventPayload.InputEventPayload.InputEventType = SelectorInputEventType::NextSelection;
-                eventPump.PostEvent(event);
-                break;
-            }
-            default:
-                break;
-        }
+void fivednineApp::HandleInputEvent(const input::InputEvent& event, void* pUserPointer)
+{
+    if (!pUserPointer)
+    {
+        return;
+    }
+
+    fivednineApp* pApp = static_cast<fivednineApp*>(pUserPointer);
+    pApp->m_actionRepeater.OnInputEvent(event);
+    if (!event.IsPressed)
+    {
+        return;
+    }
+
+    switch (event.ActionType)
+    {
+        case input::ActionType::Quit:
+            pApp->m_pWindow->Quit();
+            break;
+        case input::ActionType::ToggleOverlay:
+            pApp->m_frameTimeOverlay.ToggleVisible();
+            break;
+        default:
+            pApp->PostSelectorAction(event.ActionType, event.TimestampNs);
+            break;
     }
-}
\ No newline at end of file
+}
+
+void fivednineApp::HandleWindowEvent(const render::Window::WindowEvent& event, void* pUserPointer)
+{
+    fivednineApp* pApp = static_cast<fivednineApp*>(pUserPointer);
+    if (event.Type != render::Window::EventType::Resized)
+    {
+        return;
+    }
+
+    pApp->UpdateProjection(event.Width, event.Height);
+
+    DisplayResizedEvent resizedEvent;
+    resizedEvent.Width = event.Width;
+    resizedEvent.Height = event.Height;
+    pApp->m_eventBus.Post(resizedEvent);
+}
+
+void fivednineApp::HandleSelectorInputEvent(const SelectorInputEvent& event, void* pUserPointer)
+{
+    static_assert(static_cast<uint32_t>(SelectorInputEventType::NextSelection) == FDN_SELECTOR_INPUT_NEXT_SELECTION &&
+                  static_cast<uint32_t>(SelectorInputEventType::PreviousSelection) == FDN_SELECTOR_INPUT_PREVIOUS_SELECTION &&
+                  static_cast<uint32_t>(SelectorInputEventType::NextPage) == FDN_SELECTOR_INPUT_NEXT_PAGE &&
+                  static_cast<uint32_t>(SelectorInputEventType::PreviousPage) == FDN_SELECTOR_INPUT_PREVIOUS_PAGE &&
+                  static_cast<uint32_t>(SelectorInputEventType::Search) == FDN_SELECTOR_INPUT_SEARCH &&
+                  static_cast<uint32_t>(SelectorInputEventType::ConfirmCurrent) == FDN_SELECTOR_INPUT_CONFIRM_CURRENT &&
+                  static_cast<uint32_t>(SelectorInputEventType::NextLibraryView) == FDN_SELECTOR_INPUT_NEXT_LIBRARY_VIEW,
+                  "Selector input event types are passed to selectors as is");
+
+    FdnSelectorInputEvent selectorInputEvent;
+    selectorInputEvent.InputEventType = static_cast<uint32_t>(event.InputEventType);
+    selectorInputEvent.Count = event.Count;
+    selectorInputEvent.TimestampNs = event.TimestampNs;
+    static_cast<fivednineApp*>(pUserPointer)->m_selectorPlugin.HandleInputEvent(selectorInputEvent);
+}
+
+void fivednineApp::HandleDisplayResizedEvent(const DisplayResizedEvent& event, void* pUserPointer)
+{
+    static_cast<fivednineApp*>(pUserPointer)->m_selectorPlugin.HandleDisplayResized(event.Width, event.Height);
+}
+
+void fivednineApp::UpdateProjection(uint32_t width, uint32_t height)
+{
+    m_projectionMatrix = glm::ortho(
+        0.f, static_cast<float>(width),
+        static_cast<float>(height), 0.f,
+        0.1f, 1000.f
+    );
+}
@@ -1,9 +1,15 @@
 #pragma once
 
 #include "gameinfo.h"
-#include "gamecard.h"
-#include "eventpump.h"
-#include "carouselselector.h"
+#include "cardpool.h"
+#include "appevents.h"
+#include "gamelibraryviews.h"
+#include "launchhistory.h"
+#include "selectorapi.h"
+#include "selectorplugin.h"
+#include "assetcatalog.h"
+#include "frametimings.h"
+#include "frametimeoverlay.h"
 
 #include <cstdint>
 #include <memory>
@@ -12,49 +18,151 @@
 
 #include <glm/glm.hpp>
 
+#include <fivednine/input/actionrepeater.h>
+#include <fivednine/input/inputevent.h>
 #include <fivednine/render/window.h>
 #include <fivednine/render/camera.h>
 #include <fivednine/render/texturestorage.h>
 #include <fivednine/render/shaderstorage.h>
 
+// Wall time spent in one stage of fivednineApp::Initialize
+struct StartupStageTiming
+{
+    const char* pStageName = nullptr;
+    double      Milliseconds = 0.0;
+};
+
 class AppConfig;
 class fivednineApp
 {
     public:
         bool Initialize(const AppConfig& configuration, fivednine::render::Window* pWindow);
 
+        // Advances the simulation by one fixed timestep
         void Tick(float dtSeconds);
-        void Draw();
 
-        // TODO: factor these out into a designated, C-friendly selector API
-        // Attempting to make the selector itself stateless for future
-        // hot-loading and language binding ambitions.
+        // interpolationAlpha blends between the last two simulation states
+        void Draw(float interpolationAlpha);
+
+        // True when nothing is animating or pending, so that further frames
+        // would be identical and the main loop can block until input.
+        bool IsIdle() const;
+
+        // Called before the main loop blocks; finishes deferred work that
+        // would otherwise wait for the next wakeup.
+        void PrepareForIdle();
+
+        // Filled in by the main loop; drawn by the overlay (toggled with F1)
+        FrameTimings& GetFrameTimings();
+
+        // Called by the main loop right after the buffer swap
+        void OnFramePresented(uint64_t presentTimestampNs);
+
+        // In the order the stages ran. GPU work may still be in flight when a
+        // stage's time is taken.
+        const std::vector<StartupStageTiming>& GetStartupTimings() const;
+
+        // Texture memory as uploaded; card geometry is a few hundred bytes
+        // per card and isn't counted
+        uint64_t GetEstimatedVramBytes() const;
+
+        // Selectors call these through the FdnHostApi table in
+        // selectorapi.h, which forwards to them.
         uint32_t Selector_GetNumCards();
         void     Selector_SelectIndex(uint32_t index);
         uint32_t Selector_GetSelectedIndex();
         void     Selector_ConfirmCurrentSelection();
 
+        // Marks an input as handled; its latency is measured to the
+        // presentation of the next frame
+        void     Selector_AcknowledgeInput(uint64_t inputTimestampNs);
+
+        // Card indices passed to the selector API are positions in the active
+        // library view. Returns false if the view has no entries.
+        bool        Selector_SetLibraryView(LibraryView view);
+        LibraryView Selector_GetLibraryView();
+
         void Selector_GetDisplayDimensions(uint32_t* pWidthOut, uint32_t* pHeightOut);
         bool Selector_GetCardGameInfo(uint32_t index, GameInfo* pGameInfoOut);
+
+        // As above, but pointing into the app's own copy rather than copying
+        bool Selector_GetCardInfo(uint32_t index, FdnCardInfo* pCardInfoOut);
         bool Selector_SetCardAppearanceParam1f(uint32_t index, const char* pParameterName, float* pValue);
         bool Selector_GetCardPosition(uint32_t index, glm::vec3* pCardPositionOut);
         bool Selector_SetCardPosition(uint32_t index, float x, float y, float z);
         bool Selector_SetCardDimensions(uint32_t index, float width, float height);
         bool Selector_SetCardTexture(uint32_t index, const char* pTextureName);
 
+        // Bulk variants over the cards [firstIndex, firstIndex + numCards),
+        // for laying out many cards at once. The range is checked once, and
+        // nothing changes if any of it is out of bounds. Arrays are read
+        // with a stride in bytes between cards; a stride of zero gives every
+        // card the same value.
+        //
+        // Positions are x, y, z and dimensions are width, height, per card.
+        // As with the single-card call, appearance parameters are read at
+        // draw time, so pValues must outlive their use. Cards given
+        // kInvalidTextureHandle keep their current texture.
+        bool Selector_SetCardRangePositions(uint32_t firstIndex, uint32_t numCards, const float* pPositions, size_t strideBytes);
+        bool Selector_SetCardRangeDimensions(uint32_t firstIndex, uint32_t numCards, const float* pDimensions, size_t strideBytes);
+        bool
+        Selector_SetCardRangeAppearanceParam1f(
+            uint32_t firstIndex,
+            uint32_t numCards,
+            const char* pParameterName,
+            float* pValues,
+            size_t strideBytes);
+        bool
+        Selector_SetCardRangeTextures(
+            uint32_t firstIndex,
+            uint32_t numCards,
+            const fivednine::render::TextureHandle* pTextureHandles,
+            size_t strideBytes);
+
+        // kInvalidTextureHandle if there's no such texture
+        fivednine::render::TextureHandle Selector_FindTextureHandle(const char* pTextureName);
+
         void Selector_SetCameraPosition(const glm::vec3& position);
         void Selector_SetCameraTarget(const glm::vec3& target);
 
+        // GPU-driven layout; see CardLayoutParams. Scroll offsets are in
+        // the layout's units.
+        bool Selector_SetCardLayout(const CardLayoutParams& layout);
+
+        // Drops appearance values and any layout, before a selector is
+        // initialized, so nothing set by an earlier one outlives it
+        void Selector_ResetCards();
+        void Selector_SetCardLayoutScroll(float scrollOffset);
+        void Selector_SetCardLayoutScrollTarget(float scrollOffset);
+
     private:
         bool LoadTextures(const AppConfig& configuration);
         bool LoadShaders(const AppConfig& configuration);
         bool LoadGamesInfo(const AppConfig& configuration);
+        bool LoadSelector(const AppConfig& configuration);
+        void LoadAssetCatalog(const AppConfig& configuration);
+        void SaveAssetCatalog(const AppConfig& configuration);
+        void LoadLaunchHistory(const AppConfig& configuration);
+        void SetInitialLibraryView(const AppConfig& configuration);
+
+        // Records the time since the previous stage ended (or since
+        // Initialize was entered)
+        void EndStartupStage(const char* pStageName);
+
+        bool IsValidCardIndex(uint32_t cardIndex) const;
+        bool IsValidCardRange(uint32_t firstIndex, uint32_t numCards) const;
+        uint32_t GameIndexFromCardIndex(uint32_t cardIndex) const;
+
+        // Translates an action into a selector event; false if the
+        // selector has no use for it
+        bool PostSelectorAction(fivednine::input::ActionType actionType, uint64_t timestampNs, uint32_t count = 1);
 
-        static void 
-        HandleKeypress(
-            fivednine::render::Window::EventType eventType,
-            fivednine::render::Window::KeyType keyType,
-            void* pUserPointer);
+        static void HandleInputEvent(const fivednine::input::InputEvent& event, void* pUserPointer);
+        static void HandleWindowEvent(const fivednine::render::Window::WindowEvent& event, void* pUserPointer);
+        static void HandleSelectorInputEvent(const SelectorInputEvent& event, void* pUserPointer);
+        static void HandleDisplayResizedEvent(const DisplayResizedEvent& event, void* pUserPointer);
+
+        void UpdateProjection(uint32_t width, uint32_t height);
 
     private:
         bool                       m_isInitialized = false;
@@ -62,18 +170,35 @@ class fivednineApp
         fivednine::render::TextureStorage m_textureStorage;
         fivednine::render::ShaderStorage  m_shaderStorage;
         fivednine::render::Camera         m_camera;
+        AssetCatalog                      m_assetCatalog;
+
+        std::vector<StartupStageTiming>   m_startupTimings;
+        uint64_t                          m_startupStageStartNs = 0;
 
         glm::mat4 m_projectionMatrix;
 
         // TODO: factor app state into common structure
-        // TODO: static array container
-        static constexpr uint8_t kMaxGameInfoEntries = 255; 
-        GameInfo m_gameInfoArray[kMaxGameInfoEntries];
-        uint8_t m_numGameInfos = 0;
+        // Indexed by game index; library views hold permutations of these
+        std::vector<GameInfo> m_gameInfos;
+
+        GameLibraryViews             m_libraryViews;
+        LibraryView                  m_activeLibraryView = LibraryView::Database;
+        const std::vector<uint32_t>* m_pActiveLibraryView = nullptr;
+
+        LaunchHistory                m_launchHistory;
+
+        FrameTimings                 m_frameTimings;
+        FrameTimeOverlay             m_frameTimeOverlay;
+        float                        m_targetFrameMs = 0.f;
+        std::vector<uint64_t>        m_unpresentedInputTimestampsNs;
+
+        uint32_t m_currentSelectedCardIndex = 0;
+        CardPool m_cardPool;
 
-        uint8_t m_currentSelectedCardIndex = 0;
-        std::vector<GameCardPtr> m_gameCards;
+        fivednine::input::ActionRepeater  m_actionRepeater;
+        AppEventBus                       m_eventBus;
+        uint64_t                          m_numDroppedEventsReported = 0;
 
-        EventPump                         m_selectorEventPump;
-        std::unique_ptr<CarouselSelector> m_spSelector;
+        FdnHostApi                        m_selectorHostApi;
+        SelectorPlugin                    m_selectorPlugin;
 };
\ No newline at end of file
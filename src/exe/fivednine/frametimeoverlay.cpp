@@ -0,0 +1,165 @@
+#include "frametimeoverlay.h"
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <fivednine/render/texturestorage.h>
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+using namespace fivednine::system;
+
+namespace
+{
+    static const char* kWhiteTextureName = "frametimeoverlay_white";
+}
+
+bool FrameTimeOverlay::Initialize(TextureStorage* pTextureStorage, ShaderPtr spShader)
+{
+    RELEASE_CHECK(pTextureStorage != nullptr, "pTextureStorage cannot be null");
+    if (!spShader)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Frame time overlay requires a shader");
+        return false;
+    }
+
+    uint8_t whitePixel[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    const ImageData WhiteImage { 1, 1, 4, whitePixel };
+    if (!pTextureStorage->AddTexture(WhiteImage, kWhiteTextureName))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create frame time overlay texture");
+        return false;
+    }
+    TexturePtr spWhiteTexture = pTextureStorage->FindTextureByName(kWhiteTextureName);
+
+    m_spFrameBarsMesh = CreateMesh(spShader, spWhiteTexture, kNumBars);
+    m_spGpuBarsMesh = CreateMesh(spShader, spWhiteTexture, kNumBars);
+    m_spTargetLineMesh = CreateMesh(spShader, spWhiteTexture, 1);
+
+    m_positions.reserve(kNumBars * 4);
+    m_uvs.assign(kNumBars * 4, glm::vec2(0.f));
+
+    // Two triangles per quad, matching the vertex order in UpdateBars()
+    m_indices.reserve(kNumBars * 6);
+    for (int i = 0; i < static_cast<int>(kNumBars); ++i)
+    {
+        const int BaseVertex = i * 4;
+        const int QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int quadIndex : QuadIndices)
+        {
+            m_indices.push_back(BaseVertex + quadIndex);
+        }
+    }
+
+    m_isInitialized = true;
+    return true;
+}
+
+void FrameTimeOverlay::ToggleVisible()
+{
+    m_isVisible = !m_isVisible;
+}
+
+bool FrameTimeOverlay::IsVisible() const
+{
+    return m_isVisible;
+}
+
+void FrameTimeOverlay::Draw(
+    const FrameTimings& frameTimings,
+    float targetFrameMs,
+    uint32_t screenWidth,
+    uint32_t screenHeight)
+{
+    if (!m_isInitialized || !m_isVisible)
+    {
+        return;
+    }
+
+    const float BaselineY = static_cast<float>(screenHeight) - kMargin;
+    UpdateBars(m_spFrameBarsMesh.get(), frameTimings.GetHistory(FrameTimingSeries::Frame), kBarWidth, BaselineY);
+    UpdateBars(m_spGpuBarsMesh.get(), frameTimings.GetHistory(FrameTimingSeries::Gpu), kBarWidth / 2.f, BaselineY);
+
+    const float TargetLineY = BaselineY - std::min(targetFrameMs * kPixelsPerMs, kMaxBarHeight);
+    const float GraphRight = kMargin + kNumBars * kBarWidth;
+    const glm::vec3 TargetLinePositions[4] = {
+        glm::vec3(kMargin, TargetLineY, 0.f),
+        glm::vec3(GraphRight, TargetLineY, 0.f),
+        glm::vec3(GraphRight, TargetLineY - 1.f, 0.f),
+        glm::vec3(kMargin, TargetLineY - 1.f, 0.f),
+    };
+    m_spTargetLineMesh->SetPositions(TargetLinePositions, 4);
+
+    // Screen-space pixels, y down like the card projection
+    const glm::mat4 ProjectionMatrix = glm::ortho(
+        0.f, static_cast<float>(screenWidth),
+        static_cast<float>(screenHeight), 0.f,
+        -1.f, 1.f);
+    const glm::mat4 ViewMatrix(1.f);
+
+    m_spFrameBarsMesh->SetMeshUniforms({ MeshUniformValue("tint", UniformType::Float, &m_frameBarsTint) });
+    m_spFrameBarsMesh->Draw(ProjectionMatrix, ViewMatrix);
+
+    m_spGpuBarsMesh->SetMeshUniforms({ MeshUniformValue("tint", UniformType::Float, &m_gpuBarsTint) });
+    m_spGpuBarsMesh->Draw(ProjectionMatrix, ViewMatrix);
+
+    m_spTargetLineMesh->SetMeshUniforms({ MeshUniformValue("tint", UniformType::Float, &m_targetLineTint) });
+    m_spTargetLineMesh->Draw(ProjectionMatrix, ViewMatrix);
+}
+
+void FrameTimeOverlay::UpdateBars(Mesh* pMesh, const SampleHistory& history, float barWidth, float baselineY)
+{
+    // Newest sample at the right edge
+    const size_t NumBars = std::min<size_t>(history.GetCount(), kNumBars);
+    const size_t NumSkipped = history.GetCount() - NumBars;
+
+    m_positions.clear();
+    size_t sampleIndex = 0;
+    history.ForEachSample([&](double sampleMs) -> bool
+        {
+            if (sampleIndex++ < NumSkipped)
+            {
+                return true;
+            }
+
+            const size_t BarIndex = m_positions.size() / 4;
+            const float Left = kMargin + (kNumBars - NumBars + BarIndex) * kBarWidth;
+            const float Right = Left + barWidth;
+            const float Top = baselineY - std::min(static_cast<float>(sampleMs) * kPixelsPerMs, kMaxBarHeight);
+
+            m_positions.emplace_back(Left, baselineY, 0.f);
+            m_positions.emplace_back(Right, baselineY, 0.f);
+            m_positions.emplace_back(Right, Top, 0.f);
+            m_positions.emplace_back(Left, Top, 0.f);
+            return true;
+        });
+
+    const uint32_t NumVertices = static_cast<uint32_t>(m_positions.size());
+    pMesh->SetPositions(m_positions.data(), NumVertices);
+    pMesh->SetTextureCoordinates(m_uvs.data(), NumVertices);
+    pMesh->SetIndices(m_indices.data(), static_cast<uint32_t>(NumBars * 6));
+}
+
+FrameTimeOverlay::MeshPtr FrameTimeOverlay::CreateMesh(ShaderPtr spShader, TexturePtr spTexture, uint32_t maxNumQuads)
+{
+    MeshPtr spMesh(new Mesh(maxNumQuads * 4, maxNumQuads * 6));
+    RELEASE_CHECK(spMesh != nullptr, "Failed to allocate overlay mesh");
+
+    spMesh->SetModelMatrix(glm::mat4(1.f));
+    spMesh->SetShader(spShader);
+    spMesh->SetTexture(spTexture);
+
+    // The target line never changes shape, only position
+    if (maxNumQuads == 1)
+    {
+        const glm::vec2 UVs[4] = { glm::vec2(0.f), glm::vec2(0.f), glm::vec2(0.f), glm::vec2(0.f) };
+        const int Indices[6] = { 0, 1, 2, 0, 2, 3 };
+        spMesh->SetTextureCoordinates(UVs, 4);
+        spMesh->SetIndices(Indices, 6);
+    }
+
+    return spMesh;
+}
@@ -0,0 +1,71 @@
+// frametimeoverlay.h
+//
+// Bar graph of recent frame times in the corner of the screen, drawn with the
+// game card shader and a 1x1 white texture. Frame times are drawn dim, GPU
+// times bright on top of them, with a line marking the target frame time.
+
+#pragma once
+
+#include "frametimings.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <fivednine/render/mesh.h>
+#include <fivednine/render/shader.h>
+
+namespace fivednine { namespace render {
+    class TextureStorage;
+}}
+
+class FrameTimeOverlay
+{
+public:
+    bool Initialize(fivednine::render::TextureStorage* pTextureStorage, fivednine::render::ShaderPtr spShader);
+
+    void ToggleVisible();
+    bool IsVisible() const;
+
+    void Draw(const FrameTimings& frameTimings, float targetFrameMs, uint32_t screenWidth, uint32_t screenHeight);
+
+private:
+    static constexpr uint32_t kNumBars = 240;
+    static constexpr float    kBarWidth = 2.f;
+    static constexpr float    kPixelsPerMs = 4.f;
+    static constexpr float    kMaxBarHeight = 200.f;
+    static constexpr float    kMargin = 16.f;
+
+    using MeshPtr = std::unique_ptr<fivednine::render::Mesh>;
+
+    // Rebuilds a bar mesh from the newest samples of a history
+    void UpdateBars(
+        fivednine::render::Mesh* pMesh,
+        const fivednine::system::SampleHistory& history,
+        float barWidth,
+        float baselineY);
+
+    static MeshPtr CreateMesh(
+        fivednine::render::ShaderPtr spShader,
+        fivednine::render::TexturePtr spTexture,
+        uint32_t maxNumQuads);
+
+    bool m_isInitialized = false;
+    bool m_isVisible = false;
+
+    MeshPtr m_spFrameBarsMesh;
+    MeshPtr m_spGpuBarsMesh;
+    MeshPtr m_spTargetLineMesh;
+
+    // Referenced by the meshes' tint uniforms
+    float m_frameBarsTint = 0.5f;
+    float m_gpuBarsTint = 1.f;
+    float m_targetLineTint = 0.25f;
+
+    // Scratch geometry, kept to avoid per-frame allocations
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec2> m_uvs;
+    std::vector<int>       m_indices;
+};
@@ -0,0 +1,150 @@
+#include "frametimings.h"
+
+#include <fstream>
+
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+using namespace fivednine::system;
+
+FrameTimings::FrameTimings()
+    : m_inputLatencyHistogram(kInputLatencyBucketMs, kNumInputLatencyBuckets)
+{
+    m_histories.reserve(kNumSeries);
+    for (size_t i = 0; i < kNumSeries; ++i)
+    {
+        m_histories.emplace_back(kHistoryCapacity);
+    }
+}
+
+void FrameTimings::AddSample(FrameTimingSeries series, double milliseconds)
+{
+    RELEASE_CHECK(series < FrameTimingSeries::Max, "Invalid frame timing series: %u", static_cast<uint32_t>(series));
+    m_histories[static_cast<size_t>(series)].AddSample(milliseconds);
+}
+
+const SampleHistory& FrameTimings::GetHistory(FrameTimingSeries series) const
+{
+    RELEASE_CHECK(series < FrameTimingSeries::Max, "Invalid frame timing series: %u", static_cast<uint32_t>(series));
+    return m_histories[static_cast<size_t>(series)];
+}
+
+void FrameTimings::AddInputLatency(double milliseconds)
+{
+    m_inputLatencyHistogram.AddSample(milliseconds);
+}
+
+void FrameTimings::ClearInputLatencies()
+{
+    m_inputLatencyHistogram.Clear();
+}
+
+const Histogram& FrameTimings::GetInputLatencyHistogram() const
+{
+    return m_inputLatencyHistogram;
+}
+
+void FrameTimings::LogSummary() const
+{
+    for (size_t i = 0; i < kNumSeries; ++i)
+    {
+        const SampleHistory& History = m_histories[i];
+        if (History.GetCount() == 0)
+        {
+            continue;
+        }
+
+        RELEASE_LOGLINE_INFO(
+            LOG_DEFAULT,
+            "%s: min %.2f ms, avg %.2f ms, p99 %.2f ms, max %.2f ms (%zu samples)",
+            SeriesToString(static_cast<FrameTimingSeries>(i)),
+            History.GetMin(),
+            History.GetAverage(),
+            History.GetPercentile(99.0),
+            History.GetMax(),
+            History.GetCount());
+    }
+
+    m_inputLatencyHistogram.LogSummary("Input to present", "ms");
+}
+
+bool FrameTimings::WriteToFile(const std::string& filePath) const
+{
+    json seriesData = json::object();
+    for (size_t i = 0; i < kNumSeries; ++i)
+    {
+        const SampleHistory& History = m_histories[i];
+
+        json samples = json::array();
+        History.ForEachSample([&samples](double sample) -> bool
+            {
+                samples.push_back(sample);
+                return true;
+            });
+
+        seriesData[SeriesToString(static_cast<FrameTimingSeries>(i))] = {
+            { "min_ms", History.GetMin() },
+            { "avg_ms", History.GetAverage() },
+            { "p99_ms", History.GetPercentile(99.0) },
+            { "max_ms", History.GetMax() },
+            { "total_count", History.GetTotalCount() },
+            { "samples_ms", std::move(samples) },
+        };
+    }
+
+    json bucketCounts = json::array();
+    for (size_t i = 0; i < m_inputLatencyHistogram.GetNumBuckets(); ++i)
+    {
+        bucketCounts.push_back(m_inputLatencyHistogram.GetBucketCount(i));
+    }
+
+    json timingsData = {
+        { "series", std::move(seriesData) },
+        { "input_to_present", {
+            { "count", m_inputLatencyHistogram.GetCount() },
+            { "min_ms", m_inputLatencyHistogram.GetMin() },
+            { "mean_ms", m_inputLatencyHistogram.GetMean() },
+            { "p50_ms", m_inputLatencyHistogram.GetPercentile(50.0) },
+            { "p99_ms", m_inputLatencyHistogram.GetPercentile(99.0) },
+            { "max_ms", m_inputLatencyHistogram.GetMax() },
+            { "bucket_width_ms", m_inputLatencyHistogram.GetBucketWidth() },
+            { "bucket_counts", std::move(bucketCounts) },
+            { "overflow_count", m_inputLatencyHistogram.GetOverflowCount() },
+        }},
+    };
+
+    std::ofstream out(filePath, std::ios::trunc);
+    if (!out)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open frame stats file: %s", filePath.c_str());
+        return false;
+    }
+
+    out << timingsData.dump(4) << std::endl;
+    return static_cast<bool>(out);
+}
+
+const char* FrameTimings::SeriesToString(FrameTimingSeries series)
+{
+    static const char* LUT[] = {
+        "Frame",
+        "Tick",
+        "Draw",
+        "Swap",
+        "Throttle",
+        "Gpu",
+    };
+
+    static_assert(sizeof(LUT) / sizeof(LUT[0]) == kNumSeries, "Frame timing series LUT size does not match enum");
+
+    if (series >= FrameTimingSeries::Max)
+    {
+        return "Invalid";
+    }
+
+    return LUT[static_cast<size_t>(series)];
+}
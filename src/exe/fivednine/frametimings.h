@@ -0,0 +1,60 @@
+// frametimings.h
+//
+// Rolling CPU and GPU timings for recent frames, for the on-screen overlay and
+// for dumping on exit.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fivednine/system/histogram.h>
+#include <fivednine/system/samplehistory.h>
+
+enum class FrameTimingSeries
+{
+    Frame = 0, // Start of one frame to the start of the next
+    Tick,      // All simulation steps in the frame
+    Draw,      // CPU time to clear and record draw calls
+    Swap,      // Buffer swap, including any vsync wait
+    Throttle,  // Waiting for the GPU to get within the frames in flight limit
+    Gpu,       // GPU time for the draw, reported a few frames late
+    Max
+};
+
+class FrameTimings
+{
+public:
+    // About ten seconds at 60Hz
+    static constexpr size_t kHistoryCapacity = 600;
+
+    FrameTimings();
+
+    void AddSample(FrameTimingSeries series, double milliseconds);
+    const fivednine::system::SampleHistory& GetHistory(FrameTimingSeries series) const;
+
+    // Input received to the swap of the first frame reflecting it. Kept for
+    // the whole run rather than a rolling window.
+    void AddInputLatency(double milliseconds);
+    void ClearInputLatencies();
+    const fivednine::system::Histogram& GetInputLatencyHistogram() const;
+
+    void LogSummary() const;
+
+    // JSON with a min/avg/p99/max summary and the retained samples of each
+    // series, oldest first, plus the input latency histogram
+    bool WriteToFile(const std::string& filePath) const;
+
+    static const char* SeriesToString(FrameTimingSeries series);
+
+private:
+    static constexpr size_t kNumSeries = static_cast<size_t>(FrameTimingSeries::Max);
+
+    // Half-millisecond buckets up to 100ms
+    static constexpr double kInputLatencyBucketMs = 0.5;
+    static constexpr size_t kNumInputLatencyBuckets = 200;
+
+    std::vector<fivednine::system::SampleHistory> m_histories;
+    fivednine::system::Histogram                  m_inputLatencyHistogram;
+};
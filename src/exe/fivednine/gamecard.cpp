@@ -1,5 +1,7 @@
 #include "gamecard.h"
 
+#include <cstring>
+
 // Vertices
 // 3-----------------2
 // |                 |
@@ -68,10 +70,11 @@ glm::vec3 GameCard::GetPosition() const
 
 void GameCard::SetDimensions(float width, float height)
 {
-    // Diagonal *= scale vector (z-axis scale is unity)
+    // Diagonal = scale vector (z-axis scale is unity). Assign rather than
+    // accumulate so that cards can be re-laid out.
     glm::mat4& modelMatrix = m_cardMesh.GetModelMatrix();
-    modelMatrix[0][0] *= width;
-    modelMatrix[1][1] *= height;
+    modelMatrix[0][0] = width;
+    modelMatrix[1][1] = height;
 }
 
 TexturePtr GameCard::GetTexture() const
@@ -85,17 +88,28 @@ void GameCard::SetTexture(TexturePtr spTexture)
 }
 
 void GameCard::SetUniformValue1f(const char* pUniformName, float* pValue)
+{
+    SetUniformValue(pUniformName, UniformType::Float, pValue);
+}
+
+void GameCard::SetUniformValue(const char* pUniformName, UniformType type, const void* pValue)
 {
     auto it = std::find_if(std::begin(m_uniformValues), std::end(m_uniformValues),
         [pUniformName](const MeshUniformValue& uniformValue) -> bool
         {
-            return uniformValue.Name == pUniformName;
+            return strncmp(uniformValue.Name, pUniformName, sizeof(uniformValue.Name)) == 0;
         });
     if (it == std::end(m_uniformValues))
     {
-        m_uniformValues.emplace_back(pUniformName, UniformType::Float, pValue);
+        m_uniformValues.emplace_back(pUniformName, type, pValue);
         return;
     }
 
+    it->Type = type;
     it->pValue = pValue;
-}
\ No newline at end of file
+}
+
+void GameCard::ClearUniformValues()
+{
+    m_uniformValues.clear();
+}
@@ -23,6 +23,8 @@ public:
     fivednine::render::TexturePtr GetTexture() const;
     void SetTexture(fivednine::render::TexturePtr spTexture);
     void SetUniformValue1f(const char* pUniformName, float* pValue);
+    void SetUniformValue(const char* pUniformName, fivednine::render::UniformType type, const void* pValue);
+    void ClearUniformValues();
 
 private:
     GameCard() = delete;
@@ -31,7 +33,8 @@ private:
     fivednine::render::Mesh                          m_cardMesh;
     std::vector<fivednine::render::MeshUniformValue> m_uniformValues;
 
-    // All game cards are fundamentally textured unit quads.
+    // All game cards are fundamentally textured unit quads. Cards are
+    // pooled (see cardpool.h), so there are only ever a few dozen of these.
     // TODO: instanced rendering for game cards
     static const glm::vec3 s_Vertices[4];
     static const glm::vec2 s_UVs[4];
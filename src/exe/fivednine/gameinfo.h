@@ -1,10 +1,29 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+#include <fivednine/render/texturestorage.h>
+
+// Suffix of the cover texture the carousel shows for a game's TexturePrefix
+static constexpr const char* kCardTextureSuffix = "_600x900";
+
 struct GameInfo
 {
     std::string Title;
     std::string Alias;
     std::string TexturePrefix;
-};
\ No newline at end of file
+
+    // Optional games DB fields
+    uint32_t SteamAppId = 0;
+    bool     Proton = false;
+    bool     Supported = false;
+
+    // Runtime state from the launch history, not read from the games DB.
+    uint32_t LaunchCount = 0;
+    uint64_t LastLaunchedTime = 0; // Seconds since the Unix epoch, zero if never launched
+
+    // The card's cover, TexturePrefix + kCardTextureSuffix, resolved once
+    // the textures and games are loaded. Invalid if the cover is missing.
+    fivednine::render::TextureHandle CardTextureHandle = fivednine::render::kInvalidTextureHandle;
+};
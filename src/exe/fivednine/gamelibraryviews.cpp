@@ -0,0 +1,232 @@
+#include "gamelibraryviews.h"
+#include "gameinfo.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include <fivednine/log/check.h>
+
+namespace
+{
+    // Case-insensitive, punctuation-insensitive key with a leading "the "
+    // ignored, so "The King of Fighters" sorts under K.
+    std::string MakeCollationKey(const std::string& text)
+    {
+        std::string key;
+        key.reserve(text.size());
+
+        size_t startIndex = 0;
+        if (text.size() > 4 &&
+            std::tolower(static_cast<unsigned char>(text[0])) == 't' &&
+            std::tolower(static_cast<unsigned char>(text[1])) == 'h' &&
+            std::tolower(static_cast<unsigned char>(text[2])) == 'e' &&
+            text[3] == ' ')
+        {
+            startIndex = 4;
+        }
+
+        for (size_t i = startIndex; i < text.size(); ++i)
+        {
+            const unsigned char Character = static_cast<unsigned char>(text[i]);
+            if (std::isalnum(Character))
+            {
+                key.push_back(static_cast<char>(std::tolower(Character)));
+            }
+        }
+
+        return key;
+    }
+}
+
+void GameLibraryViews::Clear()
+{
+    m_sortKeys.clear();
+    for (std::vector<uint32_t>& view : m_views)
+    {
+        view.clear();
+    }
+}
+
+void GameLibraryViews::AddGame(uint32_t gameIndex, const GameInfo& gameInfo)
+{
+    RELEASE_CHECK(gameIndex == m_sortKeys.size(), "Games must be added in index order: %u", gameIndex);
+    m_sortKeys.push_back(MakeSortKeys(gameInfo));
+
+    for (size_t i = 0; i < kNumViews; ++i)
+    {
+        const LibraryView View = static_cast<LibraryView>(i);
+        if (IsIncludedInView(View, m_sortKeys[gameIndex]))
+        {
+            InsertIntoView(View, gameIndex);
+        }
+    }
+}
+
+void GameLibraryViews::UpdateGame(uint32_t gameIndex, const GameInfo& gameInfo)
+{
+    RELEASE_CHECK(gameIndex < m_sortKeys.size(), "Game index out of bounds: %u", gameIndex);
+
+    // Removal has to happen against the old keys, since that's what each view
+    // is currently sorted by.
+    SortKeys newSortKeys = MakeSortKeys(gameInfo);
+    for (size_t i = 0; i < kNumViews; ++i)
+    {
+        const LibraryView View = static_cast<LibraryView>(i);
+        if (IsIncludedInView(View, m_sortKeys[gameIndex]))
+        {
+            RemoveFromView(View, gameIndex);
+        }
+    }
+
+    m_sortKeys[gameIndex] = std::move(newSortKeys);
+    for (size_t i = 0; i < kNumViews; ++i)
+    {
+        const LibraryView View = static_cast<LibraryView>(i);
+        if (IsIncludedInView(View, m_sortKeys[gameIndex]))
+        {
+            InsertIntoView(View, gameIndex);
+        }
+    }
+}
+
+const std::vector<uint32_t>& GameLibraryViews::GetView(LibraryView view) const
+{
+    RELEASE_CHECK(view < LibraryView::Max, "Invalid library view: %u", static_cast<uint32_t>(view));
+    return m_views[static_cast<size_t>(view)];
+}
+
+const char* GameLibraryViews::ViewToString(LibraryView view)
+{
+    static const char* LUT[] = {
+        "Database",
+        "Title",
+        "Alias",
+        "RecentlyLaunched",
+        "MostLaunched",
+        "SupportedOnly",
+    };
+
+    static_assert(sizeof(LUT) / sizeof(LUT[0]) == kNumViews, "Library view LUT size does not match enum");
+
+    if (view >= LibraryView::Max)
+    {
+        return "Invalid";
+    }
+
+    return LUT[static_cast<size_t>(view)];
+}
+
+bool GameLibraryViews::ViewFromString(const std::string& viewName, LibraryView* pViewOut)
+{
+    for (size_t i = 0; i < kNumViews; ++i)
+    {
+        const LibraryView View = static_cast<LibraryView>(i);
+        if (viewName == ViewToString(View))
+        {
+            *pViewOut = View;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+GameLibraryViews::SortKeys GameLibraryViews::MakeSortKeys(const GameInfo& gameInfo)
+{
+    SortKeys sortKeys;
+    sortKeys.TitleKey = MakeCollationKey(gameInfo.Title);
+    sortKeys.AliasKey = MakeCollationKey(gameInfo.Alias);
+    sortKeys.LastLaunchedTime = gameInfo.LastLaunchedTime;
+    sortKeys.LaunchCount = gameInfo.LaunchCount;
+    sortKeys.Supported = gameInfo.Supported;
+    return sortKeys;
+}
+
+bool GameLibraryViews::IsIncludedInView(LibraryView view, const SortKeys& sortKeys)
+{
+    if (view == LibraryView::SupportedOnly)
+    {
+        return sortKeys.Supported;
+    }
+
+    return true;
+}
+
+bool GameLibraryViews::Precedes(LibraryView view, uint32_t lhsGameIndex, uint32_t rhsGameIndex) const
+{
+    const SortKeys& Lhs = m_sortKeys[lhsGameIndex];
+    const SortKeys& Rhs = m_sortKeys[rhsGameIndex];
+
+    // Every view breaks ties by game index, so each game has exactly one
+    // position in a view and can be located with a binary search.
+    switch (view)
+    {
+        case LibraryView::Title:
+            // Fallthrough
+        case LibraryView::SupportedOnly:
+            if (Lhs.TitleKey != Rhs.TitleKey)
+            {
+                return Lhs.TitleKey < Rhs.TitleKey;
+            }
+            break;
+        case LibraryView::Alias:
+            if (Lhs.AliasKey != Rhs.AliasKey)
+            {
+                return Lhs.AliasKey < Rhs.AliasKey;
+            }
+            break;
+        case LibraryView::RecentlyLaunched:
+            if (Lhs.LastLaunchedTime != Rhs.LastLaunchedTime)
+            {
+                return Lhs.LastLaunchedTime > Rhs.LastLaunchedTime;
+            }
+            if (Lhs.TitleKey != Rhs.TitleKey)
+            {
+                return Lhs.TitleKey < Rhs.TitleKey;
+            }
+            break;
+        case LibraryView::MostLaunched:
+            if (Lhs.LaunchCount != Rhs.LaunchCount)
+            {
+                return Lhs.LaunchCount > Rhs.LaunchCount;
+            }
+            if (Lhs.LastLaunchedTime != Rhs.LastLaunchedTime)
+            {
+                return Lhs.LastLaunchedTime > Rhs.LastLaunchedTime;
+            }
+            if (Lhs.TitleKey != Rhs.TitleKey)
+            {
+                return Lhs.TitleKey < Rhs.TitleKey;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return lhsGameIndex < rhsGameIndex;
+}
+
+void GameLibraryViews::InsertIntoView(LibraryView view, uint32_t gameIndex)
+{
+    std::vector<uint32_t>& viewIndices = m_views[static_cast<size_t>(view)];
+    auto it = std::upper_bound(std::begin(viewIndices), std::end(viewIndices), gameIndex,
+        [this, view](uint32_t lhs, uint32_t rhs) -> bool
+        {
+            return Precedes(view, lhs, rhs);
+        });
+    viewIndices.insert(it, gameIndex);
+}
+
+void GameLibraryViews::RemoveFromView(LibraryView view, uint32_t gameIndex)
+{
+    std::vector<uint32_t>& viewIndices = m_views[static_cast<size_t>(view)];
+    auto it = std::lower_bound(std::begin(viewIndices), std::end(viewIndices), gameIndex,
+        [this, view](uint32_t lhs, uint32_t rhs) -> bool
+        {
+            return Precedes(view, lhs, rhs);
+        });
+    RELEASE_CHECK(
+        it != std::end(viewIndices) && *it == gameIndex,
+        "Game %u missing from library view %s", gameIndex, ViewToString(view));
+    viewIndices.erase(it);
+}
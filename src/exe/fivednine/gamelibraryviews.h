@@ -0,0 +1,67 @@
+// gamelibraryviews.h
+//
+// Precomputed orderings and filters over the games library. Each view is a
+// permutation of indices into the app's game info storage which is kept up to
+// date as games are added or changed, so switching views never re-sorts or
+// copies GameInfo records.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GameInfo;
+
+enum class LibraryView
+{
+    Database = 0,     // As listed in the games DB
+    Title,            // By title collation key
+    Alias,            // By alias collation key
+    RecentlyLaunched, // Most recently launched first
+    MostLaunched,     // Most frequently launched first
+    SupportedOnly,    // Supported games only, by title
+    Max
+};
+
+class GameLibraryViews
+{
+public:
+    void Clear();
+
+    // Games must be added with contiguous indices starting at zero.
+    void AddGame(uint32_t gameIndex, const GameInfo& gameInfo);
+
+    // Re-keys a game which has already been added and moves it within each
+    // view as needed.
+    void UpdateGame(uint32_t gameIndex, const GameInfo& gameInfo);
+
+    const std::vector<uint32_t>& GetView(LibraryView view) const;
+
+    static const char* ViewToString(LibraryView view);
+    static bool ViewFromString(const std::string& viewName, LibraryView* pViewOut);
+
+private:
+    struct SortKeys
+    {
+        std::string TitleKey;
+        std::string AliasKey;
+        uint64_t    LastLaunchedTime = 0;
+        uint32_t    LaunchCount = 0;
+        bool        Supported = false;
+    };
+
+    static SortKeys MakeSortKeys(const GameInfo& gameInfo);
+    static bool IsIncludedInView(LibraryView view, const SortKeys& sortKeys);
+
+    bool Precedes(LibraryView view, uint32_t lhsGameIndex, uint32_t rhsGameIndex) const;
+    void InsertIntoView(LibraryView view, uint32_t gameIndex);
+    void RemoveFromView(LibraryView view, uint32_t gameIndex);
+
+    static constexpr size_t kNumViews = static_cast<size_t>(LibraryView::Max);
+
+    // Indexed by game index
+    std::vector<SortKeys> m_sortKeys;
+    std::vector<uint32_t> m_views[kNumViews];
+};
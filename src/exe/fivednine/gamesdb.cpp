@@ -0,0 +1,145 @@
+#include "gamesdb.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+
+bool
+ParseGamesDb(
+    std::istream& gamesDbIn,
+    const std::string& sourceName,
+    std::vector<GameInfo>* pGameInfosOut,
+    uint32_t* pNumSkippedOut)
+{
+    RELEASE_CHECK(pGameInfosOut != nullptr, "pGameInfosOut cannot be null");
+    pGameInfosOut->clear();
+
+    json gamesDbData = json::parse(gamesDbIn, nullptr, false);
+    if (gamesDbData.is_discarded())
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Games database is not valid JSON: %s", sourceName.c_str());
+        return false;
+    }
+
+    if (!gamesDbData.contains("games") || !gamesDbData["games"].is_array())
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Games database missing required field 'games': %s",
+            sourceName.c_str());
+        return false;
+    }
+
+    // Defer failure so we can log as much info as possible
+    uint32_t numSkipped = 0;
+    const json& GamesArray = gamesDbData["games"];
+    pGameInfosOut->reserve(GamesArray.size());
+    for (const auto& gameEntry : GamesArray)
+    {
+        GameInfo gameInfo;
+        if (!gameEntry.contains("title") || !gameEntry["title"].is_string())
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "Game DB entry is missing required string field: 'title'");
+            ++numSkipped;
+            continue;
+        }
+        gameInfo.Title = gameEntry["title"].get<std::string>();
+
+        if (!gameEntry.contains("alias") || !gameEntry["alias"].is_string())
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "Game DB entry %s is missing required string field: 'alias'",
+                gameInfo.Title.c_str());
+            ++numSkipped;
+            continue;
+        }
+        gameInfo.Alias = gameEntry["alias"].get<std::string>();
+
+        if (!gameEntry.contains("texture_prefix") || !gameEntry["texture_prefix"].is_string())
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "Game DB entry %s is missing required string field: 'texture_prefix'",
+                gameInfo.Title.c_str());
+            ++numSkipped;
+            continue;
+        }
+        gameInfo.TexturePrefix = gameEntry["texture_prefix"].get<std::string>();
+
+        // Optional fields, though the entry is still skipped if one is there
+        // with the wrong type
+        const bool HasValidSteamAppId = !gameEntry.contains("steam_appid") ||
+            (gameEntry["steam_appid"].is_number_unsigned() && gameEntry["steam_appid"].get<uint64_t>() <= UINT32_MAX);
+        const bool HasValidProton = !gameEntry.contains("proton") || gameEntry["proton"].is_boolean();
+        const bool HasValidSupported = !gameEntry.contains("supported") || gameEntry["supported"].is_boolean();
+        if (!HasValidSteamAppId || !HasValidProton || !HasValidSupported)
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "Game DB entry %s has a mistyped field: 'steam_appid' must be an unsigned integer, "
+                "'proton' and 'supported' true or false",
+                gameInfo.Title.c_str());
+            ++numSkipped;
+            continue;
+        }
+
+        if (gameEntry.contains("steam_appid"))
+        {
+            gameInfo.SteamAppId = gameEntry["steam_appid"].get<uint32_t>();
+        }
+
+        if (gameEntry.contains("proton"))
+        {
+            gameInfo.Proton = gameEntry["proton"].get<bool>();
+        }
+
+        if (gameEntry.contains("supported"))
+        {
+            gameInfo.Supported = gameEntry["supported"].get<bool>();
+        }
+
+        pGameInfosOut->push_back(std::move(gameInfo));
+    }
+
+    if (pNumSkippedOut)
+    {
+        *pNumSkippedOut = numSkipped;
+    }
+
+    return true;
+}
+
+bool
+LoadGamesDb(
+    const std::string& gamesDbPath,
+    std::vector<GameInfo>* pGameInfosOut,
+    uint32_t* pNumSkippedOut)
+{
+    if (!std::filesystem::exists(gamesDbPath))
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Games database configuration path does not exist: %s",
+            gamesDbPath.c_str());
+        return false;
+    }
+
+    std::ifstream gamesDbIn(gamesDbPath);
+    if (!gamesDbIn)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open games database: %s", gamesDbPath.c_str());
+        return false;
+    }
+
+    return ParseGamesDb(gamesDbIn, gamesDbPath, pGameInfosOut, pNumSkippedOut);
+}
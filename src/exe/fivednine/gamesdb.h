@@ -0,0 +1,29 @@
+// gamesdb.h
+//
+// Reads the games database (gamesdb.json) into GameInfo entries. Entries
+// missing a required field are logged and skipped rather than failing the
+// whole database, so one bad entry doesn't hide every other game.
+
+#pragma once
+
+#include "gameinfo.h"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Returns false if the database can't be read or parsed, or has no 'games'
+// array. sourceName is only used for logging. pNumSkippedOut is optional.
+bool
+ParseGamesDb(
+    std::istream& gamesDbIn,
+    const std::string& sourceName,
+    std::vector<GameInfo>* pGameInfosOut,
+    uint32_t* pNumSkippedOut = nullptr);
+
+bool
+LoadGamesDb(
+    const std::string& gamesDbPath,
+    std::vector<GameInfo>* pGameInfosOut,
+    uint32_t* pNumSkippedOut = nullptr);
@@ -0,0 +1,221 @@
+#include "inputrecording.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+#include <fivednine/system/time.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+namespace
+{
+    // File layout, host byte order:
+    //   header: magic[4], version (u32), simulation Hz (u32), event count (u32)
+    //   events: step (u64), timestamp offset ns (u64), action (u8), pressed (u8)
+    // Version 1 recorded keys rather than actions.
+    static constexpr char     kRecordingMagic[4] = { '5', 'D', '9', 'I' };
+    static constexpr uint32_t kRecordingVersion = 2;
+
+    template<typename T>
+    void WriteValue(std::ostream& out, T value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool ReadValue(std::istream& in, T* pValueOut)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(pValueOut), sizeof(*pValueOut)));
+    }
+}
+
+void InputRecorder::Begin(Window* pWindow, uint32_t simulationHz)
+{
+    RELEASE_CHECK(pWindow != nullptr, "pWindow cannot be null");
+    m_pfnForwardHandler = pWindow->GetInputEventHandler();
+    m_pForwardUserPointer = pWindow->GetUserPointer();
+    pWindow->SetInputEventHandler(HandleInputEvent);
+    pWindow->SetUserPointer(this);
+
+    m_simulationHz = simulationHz;
+    m_simulationStep = 0;
+    m_startTimestampNs = system::time::GetTicksNs();
+    m_events.clear();
+}
+
+void InputRecorder::SetSimulationStep(uint64_t simulationStep)
+{
+    m_simulationStep = simulationStep;
+}
+
+bool InputRecorder::WriteToFile(const std::string& recordingPath) const
+{
+    std::ofstream recordingOut(recordingPath, std::ios::binary | std::ios::trunc);
+    if (!recordingOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open input recording for writing: %s", recordingPath.c_str());
+        return false;
+    }
+
+    recordingOut.write(kRecordingMagic, sizeof(kRecordingMagic));
+    WriteValue<uint32_t>(recordingOut, kRecordingVersion);
+    WriteValue<uint32_t>(recordingOut, m_simulationHz);
+    WriteValue<uint32_t>(recordingOut, static_cast<uint32_t>(m_events.size()));
+    for (const RecordedInputEvent& event : m_events)
+    {
+        WriteValue<uint64_t>(recordingOut, event.SimulationStep);
+        WriteValue<uint64_t>(recordingOut, event.TimestampOffsetNs);
+        WriteValue<uint8_t>(recordingOut, static_cast<uint8_t>(event.ActionType));
+        WriteValue<uint8_t>(recordingOut, event.IsPressed ? 1 : 0);
+    }
+
+    if (!recordingOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write input recording: %s", recordingPath.c_str());
+        return false;
+    }
+
+    RELEASE_LOGLINE_INFO(
+        LOG_DEFAULT,
+        "Recorded %zu input events over %llu steps to %s",
+        m_events.size(),
+        static_cast<unsigned long long>(m_simulationStep),
+        recordingPath.c_str());
+    return true;
+}
+
+void InputRecorder::HandleInputEvent(const input::InputEvent& event, void* pUserPointer)
+{
+    InputRecorder* pRecorder = static_cast<InputRecorder*>(pUserPointer);
+
+    RecordedInputEvent recordedEvent;
+    recordedEvent.SimulationStep = pRecorder->m_simulationStep;
+    recordedEvent.TimestampOffsetNs =
+        event.TimestampNs > pRecorder->m_startTimestampNs ? event.TimestampNs - pRecorder->m_startTimestampNs : 0;
+    recordedEvent.ActionType = event.ActionType;
+    recordedEvent.IsPressed = event.IsPressed;
+    pRecorder->m_events.push_back(recordedEvent);
+
+    if (pRecorder->m_pfnForwardHandler)
+    {
+        pRecorder->m_pfnForwardHandler(event, pRecorder->m_pForwardUserPointer);
+    }
+}
+
+bool InputReplayer::Load(const std::string& recordingPath, uint32_t simulationHz)
+{
+    m_events.clear();
+    m_nextEventIndex = 0;
+
+    std::ifstream recordingIn(recordingPath, std::ios::binary);
+    if (!recordingIn)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open input recording: %s", recordingPath.c_str());
+        return false;
+    }
+
+    char magic[sizeof(kRecordingMagic)];
+    uint32_t version, recordedSimulationHz, numEvents;
+    if (!recordingIn.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, kRecordingMagic, sizeof(magic)) != 0 ||
+        !ReadValue(recordingIn, &version) ||
+        version != kRecordingVersion ||
+        !ReadValue(recordingIn, &recordedSimulationHz) ||
+        !ReadValue(recordingIn, &numEvents))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Not a supported input recording: %s", recordingPath.c_str());
+        return false;
+    }
+
+    if (recordedSimulationHz != simulationHz)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Input recording %s was made at %uHz, but the simulation runs at %uHz",
+            recordingPath.c_str(),
+            recordedSimulationHz,
+            simulationHz);
+        return false;
+    }
+
+    m_events.reserve(numEvents);
+    for (uint32_t i = 0; i < numEvents; ++i)
+    {
+        RecordedInputEvent event;
+        uint8_t actionType, isPressed;
+        if (!ReadValue(recordingIn, &event.SimulationStep) ||
+            !ReadValue(recordingIn, &event.TimestampOffsetNs) ||
+            !ReadValue(recordingIn, &actionType) ||
+            !ReadValue(recordingIn, &isPressed))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Truncated input recording: %s", recordingPath.c_str());
+            m_events.clear();
+            return false;
+        }
+
+        if (!m_events.empty() && event.SimulationStep < m_events.back().SimulationStep)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Input recording events out of order: %s", recordingPath.c_str());
+            m_events.clear();
+            return false;
+        }
+
+        if (actionType >= static_cast<uint8_t>(input::ActionType::Max))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Unknown action in input recording: %s", recordingPath.c_str());
+            m_events.clear();
+            return false;
+        }
+
+        event.ActionType = static_cast<input::ActionType>(actionType);
+        event.IsPressed = isPressed != 0;
+        m_events.push_back(event);
+    }
+
+    return true;
+}
+
+void InputReplayer::Begin(Window* pWindow)
+{
+    RELEASE_CHECK(pWindow != nullptr, "pWindow cannot be null");
+    m_pfnForwardHandler = pWindow->GetInputEventHandler();
+    m_pForwardUserPointer = pWindow->GetUserPointer();
+    pWindow->SetInputEventHandler(IgnoreInputEvent);
+    pWindow->SetUserPointer(this);
+    m_nextEventIndex = 0;
+}
+
+void InputReplayer::DeliverEvents(uint64_t simulationStep)
+{
+    while (m_nextEventIndex < m_events.size() && m_events[m_nextEventIndex].SimulationStep <= simulationStep)
+    {
+        const RecordedInputEvent& RecordedEvent = m_events[m_nextEventIndex++];
+        if (m_pfnForwardHandler)
+        {
+            // Stamped now, so input latency is measured for the replay
+            input::InputEvent event;
+            event.ActionType = RecordedEvent.ActionType;
+            event.IsPressed = RecordedEvent.IsPressed;
+            event.TimestampNs = system::time::GetTicksNs();
+            m_pfnForwardHandler(event, m_pForwardUserPointer);
+        }
+    }
+}
+
+bool InputReplayer::IsFinished() const
+{
+    return m_nextEventIndex >= m_events.size();
+}
+
+uint64_t InputReplayer::GetNextEventStep() const
+{
+    RELEASE_CHECK(!IsFinished(), "No more input events to replay");
+    return m_events[m_nextEventIndex].SimulationStep;
+}
+
+void InputReplayer::IgnoreInputEvent(const input::InputEvent& /* event */, void* /* pUserPointer */)
+{
+}
@@ -0,0 +1,82 @@
+// inputrecording.h
+//
+// Records the window's input events to a file and replays them for
+// reproducible performance runs. Events are keyed to the simulation step at
+// which they arrived rather than to wall time, so a replay drives the
+// selector through exactly the same states whether it runs in real time or
+// as fast as possible.
+//
+// The step counter is maintained by the main loop and keeps advancing while
+// the loop is blocked idle. Nothing changes while idle, so a replay skips
+// those steps instead of simulating them.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fivednine/render/window.h>
+
+struct RecordedInputEvent
+{
+    uint64_t SimulationStep = 0;
+    // Relative to the start of the recording; informational only
+    uint64_t TimestampOffsetNs = 0;
+    fivednine::input::ActionType ActionType = fivednine::input::ActionType::None;
+    bool                         IsPressed = false;
+};
+
+class InputRecorder
+{
+public:
+    // Takes over the window's input handler; events are recorded, then passed
+    // on to the handler that was installed before (the app's).
+    void Begin(fivednine::render::Window* pWindow, uint32_t simulationHz);
+
+    // Called by the main loop before each simulation step
+    void SetSimulationStep(uint64_t simulationStep);
+
+    bool WriteToFile(const std::string& recordingPath) const;
+
+private:
+    static void HandleInputEvent(const fivednine::input::InputEvent& event, void* pUserPointer);
+
+    fivednine::input::FnInputEventHandler m_pfnForwardHandler = nullptr;
+    void*                                 m_pForwardUserPointer = nullptr;
+
+    uint32_t m_simulationHz = 0;
+    uint64_t m_simulationStep = 0;
+    uint64_t m_startTimestampNs = 0;
+    std::vector<RecordedInputEvent> m_events;
+};
+
+class InputReplayer
+{
+public:
+    // Fails if the recording is malformed or was made at a different
+    // simulation rate, which would replay at the wrong speed.
+    bool Load(const std::string& recordingPath, uint32_t simulationHz);
+
+    // Takes over the window's input handler so that live input is ignored
+    // for the duration of the replay. Quit events still come through.
+    void Begin(fivednine::render::Window* pWindow);
+
+    // Delivers all events recorded at or before simulationStep to the
+    // previously installed handler, exactly as live input would be.
+    void DeliverEvents(uint64_t simulationStep);
+
+    bool IsFinished() const;
+
+    // Step of the next undelivered event; only valid if !IsFinished()
+    uint64_t GetNextEventStep() const;
+
+private:
+    static void IgnoreInputEvent(const fivednine::input::InputEvent& event, void* pUserPointer);
+
+    fivednine::input::FnInputEventHandler m_pfnForwardHandler = nullptr;
+    void*                                 m_pForwardUserPointer = nullptr;
+
+    std::vector<RecordedInputEvent> m_events;
+    size_t                          m_nextEventIndex = 0;
+};
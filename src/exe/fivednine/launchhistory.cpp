@@ -0,0 +1,545 @@
+#include "launchhistory.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fivednine/log/log.h>
+
+using namespace fivednine;
+
+namespace
+{
+    // Files are written in host byte order; they never leave the cabinet.
+    static constexpr uint32_t kLogMagic = 0x4C394435;      // "5D9L"
+    static constexpr uint32_t kSnapshotMagic = 0x53394435; // "5D9S"
+    static constexpr uint32_t kFormatVersion = 1;
+
+    // Batching and compaction policy
+    static constexpr uint32_t kMaxPendingRecords = 16;
+    static constexpr uint64_t kMaxPendingSeconds = 5;
+    static constexpr uint32_t kCompactionRecordThreshold = 4096;
+
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Generation;
+    };
+
+    struct LogRecordHeader
+    {
+        uint64_t Timestamp;
+        uint32_t Checksum;
+        uint16_t AliasLength;
+    };
+
+    uint32_t Fnv1a(const uint8_t* pBytes, size_t length, uint32_t hash = 2166136261u)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= pBytes[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    uint32_t RecordChecksum(uint64_t timestamp, const char* pAlias, uint16_t aliasLength)
+    {
+        uint32_t hash = Fnv1a(reinterpret_cast<const uint8_t*>(&timestamp), sizeof(timestamp));
+        hash = Fnv1a(reinterpret_cast<const uint8_t*>(&aliasLength), sizeof(aliasLength), hash);
+        return Fnv1a(reinterpret_cast<const uint8_t*>(pAlias), aliasLength, hash);
+    }
+
+    template<typename T>
+    void AppendBytes(std::vector<uint8_t>* pBytes, const T& value)
+    {
+        const uint8_t* pValueBytes = reinterpret_cast<const uint8_t*>(&value);
+        pBytes->insert(std::end(*pBytes), pValueBytes, pValueBytes + sizeof(T));
+    }
+
+    template<typename T>
+    bool ReadBytes(const std::vector<uint8_t>& bytes, size_t* pOffset, T* pValueOut)
+    {
+        if (bytes.size() - *pOffset < sizeof(T))
+        {
+            return false;
+        }
+
+        memcpy(pValueOut, bytes.data() + *pOffset, sizeof(T));
+        *pOffset += sizeof(T);
+        return true;
+    }
+
+    bool ReadFileBytes(const std::string& filePath, std::vector<uint8_t>* pBytesOut)
+    {
+        std::ifstream in(filePath, std::ios::binary);
+        if (!in)
+        {
+            return false;
+        }
+
+        pBytesOut->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool WriteAll(int fd, const uint8_t* pBytes, size_t length)
+    {
+        while (length > 0)
+        {
+            const ssize_t Written = write(fd, pBytes, length);
+            if (Written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+
+            pBytes += Written;
+            length -= static_cast<size_t>(Written);
+        }
+
+        return true;
+    }
+
+    // Makes a rename within the directory durable
+    void FsyncParentDirectory(const std::string& filePath)
+    {
+        std::string directoryPath = std::filesystem::path(filePath).parent_path().string();
+        if (directoryPath.empty())
+        {
+            directoryPath = ".";
+        }
+
+        const int DirectoryFd = open(directoryPath.c_str(), O_RDONLY | O_DIRECTORY);
+        if (DirectoryFd >= 0)
+        {
+            fsync(DirectoryFd);
+            close(DirectoryFd);
+        }
+    }
+
+    // Write to a temporary file, fsync, then rename over the destination
+    bool WriteFileAtomically(const std::string& filePath, const std::vector<uint8_t>& bytes)
+    {
+        const std::string TempPath = filePath + ".tmp";
+        const int Fd = open(TempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (Fd < 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create %s: %s", TempPath.c_str(), strerror(errno));
+            return false;
+        }
+
+        const bool Succeeded = WriteAll(Fd, bytes.data(), bytes.size()) && fsync(Fd) == 0;
+        close(Fd);
+        if (!Succeeded || rename(TempPath.c_str(), filePath.c_str()) != 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write %s: %s", filePath.c_str(), strerror(errno));
+            unlink(TempPath.c_str());
+            return false;
+        }
+
+        FsyncParentDirectory(filePath);
+        return true;
+    }
+}
+
+LaunchHistory::~LaunchHistory()
+{
+    Close();
+}
+
+bool LaunchHistory::Open(const std::string& logPath)
+{
+    Close();
+
+    m_logPath = logPath;
+    m_snapshotPath = logPath + ".snapshot";
+    m_statsByAlias.clear();
+
+    uint64_t snapshotGeneration = 0;
+    if (!LoadSnapshot(&snapshotGeneration))
+    {
+        return false;
+    }
+
+    if (!ReplayLog(snapshotGeneration))
+    {
+        return false;
+    }
+
+    RELEASE_LOGLINE_INFO(
+        LOG_DEFAULT,
+        "Loaded launch history for %zu games (%u log records)",
+        m_statsByAlias.size(),
+        m_numLogRecords);
+    return true;
+}
+
+void LaunchHistory::Close()
+{
+    if (m_logFd < 0)
+    {
+        return;
+    }
+
+    Flush();
+    close(m_logFd);
+    m_logFd = -1;
+
+    // Anything the last flush couldn't write belongs to this log, so it
+    // mustn't be appended to (or cut back from) the next one opened
+    m_logSize = 0;
+    m_hasPartialBatch = false;
+    m_pendingBytes.clear();
+    m_numPendingRecords = 0;
+    m_oldestPendingTimestamp = 0;
+}
+
+bool LaunchHistory::IsOpen() const
+{
+    return m_logFd >= 0;
+}
+
+bool LaunchHistory::RecordLaunch(const std::string& alias, uint64_t timestamp)
+{
+    if (!IsOpen())
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Attempting to record a launch without an open history");
+        return false;
+    }
+
+    if (alias.empty() || alias.size() > UINT16_MAX)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Invalid alias length for launch history: %zu", alias.size());
+        return false;
+    }
+
+    ApplyLaunch(alias, timestamp);
+
+    LogRecordHeader recordHeader;
+    recordHeader.Timestamp = timestamp;
+    recordHeader.AliasLength = static_cast<uint16_t>(alias.size());
+    recordHeader.Checksum = RecordChecksum(timestamp, alias.data(), recordHeader.AliasLength);
+    AppendBytes(&m_pendingBytes, recordHeader.Timestamp);
+    AppendBytes(&m_pendingBytes, recordHeader.Checksum);
+    AppendBytes(&m_pendingBytes, recordHeader.AliasLength);
+    m_pendingBytes.insert(std::end(m_pendingBytes), std::begin(alias), std::end(alias));
+
+    if (m_numPendingRecords == 0)
+    {
+        m_oldestPendingTimestamp = timestamp;
+    }
+    ++m_numPendingRecords;
+
+    if (m_numPendingRecords >= kMaxPendingRecords)
+    {
+        return Flush();
+    }
+
+    return true;
+}
+
+const LaunchStats* LaunchHistory::FindStats(const std::string& alias) const
+{
+    auto it = m_statsByAlias.find(alias);
+    if (it == std::end(m_statsByAlias))
+    {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+void LaunchHistory::Update(uint64_t nowTimestamp)
+{
+    if (m_numPendingRecords > 0 && nowTimestamp >= m_oldestPendingTimestamp + kMaxPendingSeconds)
+    {
+        Flush();
+    }
+}
+
+bool LaunchHistory::Flush()
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    if (!WritePendingRecords(true /* isSyncing */))
+    {
+        return false;
+    }
+
+    if (m_numLogRecords >= kCompactionRecordThreshold)
+    {
+        return Compact();
+    }
+
+    return true;
+}
+
+bool LaunchHistory::Compact()
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    // Not synced; the snapshot makes the log redundant
+    if (!WritePendingRecords(false /* isSyncing */))
+    {
+        return false;
+    }
+
+    // The snapshot subsumes everything up to and including the current log
+    std::vector<uint8_t> snapshotBytes;
+    AppendBytes(&snapshotBytes, FileHeader{ kSnapshotMagic, kFormatVersion, m_logGeneration });
+    AppendBytes(&snapshotBytes, static_cast<uint32_t>(m_statsByAlias.size()));
+    for (const auto& [alias, launchStats] : m_statsByAlias)
+    {
+        AppendBytes(&snapshotBytes, static_cast<uint16_t>(alias.size()));
+        snapshotBytes.insert(std::end(snapshotBytes), std::begin(alias), std::end(alias));
+        AppendBytes(&snapshotBytes, launchStats.LaunchCount);
+        AppendBytes(&snapshotBytes, launchStats.LastLaunchedTime);
+    }
+    AppendBytes(&snapshotBytes, Fnv1a(snapshotBytes.data(), snapshotBytes.size()));
+
+    if (!WriteFileAtomically(m_snapshotPath, snapshotBytes))
+    {
+        return false;
+    }
+
+    // If we die before the new log lands, the old log's generation is already
+    // covered by the snapshot and will be skipped on load.
+    close(m_logFd);
+    m_logFd = -1;
+    return StartNewLog(m_logGeneration + 1);
+}
+
+bool LaunchHistory::WritePendingRecords(bool isSyncing)
+{
+    // Anything left past the last whole batch by an earlier failure would
+    // otherwise end up in the log twice, or as a torn record ahead of good
+    // ones
+    if (m_hasPartialBatch)
+    {
+        if (ftruncate(m_logFd, static_cast<off_t>(m_logSize)) != 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to truncate launch history log: %s", strerror(errno));
+            return false;
+        }
+        m_hasPartialBatch = false;
+    }
+
+    if (m_numPendingRecords == 0)
+    {
+        return true;
+    }
+
+    if (!WriteAll(m_logFd, m_pendingBytes.data(), m_pendingBytes.size()) ||
+        (isSyncing && fsync(m_logFd) != 0))
+    {
+        // Keep the batch around to retry on the next flush
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to append to launch history: %s", strerror(errno));
+        m_hasPartialBatch = ftruncate(m_logFd, static_cast<off_t>(m_logSize)) != 0;
+        return false;
+    }
+
+    m_logSize += m_pendingBytes.size();
+    m_numLogRecords += m_numPendingRecords;
+    m_pendingBytes.clear();
+    m_numPendingRecords = 0;
+    return true;
+}
+
+uint64_t LaunchHistory::GetCurrentTimestamp()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+bool LaunchHistory::LoadSnapshot(uint64_t* pGenerationOut)
+{
+    *pGenerationOut = 0;
+
+    std::vector<uint8_t> bytes;
+    if (!ReadFileBytes(m_snapshotPath, &bytes))
+    {
+        // No snapshot yet
+        return true;
+    }
+
+    uint32_t storedChecksum = 0;
+    if (bytes.size() < sizeof(FileHeader) + sizeof(storedChecksum))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Launch history snapshot is truncated: %s", m_snapshotPath.c_str());
+        return false;
+    }
+
+    const size_t PayloadSize = bytes.size() - sizeof(storedChecksum);
+    memcpy(&storedChecksum, bytes.data() + PayloadSize, sizeof(storedChecksum));
+    if (Fnv1a(bytes.data(), PayloadSize) != storedChecksum)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Launch history snapshot is corrupt: %s", m_snapshotPath.c_str());
+        return false;
+    }
+    bytes.resize(PayloadSize);
+
+    size_t offset = 0;
+    FileHeader header;
+    uint32_t numEntries = 0;
+    if (!ReadBytes(bytes, &offset, &header) ||
+        header.Magic != kSnapshotMagic ||
+        header.Version != kFormatVersion ||
+        !ReadBytes(bytes, &offset, &numEntries))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Unrecognized launch history snapshot: %s", m_snapshotPath.c_str());
+        return false;
+    }
+
+    m_statsByAlias.reserve(numEntries);
+    for (uint32_t i = 0; i < numEntries; ++i)
+    {
+        uint16_t aliasLength = 0;
+        LaunchStats launchStats;
+        if (!ReadBytes(bytes, &offset, &aliasLength) || bytes.size() - offset < aliasLength)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Malformed launch history snapshot: %s", m_snapshotPath.c_str());
+            return false;
+        }
+
+        std::string alias(reinterpret_cast<const char*>(bytes.data() + offset), aliasLength);
+        offset += aliasLength;
+        if (!ReadBytes(bytes, &offset, &launchStats.LaunchCount) ||
+            !ReadBytes(bytes, &offset, &launchStats.LastLaunchedTime))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Malformed launch history snapshot: %s", m_snapshotPath.c_str());
+            return false;
+        }
+
+        m_statsByAlias[std::move(alias)] = launchStats;
+    }
+
+    *pGenerationOut = header.Generation;
+    return true;
+}
+
+bool LaunchHistory::ReplayLog(uint64_t snapshotGeneration)
+{
+    std::vector<uint8_t> bytes;
+    if (!ReadFileBytes(m_logPath, &bytes))
+    {
+        return StartNewLog(snapshotGeneration + 1);
+    }
+
+    size_t offset = 0;
+    FileHeader header;
+    if (!ReadBytes(bytes, &offset, &header) || header.Magic != kLogMagic || header.Version != kFormatVersion)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Unrecognized launch history log: %s", m_logPath.c_str());
+        return false;
+    }
+
+    if (header.Generation <= snapshotGeneration)
+    {
+        // Left over from an interrupted compaction; already in the snapshot.
+        return StartNewLog(snapshotGeneration + 1);
+    }
+
+    m_numLogRecords = 0;
+    size_t lastGoodOffset = offset;
+    while (offset < bytes.size())
+    {
+        LogRecordHeader recordHeader;
+        if (!ReadBytes(bytes, &offset, &recordHeader.Timestamp) ||
+            !ReadBytes(bytes, &offset, &recordHeader.Checksum) ||
+            !ReadBytes(bytes, &offset, &recordHeader.AliasLength) ||
+            bytes.size() - offset < recordHeader.AliasLength)
+        {
+            break;
+        }
+
+        const char* pAlias = reinterpret_cast<const char*>(bytes.data() + offset);
+        if (RecordChecksum(recordHeader.Timestamp, pAlias, recordHeader.AliasLength) != recordHeader.Checksum)
+        {
+            break;
+        }
+        offset += recordHeader.AliasLength;
+
+        ApplyLaunch(std::string(pAlias, recordHeader.AliasLength), recordHeader.Timestamp);
+        ++m_numLogRecords;
+        lastGoodOffset = offset;
+    }
+
+    m_logFd = open(m_logPath.c_str(), O_WRONLY | O_APPEND);
+    if (m_logFd < 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open launch history log %s: %s", m_logPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (lastGoodOffset != bytes.size())
+    {
+        // Drop the torn tail so that new records append cleanly
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Discarding %zu bytes of torn launch history",
+            bytes.size() - lastGoodOffset);
+        if (ftruncate(m_logFd, static_cast<off_t>(lastGoodOffset)) != 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to truncate launch history log: %s", strerror(errno));
+            close(m_logFd);
+            m_logFd = -1;
+            return false;
+        }
+    }
+
+    m_logGeneration = header.Generation;
+    m_logSize = lastGoodOffset;
+    m_hasPartialBatch = false;
+    return true;
+}
+
+bool LaunchHistory::StartNewLog(uint64_t generation)
+{
+    std::vector<uint8_t> headerBytes;
+    AppendBytes(&headerBytes, FileHeader{ kLogMagic, kFormatVersion, generation });
+    if (!WriteFileAtomically(m_logPath, headerBytes))
+    {
+        return false;
+    }
+
+    m_logFd = open(m_logPath.c_str(), O_WRONLY | O_APPEND);
+    if (m_logFd < 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open launch history log %s: %s", m_logPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_logGeneration = generation;
+    m_numLogRecords = 0;
+    m_logSize = headerBytes.size();
+    m_hasPartialBatch = false;
+    return true;
+}
+
+void LaunchHistory::ApplyLaunch(const std::string& alias, uint64_t timestamp)
+{
+    LaunchStats& launchStats = m_statsByAlias[alias];
+    ++launchStats.LaunchCount;
+    if (timestamp > launchStats.LastLaunchedTime)
+    {
+        launchStats.LastLaunchedTime = timestamp;
+    }
+}
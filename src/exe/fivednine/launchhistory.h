@@ -0,0 +1,79 @@
+// launchhistory.h
+//
+// Per-game launch counts and last-launched times, keyed by game alias.
+//
+// Launches are appended to a binary log rather than rewriting anything, and
+// appends are batched so that fsync() runs at most once per batch. Once the
+// log grows past a threshold it's compacted into a snapshot of the aggregated
+// stats and a fresh log is started. Loading reads the snapshot and replays the
+// log, which is linear in the number of entries.
+//
+// Each log carries a generation number and the snapshot records the newest
+// generation it subsumes, so a crash partway through compaction never counts a
+// launch twice. Torn records at the end of the log are detected by checksum
+// and discarded.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct LaunchStats
+{
+    uint32_t LaunchCount = 0;
+    uint64_t LastLaunchedTime = 0; // Seconds since the Unix epoch
+};
+
+class LaunchHistory
+{
+public:
+    ~LaunchHistory();
+
+    // The snapshot lives alongside the log at <logPath>.snapshot
+    bool Open(const std::string& logPath);
+    void Close();
+    bool IsOpen() const;
+
+    bool RecordLaunch(const std::string& alias, uint64_t timestamp);
+    const LaunchStats* FindStats(const std::string& alias) const;
+
+    // Flushes if the pending batch is full or old enough. Cheap to call every
+    // frame.
+    void Update(uint64_t nowTimestamp);
+
+    // Writes and fsyncs all pending records, compacting if due.
+    bool Flush();
+    bool Compact();
+
+    static uint64_t GetCurrentTimestamp();
+
+private:
+    bool LoadSnapshot(uint64_t* pGenerationOut);
+    bool ReplayLog(uint64_t snapshotGeneration);
+    bool StartNewLog(uint64_t generation);
+
+    // Appends the pending batch, fsyncing it if isSyncing. On failure
+    // whatever part of it landed is cut off again, so a retry starts from
+    // the end of the last whole batch.
+    bool WritePendingRecords(bool isSyncing);
+    void ApplyLaunch(const std::string& alias, uint64_t timestamp);
+
+    std::string m_logPath;
+    std::string m_snapshotPath;
+    int         m_logFd = -1;
+    uint64_t    m_logGeneration = 0;
+    uint32_t    m_numLogRecords = 0;
+
+    // Where the last whole batch ends, and whether anything may have been
+    // written past it
+    uint64_t    m_logSize = 0;
+    bool        m_hasPartialBatch = false;
+
+    std::vector<uint8_t> m_pendingBytes;
+    uint32_t             m_numPendingRecords = 0;
+    uint64_t             m_oldestPendingTimestamp = 0;
+
+    std::unordered_map<std::string, LaunchStats> m_statsByAlias;
+};
@@ -1,18 +1,45 @@
 #include "fivednineapp.h"
 #include "appconfig.h"
+#include "inputrecording.h"
 
 #include <fivednine/cli/cliargumentparser.h>
+#include <fivednine/input/inputmapping.h>
+#include <fivednine/input/inputthread.h>
 #include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
 #include <fivednine/render/window.h>
 #include <fivednine/render/color.h>
+#include <fivednine/render/framelimiter.h>
+#include <fivednine/render/gputimer.h>
+#include <fivednine/system/framescheduler.h>
 #include <fivednine/system/time.h>
 
+#include <algorithm>
+#include <climits>
+
 using namespace fivednine;
 using namespace fivednine::cli;
 using namespace fivednine::render;
 using namespace fivednine::system;
 
-constexpr uint32_t kTicksPerFrame = 1000 / 60; // 60 FPS
+namespace
+{
+    // One frame in flight keeps input latency to about a frame; the menu is
+    // nowhere near GPU bound, so there's no throughput to lose by it
+    static constexpr uint32_t kDefaultMaxFramesInFlight = 1;
+
+    double NsToMs(uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / time::kNanosecondsPerMillisecond;
+    }
+
+    int32_t StepsToTimeoutMs(uint64_t numSteps, uint64_t fixedTimestepNs)
+    {
+        const uint64_t TimeoutMs =
+            (numSteps * fixedTimestepNs + time::kNanosecondsPerMillisecond - 1) / time::kNanosecondsPerMillisecond;
+        return static_cast<int32_t>(std::min<uint64_t>(TimeoutMs, INT32_MAX));
+    }
+}
 
 int main(int argc, char** argv)
 {
@@ -21,6 +48,7 @@ int main(int argc, char** argv)
     log::EnableZone(LOG_DEFAULT);
     log::EnableZone(LOG_RENDER);
     log::EnableZone(LOG_API);
+    log::EnableZone(LOG_INPUT);
 
     cli::CommandLineArgumentParser argumentParser(argc, argv);
     const cli::CommandLineArgument* pConfigPathArgument = argumentParser.FindArgument("config");
@@ -31,6 +59,38 @@ int main(int argc, char** argv)
         return -1;
     }
 
+    // Profiling zones only record once a trace has been asked for
+    const cli::CommandLineArgument* pTracePathArgument = argumentParser.FindArgument("trace_path");
+    if (pTracePathArgument)
+    {
+        profile::SetEnabled(true);
+        profile::SetThreadName("main");
+    }
+
+    // Input is either recorded or replayed, see inputrecording.h
+    const cli::CommandLineArgument* pRecordInputArgument = argumentParser.FindArgument("record_input");
+    const cli::CommandLineArgument* pReplayInputArgument = argumentParser.FindArgument("replay_input");
+    if (pRecordInputArgument && pReplayInputArgument)
+    {
+        RELEASE_LOG_ERROR(LOG_DEFAULT, "--record_input and --replay_input are mutually exclusive");
+        return -1;
+    }
+
+    // "realtime" keeps the recorded timing; "fast" renders frames back to
+    // back and skips idle gaps
+    bool isReplayUnthrottled = false;
+    const cli::CommandLineArgument* pReplaySpeedArgument = argumentParser.FindArgument("replay_speed");
+    if (pReplaySpeedArgument)
+    {
+        const std::string ReplaySpeed = pReplaySpeedArgument->AsString();
+        if (ReplaySpeed != "realtime" && ReplaySpeed != "fast")
+        {
+            RELEASE_LOG_ERROR(LOG_DEFAULT, "--replay_speed expects realtime or fast");
+            return -1;
+        }
+        isReplayUnthrottled = ReplaySpeed == "fast";
+    }
+
     AppConfig appConfig;
     if (!appConfig.Parse(pConfigPathArgument->AsString()))
     {
@@ -38,7 +98,79 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    Window window("shotOS game selection carousel");
+    // Renders offscreen through EGL; useful on machines without a display
+    bool isHeadless = false;
+    const cli::CommandLineArgument* pHeadlessArgument = argumentParser.FindArgument("headless");
+    if (pHeadlessArgument && !pHeadlessArgument->AsBool(&isHeadless))
+    {
+        RELEASE_LOG_ERROR(LOG_DEFAULT, "--headless expects true or false");
+        return -1;
+    }
+
+    Window::VSyncMode vsyncMode = Window::VSyncMode::On;
+    const cli::CommandLineArgument* pVSyncArgument = argumentParser.FindArgument("vsync");
+    if (pVSyncArgument)
+    {
+        const std::string VSync = pVSyncArgument->AsString();
+        if (VSync == "on")
+        {
+            vsyncMode = Window::VSyncMode::On;
+        }
+        else if (VSync == "off")
+        {
+            vsyncMode = Window::VSyncMode::Off;
+        }
+        else if (VSync == "adaptive")
+        {
+            vsyncMode = Window::VSyncMode::Adaptive;
+        }
+        else
+        {
+            RELEASE_LOG_ERROR(LOG_DEFAULT, "--vsync expects on, off or adaptive");
+            return -1;
+        }
+    }
+
+    // Zero leaves frame queueing to the driver
+    uint32_t maxFramesInFlight = kDefaultMaxFramesInFlight;
+    const cli::CommandLineArgument* pMaxFramesInFlightArgument = argumentParser.FindArgument("max_frames_in_flight");
+    if (pMaxFramesInFlightArgument && !pMaxFramesInFlightArgument->AsUint32(&maxFramesInFlight))
+    {
+        RELEASE_LOG_ERROR(LOG_DEFAULT, "--max_frames_in_flight expects an unsigned integer");
+        return -1;
+    }
+
+    // "sdl" (the default) takes input from the window, so only while it has
+    // focus. Devices read directly on an input thread are read whatever has
+    // focus: "evdev" reads all of them, for a kiosk where nothing else takes
+    // input, and "auto" reads pads and encoder boards if any are readable
+    // but leaves keyboards to the window.
+    std::string inputSource = "sdl";
+    const cli::CommandLineArgument* pInputArgument = argumentParser.FindArgument("input");
+    if (pInputArgument)
+    {
+        inputSource = pInputArgument->AsString();
+        if (inputSource != "auto" && inputSource != "evdev" && inputSource != "sdl")
+        {
+            RELEASE_LOG_ERROR(LOG_DEFAULT, "--input expects auto, evdev or sdl");
+            return -1;
+        }
+    }
+
+    // Not fatal; the defaults cover keyboards, pads and common encoders
+    input::InputMapping inputMapping;
+    const std::string& InputMappingPath = appConfig.GetInputMappingPath();
+    if (!InputMappingPath.empty() && !inputMapping.LoadFromFile(InputMappingPath))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Using the default input mapping");
+    }
+
+    Window window(
+        "shotOS game selection carousel",
+        Window::kDefaultWindowWidth,
+        Window::kDefaultWindowHeight,
+        false /* fullScreen */,
+        isHeadless);
     fivednineApp app;
     if (!app.Initialize(appConfig, &window))
     {
@@ -46,35 +178,222 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    uint32_t lastFrameMs = time::GetTicksMs();
+    // Offscreen swaps never wait for a vblank, whatever the swap interval
+    const bool IsVSyncBlocking =
+        window.SetVSyncMode(vsyncMode) && vsyncMode != Window::VSyncMode::Off && !isHeadless;
+    window.SetInputMapping(&inputMapping);
+
+    // Paced only when nothing else is; pacing to our own clock on top of
+    // vsync beats against it and misses vblanks
+    const double RefreshHz = window.GetRefreshRateHz(FrameScheduler::kDefaultRefreshHz);
+    FrameScheduler frameScheduler;
+    frameScheduler.SetTargetRefreshRate(IsVSyncBlocking ? 0.0 : RefreshHz);
+
+    // Counts simulation steps since startup, including those skipped while
+    // blocked idle, so that recorded input keeps its timing
+    uint64_t simulationStep = 0;
+
+    InputRecorder inputRecorder;
+    if (pRecordInputArgument)
+    {
+        inputRecorder.Begin(&window, FrameScheduler::kDefaultSimulationHz);
+    }
+
+    InputReplayer inputReplayer;
+    if (pReplayInputArgument)
+    {
+        if (!inputReplayer.Load(pReplayInputArgument->AsString(), FrameScheduler::kDefaultSimulationHz))
+        {
+            return -1;
+        }
+        inputReplayer.Begin(&window);
+
+        if (isReplayUnthrottled)
+        {
+            // Each frame still simulates one nominal display interval
+            const uint32_t StepsPerFrame = std::max<uint32_t>(1, static_cast<uint32_t>(
+                FrameScheduler::kDefaultSimulationHz / RefreshHz + 0.5));
+            frameScheduler.SetFixedStepsPerFrame(StepsPerFrame);
+            window.SetVSyncMode(Window::VSyncMode::Off);
+        }
+    }
+
+    GpuTimer gpuTimer;
+    gpuTimer.Initialize();
+
+    FrameLimiter frameLimiter;
+    frameLimiter.Initialize(maxFramesInFlight);
+
+    // Nothing is read from devices when there's no one in front of the
+    // window, or when input is coming from a recording
+    input::InputThread inputThread;
+    const bool IsDeviceInputWanted = !isHeadless && !pReplayInputArgument;
+    if (inputSource != "sdl" && !IsDeviceInputWanted)
+    {
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Ignoring --input %s for a headless or replayed run", inputSource.c_str());
+    }
+    else if (inputSource == "evdev")
+    {
+        if (!inputThread.Start(&inputMapping, &window, true /* areKeyboardsIncluded */))
+        {
+            RELEASE_LOG_ERROR(LOG_DEFAULT, "No input devices could be read; check /dev/input permissions");
+            return -1;
+        }
+        window.SetSdlInputEnabled(false);
+    }
+    else if (inputSource == "auto")
+    {
+        if (inputThread.Start(&inputMapping, &window, false /* areKeyboardsIncluded */))
+        {
+            window.SetSdlGamepadInputEnabled(false);
+        }
+    }
+
+    FrameTimings& frameTimings = app.GetFrameTimings();
+    uint64_t lastFrameStartNs = 0;
+
     bool looping = true;
     while (looping)
     {
-        Window::EventType eventType = window.PollEvents();
-        while (eventType != Window::EventType::None)
+        const uint64_t FrameStartNs = time::GetTicksNs();
+        if (lastFrameStartNs != 0)
+        {
+            frameTimings.AddSample(FrameTimingSeries::Frame, NsToMs(FrameStartNs - lastFrameStartNs));
+        }
+        lastFrameStartNs = FrameStartNs;
+
+        if (pRecordInputArgument)
         {
-            if (eventType == Window::EventType::Quit)
+            inputRecorder.SetSimulationStep(simulationStep);
+        }
+
+        Window::WindowEvent windowEvents[Window::kEventBatchSize];
+        size_t numWindowEvents;
+        do
+        {
+            numWindowEvents = window.PollEvents(windowEvents, Window::kEventBatchSize);
+            for (size_t i = 0; i < numWindowEvents; ++i)
             {
-                looping = false;
-                break;
+                if (windowEvents[i].Type == Window::EventType::Quit)
+                {
+                    looping = false;
+                }
             }
+        } while (numWindowEvents == Window::kEventBatchSize);
 
-            eventType = window.PollEvents();
+        // Through the window's handler, so recording and replay see these
+        // exactly like input from SDL
+        input::InputEvent inputEvent;
+        while (inputThread.PopEvent(&inputEvent))
+        {
+            window.InjectInputEvent(inputEvent);
         }
 
-        const uint32_t nowMs = time::GetTicksMs();
-        const uint32_t dtTicks = nowMs - lastFrameMs;
-        const float dtSeconds = nowMs / 1000.f;
-        app.Tick(dtSeconds);
-        lastFrameMs = nowMs;
-
-        if (dtTicks < kTicksPerFrame)
+        const uint32_t NumSteps = frameScheduler.BeginFrame();
+        for (uint32_t i = 0; i < NumSteps; ++i)
         {
-            time::SleepMs(kTicksPerFrame - dtTicks);
+            if (pReplayInputArgument)
+            {
+                inputReplayer.DeliverEvents(simulationStep);
+            }
+
+            app.Tick(frameScheduler.GetFixedTimestepSeconds());
+            ++simulationStep;
         }
+        const uint64_t TickEndNs = time::GetTicksNs();
 
+        gpuTimer.Begin();
         window.Clear(ColorRGB::BLACK);
-        app.Draw();
+        // Latched as late as possible, so the camera is drawn where it will
+        // be closest to when the frame is shown
+        app.Draw(frameScheduler.GetLatchedInterpolationAlpha());
+        gpuTimer.End();
+        const uint64_t DrawEndNs = time::GetTicksNs();
+
         window.Update();
+        const uint64_t SwapEndNs = time::GetTicksNs();
+
+        // Blocks here rather than at the start of the next frame, so that
+        // the next frame's input is sampled after the wait, not before it
+        const uint64_t ThrottleNs = frameLimiter.OnFramePresented();
+        app.OnFramePresented(SwapEndNs);
+
+        frameTimings.AddSample(FrameTimingSeries::Tick, NsToMs(TickEndNs - FrameStartNs));
+        frameTimings.AddSample(FrameTimingSeries::Draw, NsToMs(DrawEndNs - TickEndNs));
+        frameTimings.AddSample(FrameTimingSeries::Swap, NsToMs(SwapEndNs - DrawEndNs));
+        frameTimings.AddSample(FrameTimingSeries::Throttle, NsToMs(ThrottleNs));
+
+        uint64_t gpuElapsedNs;
+        while (gpuTimer.PopResult(&gpuElapsedNs))
+        {
+            frameTimings.AddSample(FrameTimingSeries::Gpu, NsToMs(gpuElapsedNs));
+        }
+
+        frameScheduler.EndFrame();
+
+        // Nothing on screen will change until something happens, so sleep
+        // until it does rather than re-rendering the same frame.
+        if (looping && app.IsIdle())
+        {
+            if (pReplayInputArgument && inputReplayer.IsFinished())
+            {
+                // Replay complete and everything has settled
+                break;
+            }
+
+            app.PrepareForIdle();
+            const uint64_t IdleStartNs = time::GetTicksNs();
+            if (!pReplayInputArgument)
+            {
+                window.WaitForEvents();
+                simulationStep += (time::GetTicksNs() - IdleStartNs) / frameScheduler.GetFixedTimestepNs();
+            }
+            else
+            {
+                // Skip ahead to the next recorded event, waiting it out
+                // first unless replaying as fast as possible
+                const uint64_t NextEventStep = inputReplayer.GetNextEventStep();
+                uint64_t skippedSteps = NextEventStep > simulationStep ? NextEventStep - simulationStep : 0;
+                if (!isReplayUnthrottled && skippedSteps > 0)
+                {
+                    window.WaitForEvents(StepsToTimeoutMs(skippedSteps, frameScheduler.GetFixedTimestepNs()));
+                    skippedSteps = std::min(
+                        skippedSteps,
+                        (time::GetTicksNs() - IdleStartNs) / frameScheduler.GetFixedTimestepNs());
+                }
+                simulationStep += skippedSteps;
+            }
+            frameScheduler.Reset();
+
+            // The wait isn't part of any frame
+            lastFrameStartNs = 0;
+        }
+    }
+
+    inputThread.Stop();
+    if (inputThread.GetNumDroppedEvents() > 0)
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_INPUT,
+            "Input queue overflowed, dropped %llu events",
+            static_cast<unsigned long long>(inputThread.GetNumDroppedEvents()));
+    }
+
+    if (pRecordInputArgument)
+    {
+        inputRecorder.WriteToFile(pRecordInputArgument->AsString());
+    }
+
+    frameTimings.LogSummary();
+
+    const cli::CommandLineArgument* pFrameStatsPathArgument = argumentParser.FindArgument("frame_stats_path");
+    if (pFrameStatsPathArgument)
+    {
+        frameTimings.WriteToFile(pFrameStatsPathArgument->AsString());
+    }
+
+    if (pTracePathArgument)
+    {
+        profile::ExportChromeTrace(pTracePathArgument->AsString());
     }
 }
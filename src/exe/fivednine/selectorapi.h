@@ -0,0 +1,187 @@
+/* selectorapi.h
+ *
+ * The C ABI between the app and selectors, so that a selector can be built
+ * as a shared object in any language and swapped in while the app runs.
+ * Both directions are tables of plain function pointers: the app fills in
+ * an FdnHostApi for the selector to call, and the selector hands back an
+ * FdnSelectorApi from its entry point. Nothing is marshalled; arguments are
+ * scalars and pointers to caller-owned memory, valid for the call unless
+ * stated otherwise.
+ *
+ * Card indices are positions in the active library view, as in
+ * fivednineApp's Selector_* calls, which these forward to. Functions
+ * returning int return nonzero on success.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change. Compatible additions go at the end of
+ * a table, and the table's Size says how much of it the other side knows
+ * about. */
+#define FDN_SELECTOR_API_VERSION 2
+
+/* const FdnSelectorApi* fivednine_GetSelectorApi(uint32_t hostApiVersion)
+ * Returns null if the selector can't work with that version. */
+#define FDN_SELECTOR_ENTRY_POINT "fivednine_GetSelectorApi"
+
+#if defined(__GNUC__)
+#define FDN_SELECTOR_EXPORT __attribute__((visibility("default")))
+#else
+#define FDN_SELECTOR_EXPORT
+#endif
+
+typedef uint32_t FdnTextureHandle;
+#define FDN_INVALID_TEXTURE_HANDLE 0u
+
+/* Values match SelectorInputEventType */
+enum
+{
+    FDN_SELECTOR_INPUT_NONE = 0,
+    FDN_SELECTOR_INPUT_NEXT_SELECTION,
+    FDN_SELECTOR_INPUT_PREVIOUS_SELECTION,
+    FDN_SELECTOR_INPUT_NEXT_PAGE,
+    FDN_SELECTOR_INPUT_PREVIOUS_PAGE,
+    FDN_SELECTOR_INPUT_SEARCH,
+    FDN_SELECTOR_INPUT_CONFIRM_CURRENT,
+    FDN_SELECTOR_INPUT_NEXT_LIBRARY_VIEW
+};
+
+typedef struct FdnSelectorInputEvent
+{
+    uint32_t InputEventType;
+    /* Coalesced repeats; move by this many steps */
+    uint32_t Count;
+    /* Pass to AcknowledgeInput once handled */
+    uint64_t TimestampNs;
+} FdnSelectorInputEvent;
+
+/* GPU-driven layouts: each card's transform is computed on the GPU from its
+ * position in the view, so scrolling or re-laying out costs the same for
+ * any number of cards. Values match CardLayoutKind. */
+enum
+{
+    FDN_CARD_LAYOUT_PER_CARD = 0, /* Positions and dimensions set per card */
+    FDN_CARD_LAYOUT_ROW,          /* Left to right, scrolled by cards */
+    FDN_CARD_LAYOUT_GRID,         /* NumColumns across, scrolled by rows */
+    FDN_CARD_LAYOUT_WHEEL         /* Around a wheel's rim, scrolled by cards */
+};
+
+typedef struct FdnCardLayout
+{
+    uint32_t Kind;
+    float    CardWidth;
+    float    CardHeight;
+    /* Between neighbouring cards' edges */
+    float    SpacingX;
+    float    SpacingY;
+    /* Grid only */
+    uint32_t NumColumns;
+    /* Wheel only: cards are WheelAngleStep radians apart on a wheel of
+     * WheelRadius, whose top is where the scrolled-to card sits */
+    float    WheelRadius;
+    float    WheelAngleStep;
+} FdnCardLayout;
+
+/* Strings belong to the app and stay valid until the library changes */
+typedef struct FdnCardInfo
+{
+    const char* pTitle;
+    const char* pTexturePrefix;
+    /* The card's cover, or FDN_INVALID_TEXTURE_HANDLE if it has none. Added
+     * in version 2; the struct is caller-allocated, hence the bump. */
+    FdnTextureHandle CardTextureHandle;
+} FdnCardInfo;
+
+typedef struct FdnHostApi
+{
+    uint32_t Version;
+    uint32_t Size;
+    void*    pHost;
+
+    uint32_t (*GetNumCards)(void* pHost);
+    void     (*SelectIndex)(void* pHost, uint32_t index);
+    uint32_t (*GetSelectedIndex)(void* pHost);
+    void     (*ConfirmCurrentSelection)(void* pHost);
+    void     (*AcknowledgeInput)(void* pHost, uint64_t inputTimestampNs);
+
+    /* Views are numbered 0 to GetNumLibraryViews() - 1 */
+    uint32_t (*GetNumLibraryViews)(void* pHost);
+    uint32_t (*GetLibraryView)(void* pHost);
+    int      (*SetLibraryView)(void* pHost, uint32_t view);
+
+    void     (*GetDisplayDimensions)(void* pHost, uint32_t* pWidthOut, uint32_t* pHeightOut);
+    int      (*GetCardInfo)(void* pHost, uint32_t index, FdnCardInfo* pCardInfoOut);
+    int      (*GetCardPosition)(void* pHost, uint32_t index, float* pPositionOut /* x, y, z */);
+
+    /* The value is read at draw time, so must outlive its use. Memory in a
+     * plugin goes away when it's reloaded, so Initialize should set every
+     * parameter the selector uses. */
+    int      (*SetCardAppearanceParam1f)(void* pHost, uint32_t index, const char* pParameterName, float* pValue);
+
+    /* See fivednineApp::Selector_SetCardRange* for the stride rules */
+    int      (*SetCardRangePositions)(void* pHost, uint32_t firstIndex, uint32_t numCards, const float* pPositions, size_t strideBytes);
+    int      (*SetCardRangeDimensions)(void* pHost, uint32_t firstIndex, uint32_t numCards, const float* pDimensions, size_t strideBytes);
+    int      (*SetCardRangeAppearanceParam1f)(
+                 void* pHost,
+                 uint32_t firstIndex,
+                 uint32_t numCards,
+                 const char* pParameterName,
+                 float* pValues,
+                 size_t strideBytes);
+    int      (*SetCardRangeTextures)(
+                 void* pHost,
+                 uint32_t firstIndex,
+                 uint32_t numCards,
+                 const FdnTextureHandle* pTextureHandles,
+                 size_t strideBytes);
+    FdnTextureHandle (*FindTextureHandle)(void* pHost, const char* pTextureName);
+
+    void     (*SetCameraPosition)(void* pHost, float x, float y, float z);
+    void     (*SetCameraTarget)(void* pHost, float x, float y, float z);
+
+    /* Replaces per-card positions and dimensions until a layout of
+     * FDN_CARD_LAYOUT_PER_CARD is set. The card (or grid row) at the scroll
+     * offset is centred on the origin; SetCardLayoutScrollTarget eases there
+     * as the camera would. GetCardPosition reports where the layout puts a
+     * card once scrolling settles. */
+    int      (*SetCardLayout)(void* pHost, const FdnCardLayout* pLayout);
+    void     (*SetCardLayoutScroll)(void* pHost, float scrollOffset);
+    void     (*SetCardLayoutScrollTarget)(void* pHost, float scrollOffset);
+} FdnHostApi;
+
+typedef struct FdnSelectorApi
+{
+    uint32_t    Version;
+    uint32_t    Size;
+    const char* pName;
+
+    /* pHostApi outlives the selector. Returns null on failure. */
+    void*  (*Create)(const FdnHostApi* pHostApi);
+    void   (*Destroy)(void* pSelector);
+
+    /* Lays out the cards. pState is null on first load; on a reload it's
+     * what the previous instance saved, which may have come from an older
+     * build of the selector and should be validated. */
+    int    (*Initialize)(void* pSelector, const void* pState, size_t stateSize);
+
+    void   (*Tick)(void* pSelector, float dtSeconds);
+    void   (*HandleInputEvent)(void* pSelector, const FdnSelectorInputEvent* pEvent);
+    void   (*HandleDisplayResized)(void* pSelector, uint32_t width, uint32_t height);
+
+    /* Writes the state to carry over a reload if it fits in stateCapacity,
+     * and returns its size either way */
+    size_t (*SaveState)(void* pSelector, void* pStateOut, size_t stateCapacity);
+} FdnSelectorApi;
+
+typedef const FdnSelectorApi* (*FnFdnGetSelectorApi)(uint32_t hostApiVersion);
+
+#ifdef __cplusplus
+}
+#endif
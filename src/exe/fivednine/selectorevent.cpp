@@ -0,0 +1,28 @@
+#include "selectorevent.h"
+
+bool SelectorInputEvent::Coalesce(const SelectorInputEvent& nextEvent)
+{
+    if (nextEvent.InputEventType != InputEventType)
+    {
+        return false;
+    }
+
+    switch (InputEventType)
+    {
+        case SelectorInputEventType::NextSelection:
+        case SelectorInputEventType::PreviousSelection:
+        case SelectorInputEventType::NextPage:
+        case SelectorInputEventType::PreviousPage:
+        case SelectorInputEventType::Search:
+            break;
+        default:
+            return false;
+    }
+
+    Count += nextEvent.Count;
+    if (TimestampNs == 0)
+    {
+        TimestampNs = nextEvent.TimestampNs;
+    }
+    return true;
+}
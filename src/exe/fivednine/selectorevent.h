@@ -1,44 +1,43 @@
 #pragma once
 
+#include <cstdint>
+
 // Input events
 enum class SelectorInputEventType
 {
     None = 0,
     NextSelection,
     PreviousSelection,
+    NextPage,
+    PreviousPage,
+    Search,
     ConfirmCurrent,
+    NextLibraryView,
     Max
 };
 
-struct SelectorInputEventPayload
+struct SelectorInputEvent
 {
     SelectorInputEventType InputEventType;
-};
 
-// General selector event
-enum class SelectorEventType
-{
-    None = 0,
-    Input,
-    Max
-};
+    // When the input was received, for input-to-present latency. Zero for
+    // input the app generated itself, such as hold-to-repeat.
+    uint64_t TimestampNs;
 
-struct SelectorEvent
-{
-    SelectorEventType EventType;
-    union 
-    {
-        SelectorInputEventPayload InputEventPayload;
-    } EventPayload;
+    // How many times in a row the input happened. Navigation that arrives
+    // faster than the selector ticks is coalesced into a single event, so
+    // selectors should move by this many steps rather than one.
+    uint32_t Count;
 
-    SelectorEvent& operator=(const SelectorEvent& other)
-    {
-        EventType = other.EventType;
-        if (EventType == SelectorEventType::Input)
-        {
-            EventPayload.InputEventPayload = other.EventPayload.InputEventPayload;
-        }
+    // Absorbs a following event of the same navigation type, summing the
+    // counts and keeping the earliest input timestamp. Confirming or
+    // changing views twice isn't the same as once, so those never merge.
+    bool Coalesce(const SelectorInputEvent& nextEvent);
+};
 
-        return *this;
-    }
-};
\ No newline at end of file
+// The display changed size
+struct DisplayResizedEvent
+{
+    uint32_t Width;
+    uint32_t Height;
+};
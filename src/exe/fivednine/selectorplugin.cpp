@@ -0,0 +1,432 @@
+#include "selectorplugin.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <fivednine/log/check.h>
+#include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/render/window.h>
+#include <fivednine/system/time.h>
+
+using namespace fivednine;
+
+namespace
+{
+    // dlopen() hands back the library it already has for a path it's seen,
+    // so each load is from a copy of its own. The copy is unlinked once
+    // loaded; the mapping keeps it alive until dlclose().
+    bool CopyToTempFile(const std::string& path, std::string* pTempPathOut)
+    {
+        std::error_code errorCode;
+        const std::filesystem::path TempDirectory = std::filesystem::temp_directory_path(errorCode);
+        if (errorCode)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "No temp directory to load selector from: %s", errorCode.message().c_str());
+            return false;
+        }
+
+        std::string tempPath = (TempDirectory / "fivednine-selector-XXXXXX.so").string();
+        const int TempFd = mkstemps(tempPath.data(), 3 /* suffixlen */);
+        if (TempFd < 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create %s: %s", tempPath.c_str(), strerror(errno));
+            return false;
+        }
+        close(TempFd);
+
+        if (!std::filesystem::copy_file(path, tempPath, std::filesystem::copy_options::overwrite_existing, errorCode))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to copy %s: %s", path.c_str(), errorCode.message().c_str());
+            std::filesystem::remove(tempPath, errorCode);
+            return false;
+        }
+
+        *pTempPathOut = tempPath;
+        return true;
+    }
+}
+
+SelectorPlugin::~SelectorPlugin()
+{
+    Unload();
+}
+
+void SelectorPlugin::SetHostResetHandler(FnResetHost pfnResetHost, void* pUserPointer)
+{
+    m_pfnResetHost = pfnResetHost;
+    m_pResetHostUserPointer = pUserPointer;
+}
+
+bool SelectorPlugin::LoadBuiltIn(const FdnSelectorApi* pSelectorApi, const FdnHostApi* pHostApi)
+{
+    RELEASE_CHECK(pSelectorApi != nullptr, "pSelectorApi cannot be null");
+    RELEASE_CHECK(pHostApi != nullptr, "pHostApi cannot be null");
+    Unload();
+
+    m_pHostApi = pHostApi;
+    LoadedSelector loadedSelector;
+    loadedSelector.pSelectorApi = pSelectorApi;
+    if (!CreateSelector(&loadedSelector, nullptr /* pState */, 0 /* stateSize */))
+    {
+        return false;
+    }
+
+    m_loadedSelector = loadedSelector;
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Using built-in selector %s", GetName());
+    return true;
+}
+
+bool
+SelectorPlugin::Load(
+    const std::string& path,
+    const FdnHostApi* pHostApi,
+    const render::Window* pWindowToWake)
+{
+    RELEASE_CHECK(pHostApi != nullptr, "pHostApi cannot be null");
+    Unload();
+
+    m_pHostApi = pHostApi;
+    LoadedSelector loadedSelector;
+    if (!OpenLibrary(path, &loadedSelector))
+    {
+        return false;
+    }
+
+    if (!CreateSelector(&loadedSelector, nullptr /* pState */, 0 /* stateSize */))
+    {
+        DestroySelector(&loadedSelector);
+        return false;
+    }
+
+    m_loadedSelector = loadedSelector;
+    m_path = path;
+    m_pWindowToWake = pWindowToWake;
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Loaded selector %s from %s", GetName(), path.c_str());
+
+    // Still usable without, just not reloadable
+    if (!StartWatching())
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Can't watch %s, selector won't be reloaded on changes", path.c_str());
+    }
+    return true;
+}
+
+void SelectorPlugin::Unload()
+{
+    StopWatching();
+    DestroySelector(&m_loadedSelector);
+    m_path.clear();
+    m_hasFileChanged.store(false, std::memory_order_relaxed);
+    m_reloadStartNs = 0;
+}
+
+bool SelectorPlugin::IsLoaded() const
+{
+    return m_loadedSelector.pSelector != nullptr;
+}
+
+const char* SelectorPlugin::GetName() const
+{
+    return IsLoaded() ? m_loadedSelector.pSelectorApi->pName : "(none)";
+}
+
+bool SelectorPlugin::ReloadIfChanged()
+{
+    if (!m_hasFileChanged.exchange(false, std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    PROFILE_SCOPE("SelectorPlugin::ReloadIfChanged");
+    m_reloadStartNs = system::time::GetTicksNs();
+
+    LoadedSelector newSelector;
+    if (!OpenLibrary(m_path, &newSelector))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Keeping selector %s", GetName());
+        m_reloadStartNs = 0;
+        return false;
+    }
+
+    // Saved at the last moment, so nothing handled since is lost
+    const FdnSelectorApi* pOldSelectorApi = m_loadedSelector.pSelectorApi;
+    std::vector<uint8_t> state(pOldSelectorApi->SaveState(m_loadedSelector.pSelector, nullptr, 0));
+    if (!state.empty())
+    {
+        pOldSelectorApi->SaveState(m_loadedSelector.pSelector, state.data(), state.size());
+    }
+
+    if (!CreateSelector(&newSelector, state.empty() ? nullptr : state.data(), state.size()))
+    {
+        // The new build may have handed the host pointers into its library
+        // before failing, so the old selector sets everything up again
+        // before that library goes
+        ResetHost();
+        if (!pOldSelectorApi->Initialize(m_loadedSelector.pSelector, state.empty() ? nullptr : state.data(), state.size()))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to reinitialize selector %s", GetName());
+        }
+
+        DestroySelector(&newSelector);
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Keeping selector %s", GetName());
+        m_reloadStartNs = 0;
+        return false;
+    }
+
+    DestroySelector(&m_loadedSelector);
+    m_loadedSelector = newSelector;
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Reloaded selector %s from %s", GetName(), m_path.c_str());
+    return true;
+}
+
+bool SelectorPlugin::IsReloadPending() const
+{
+    return m_reloadStartNs != 0 || m_hasFileChanged.load(std::memory_order_relaxed);
+}
+
+void SelectorPlugin::Tick(float dtSeconds)
+{
+    m_loadedSelector.pSelectorApi->Tick(m_loadedSelector.pSelector, dtSeconds);
+}
+
+void SelectorPlugin::HandleInputEvent(const FdnSelectorInputEvent& inputEvent)
+{
+    m_loadedSelector.pSelectorApi->HandleInputEvent(m_loadedSelector.pSelector, &inputEvent);
+}
+
+void SelectorPlugin::HandleDisplayResized(uint32_t width, uint32_t height)
+{
+    m_loadedSelector.pSelectorApi->HandleDisplayResized(m_loadedSelector.pSelector, width, height);
+}
+
+void SelectorPlugin::OnFramePresented(uint64_t presentTimestampNs)
+{
+    if (m_reloadStartNs == 0)
+    {
+        return;
+    }
+
+    const double ReloadMs =
+        static_cast<double>(presentTimestampNs - m_reloadStartNs) / system::time::kNanosecondsPerMillisecond;
+    m_reloadStartNs = 0;
+    if (ReloadMs > kReloadBudgetMs)
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Selector reload took %.2f ms to first frame, over the %.0f ms budget",
+            ReloadMs,
+            kReloadBudgetMs);
+    }
+    else
+    {
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Selector reload took %.2f ms to first frame", ReloadMs);
+    }
+}
+
+bool SelectorPlugin::OpenLibrary(const std::string& path, LoadedSelector* pLoadedSelectorOut) const
+{
+    std::string tempPath;
+    if (!CopyToTempFile(path, &tempPath))
+    {
+        return false;
+    }
+
+    // Local, so that a rebuild's symbols never resolve to the previous one's
+    void* pLibrary = dlopen(tempPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    std::error_code errorCode;
+    std::filesystem::remove(tempPath, errorCode);
+    if (!pLibrary)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to load selector %s: %s", path.c_str(), dlerror());
+        return false;
+    }
+
+    const FnFdnGetSelectorApi pfnGetSelectorApi =
+        reinterpret_cast<FnFdnGetSelectorApi>(dlsym(pLibrary, FDN_SELECTOR_ENTRY_POINT));
+    if (!pfnGetSelectorApi)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Selector %s doesn't export %s", path.c_str(), FDN_SELECTOR_ENTRY_POINT);
+        dlclose(pLibrary);
+        return false;
+    }
+
+    const FdnSelectorApi* pSelectorApi = pfnGetSelectorApi(FDN_SELECTOR_API_VERSION);
+    if (!pSelectorApi ||
+        pSelectorApi->Version != FDN_SELECTOR_API_VERSION ||
+        pSelectorApi->Size < sizeof(FdnSelectorApi))
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Selector %s doesn't support API version %u",
+            path.c_str(),
+            FDN_SELECTOR_API_VERSION);
+        dlclose(pLibrary);
+        return false;
+    }
+
+    pLoadedSelectorOut->pLibrary = pLibrary;
+    pLoadedSelectorOut->pSelectorApi = pSelectorApi;
+    pLoadedSelectorOut->pSelector = nullptr;
+    return true;
+}
+
+bool SelectorPlugin::CreateSelector(LoadedSelector* pLoadedSelector, const void* pState, size_t stateSize) const
+{
+    const FdnSelectorApi* pSelectorApi = pLoadedSelector->pSelectorApi;
+    pLoadedSelector->pSelector = pSelectorApi->Create(m_pHostApi);
+    if (!pLoadedSelector->pSelector)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create selector %s", pSelectorApi->pName);
+        return false;
+    }
+
+    ResetHost();
+    if (!pSelectorApi->Initialize(pLoadedSelector->pSelector, pState, stateSize))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to initialize selector %s", pSelectorApi->pName);
+        pSelectorApi->Destroy(pLoadedSelector->pSelector);
+        pLoadedSelector->pSelector = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+void SelectorPlugin::ResetHost() const
+{
+    if (m_pfnResetHost)
+    {
+        m_pfnResetHost(m_pResetHostUserPointer);
+    }
+}
+
+void SelectorPlugin::DestroySelector(LoadedSelector* pLoadedSelector)
+{
+    if (pLoadedSelector->pSelector)
+    {
+        pLoadedSelector->pSelectorApi->Destroy(pLoadedSelector->pSelector);
+    }
+
+    if (pLoadedSelector->pLibrary)
+    {
+        dlclose(pLoadedSelector->pLibrary);
+    }
+
+    *pLoadedSelector = LoadedSelector();
+}
+
+bool SelectorPlugin::StartWatching()
+{
+    // The directory rather than the file, since builds often replace the
+    // file instead of rewriting it
+    const std::filesystem::path DirectoryPath = std::filesystem::path(m_path).parent_path();
+    m_fileWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fileWatchFd < 0)
+    {
+        return false;
+    }
+
+    const char* pDirectoryPath = DirectoryPath.empty() ? "." : DirectoryPath.c_str();
+    if (inotify_add_watch(m_fileWatchFd, pDirectoryPath, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(m_fileWatchFd);
+        m_fileWatchFd = -1;
+        return false;
+    }
+
+    m_stopEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stopEventFd < 0)
+    {
+        close(m_fileWatchFd);
+        m_fileWatchFd = -1;
+        return false;
+    }
+
+    m_watcherThread = std::thread(&SelectorPlugin::RunWatcher, this);
+    return true;
+}
+
+void SelectorPlugin::StopWatching()
+{
+    if (!m_watcherThread.joinable())
+    {
+        return;
+    }
+
+    const uint64_t StopValue = 1;
+    if (write(m_stopEventFd, &StopValue, sizeof(StopValue)) < 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to signal selector watcher: %s", strerror(errno));
+    }
+    m_watcherThread.join();
+
+    close(m_stopEventFd);
+    m_stopEventFd = -1;
+    close(m_fileWatchFd);
+    m_fileWatchFd = -1;
+}
+
+void SelectorPlugin::RunWatcher()
+{
+    profile::SetThreadName("selectorwatch");
+
+    const std::string FileName = std::filesystem::path(m_path).filename().string();
+    while (true)
+    {
+        struct pollfd pollFds[2] = {
+            { m_stopEventFd, POLLIN, 0 },
+            { m_fileWatchFd, POLLIN, 0 }
+        };
+        if (poll(pollFds, 2, -1 /* timeout */) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Selector watcher poll failed: %s", strerror(errno));
+            return;
+        }
+
+        if (pollFds[0].revents != 0)
+        {
+            return;
+        }
+
+        alignas(struct inotify_event) char buffer[4096];
+        bool hasFileChanged = false;
+        ssize_t numBytesRead;
+        while ((numBytesRead = read(m_fileWatchFd, buffer, sizeof(buffer))) > 0)
+        {
+            for (ssize_t offset = 0; offset < numBytesRead;)
+            {
+                const struct inotify_event* pEvent = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                offset += sizeof(struct inotify_event) + pEvent->len;
+                if (pEvent->len > 0 && FileName == pEvent->name)
+                {
+                    hasFileChanged = true;
+                }
+            }
+        }
+
+        // The main loop may be blocked waiting for input
+        if (hasFileChanged)
+        {
+            m_hasFileChanged.store(true, std::memory_order_release);
+            if (m_pWindowToWake)
+            {
+                m_pWindowToWake->PostWakeEvent();
+            }
+        }
+    }
+}
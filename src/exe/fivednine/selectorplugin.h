@@ -0,0 +1,107 @@
+// selectorplugin.h
+//
+// Owns the active selector and whatever it was loaded from: either a
+// function table built into the app, or a shared object exporting
+// FDN_SELECTOR_ENTRY_POINT (see selectorapi.h). Calls into the selector are
+// plain indirect calls through its table.
+//
+// A selector loaded from a file is watched, and when the file is rewritten
+// the new build is swapped in on the main thread. The old instance's state
+// is saved and handed to the new one, so the selection and view carry over.
+// If the new build fails to load or initialize, the old one stays and is
+// initialized again from its saved state, since the new build may already
+// have handed the host pointers into its own library.
+
+#pragma once
+
+#include "selectorapi.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace fivednine { namespace render {
+    class Window;
+}}
+
+class SelectorPlugin
+{
+public:
+    // Swapping in a rebuild should cost no more than a few frames
+    static constexpr double kReloadBudgetMs = 50.0;
+
+    // Drops whatever the host holds from earlier selectors, e.g. appearance
+    // values pointing into a library that's about to be unloaded
+    typedef void (*FnResetHost)(void* pUserPointer);
+
+    ~SelectorPlugin();
+
+    // Called before any selector is initialized, including the old one
+    // being set up again after a failed reload
+    void SetHostResetHandler(FnResetHost pfnResetHost, void* pUserPointer);
+
+    // pHostApi must outlive the selector
+    bool LoadBuiltIn(const FdnSelectorApi* pSelectorApi, const FdnHostApi* pHostApi);
+
+    // Loads a selector from a shared object and starts watching it for
+    // changes. pWindowToWake may be null.
+    bool
+    Load(
+        const std::string& path,
+        const FdnHostApi* pHostApi,
+        const fivednine::render::Window* pWindowToWake);
+
+    void Unload();
+
+    bool IsLoaded() const;
+    const char* GetName() const;
+
+    // Main thread. Swaps in a rebuild if the file has changed since the last
+    // call; returns true if one was swapped in.
+    bool ReloadIfChanged();
+
+    // True from a change being seen until the first frame after the reload
+    // is presented
+    bool IsReloadPending() const;
+
+    void Tick(float dtSeconds);
+    void HandleInputEvent(const FdnSelectorInputEvent& inputEvent);
+    void HandleDisplayResized(uint32_t width, uint32_t height);
+
+    // Reports how long the last reload took to reach the screen
+    void OnFramePresented(uint64_t presentTimestampNs);
+
+private:
+    struct LoadedSelector
+    {
+        void*                 pLibrary = nullptr;
+        const FdnSelectorApi* pSelectorApi = nullptr;
+        void*                 pSelector = nullptr;
+    };
+
+    bool OpenLibrary(const std::string& path, LoadedSelector* pLoadedSelectorOut) const;
+    bool CreateSelector(LoadedSelector* pLoadedSelector, const void* pState, size_t stateSize) const;
+    static void DestroySelector(LoadedSelector* pLoadedSelector);
+    void ResetHost() const;
+
+    bool StartWatching();
+    void StopWatching();
+    void RunWatcher();
+
+    LoadedSelector    m_loadedSelector;
+    const FdnHostApi* m_pHostApi = nullptr;
+    std::string       m_path;
+
+    FnResetHost m_pfnResetHost = nullptr;
+    void*       m_pResetHostUserPointer = nullptr;
+
+    const fivednine::render::Window* m_pWindowToWake = nullptr;
+    std::thread       m_watcherThread;
+    int               m_stopEventFd = -1;
+    int               m_fileWatchFd = -1;
+    std::atomic<bool> m_hasFileChanged{false};
+
+    // Nonzero from a change being picked up until the next present
+    uint64_t m_reloadStartNs = 0;
+};
@@ -0,0 +1,212 @@
+#include "syntheticlibrary.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <png.h>
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+
+namespace
+{
+    static constexpr uint32_t kCoverChannels = 3;
+
+    // Spreads consecutive games around the color wheel so neighbouring cards
+    // are easy to tell apart
+    void GetCoverColor(uint32_t gameIndex, uint8_t* pRgbOut)
+    {
+        static constexpr double kGoldenRatioConjugate = 0.618033988749895;
+        double hue = gameIndex * kGoldenRatioConjugate;
+        hue = (hue - static_cast<uint64_t>(hue)) * 6.0;
+
+        const uint32_t Sector = static_cast<uint32_t>(hue) % 6;
+        const double Fraction = hue - static_cast<uint32_t>(hue);
+        const uint8_t Rising = static_cast<uint8_t>(64 + 160 * Fraction);
+        const uint8_t Falling = static_cast<uint8_t>(224 - 160 * Fraction);
+        const uint8_t High = 224;
+        const uint8_t Low = 64;
+
+        const uint8_t Colors[6][3] = {
+            { High, Rising, Low },
+            { Falling, High, Low },
+            { Low, High, Rising },
+            { Low, Falling, High },
+            { Rising, Low, High },
+            { High, Low, Falling },
+        };
+        pRgbOut[0] = Colors[Sector][0];
+        pRgbOut[1] = Colors[Sector][1];
+        pRgbOut[2] = Colors[Sector][2];
+    }
+
+    // Solid color with a light horizontal band whose position depends on the
+    // index, so covers differ in more than color
+    void FillCover(uint32_t gameIndex, uint32_t width, uint32_t height, std::vector<uint8_t>* pPixelsOut)
+    {
+        uint8_t rgb[kCoverChannels];
+        GetCoverColor(gameIndex, rgb);
+
+        const uint32_t BandHeight = std::max<uint32_t>(height / 8, 1);
+        const uint32_t BandTop = static_cast<uint32_t>((static_cast<uint64_t>(gameIndex) * 7919) % height);
+
+        pPixelsOut->resize(static_cast<size_t>(width) * height * kCoverChannels);
+        uint8_t* pPixel = pPixelsOut->data();
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const bool InBand = y >= BandTop && y < BandTop + BandHeight;
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < kCoverChannels; ++c)
+                {
+                    *pPixel++ = InBand ? static_cast<uint8_t>(255 - (255 - rgb[c]) / 4) : rgb[c];
+                }
+            }
+        }
+    }
+}
+
+std::string GetSyntheticTexturePrefix(uint32_t gameIndex)
+{
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "synthetic_%06u", gameIndex);
+    return prefix;
+}
+
+bool
+WriteSyntheticGamesDb(
+    const std::string& gamesDbPath,
+    uint32_t numGames,
+    const std::vector<std::string>& texturePrefixes)
+{
+    json gamesArray = json::array();
+    for (uint32_t i = 0; i < numGames; ++i)
+    {
+        gamesArray.push_back({
+            { "title", "Synthetic Game " + std::to_string(i) },
+            { "alias", "SG" + std::to_string(i) },
+            { "texture_prefix", texturePrefixes.empty() ? GetSyntheticTexturePrefix(i) : texturePrefixes[i % texturePrefixes.size()] },
+            { "supported", true },
+        });
+    }
+
+    std::ofstream gamesDbOut(gamesDbPath, std::ios::trunc);
+    if (!gamesDbOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open %s for writing", gamesDbPath.c_str());
+        return false;
+    }
+
+    gamesDbOut << json({ { "games", std::move(gamesArray) } }).dump(4) << std::endl;
+    return static_cast<bool>(gamesDbOut);
+}
+
+bool
+WriteSyntheticCovers(
+    const std::string& texturesPath,
+    uint32_t numGames,
+    uint32_t coverWidth,
+    uint32_t coverHeight)
+{
+    if (coverWidth == 0 || coverHeight == 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Cover dimensions must be nonzero");
+        return false;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(texturesPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create %s: %s", texturesPath.c_str(), errorCode.message().c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> pixels;
+    for (uint32_t i = 0; i < numGames; ++i)
+    {
+        FillCover(i, coverWidth, coverHeight, &pixels);
+
+        const std::string CoverPath =
+            (std::filesystem::path(texturesPath) / (GetSyntheticTexturePrefix(i) + "_600x900.png")).string();
+
+        png_image image = {};
+        image.version = PNG_IMAGE_VERSION;
+        image.width = coverWidth;
+        image.height = coverHeight;
+        image.format = PNG_FORMAT_RGB;
+        if (!png_image_write_to_file(&image, CoverPath.c_str(), 0, pixels.data(), 0, nullptr))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write cover %s: %s", CoverPath.c_str(), image.message);
+            png_image_free(&image);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+WriteAppConfigFile(
+    const std::string& configPath,
+    const std::string& texturesPath,
+    const std::string& shadersPath,
+    const std::string& gamesDbPath)
+{
+    std::ofstream configOut(configPath, std::ios::trunc);
+    if (!configOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open %s for writing", configPath.c_str());
+        return false;
+    }
+
+    json configData = {
+        { "textures_path", texturesPath },
+        { "shaders_path", shadersPath },
+        { "gamesdb_path", gamesDbPath },
+    };
+    configOut << configData.dump(4) << std::endl;
+    return static_cast<bool>(configOut);
+}
+
+bool
+WriteSyntheticLibrary(
+    const std::string& outputPath,
+    const std::string& shadersPath,
+    const SyntheticLibraryOptions& options,
+    SyntheticLibraryPaths* pPathsOut)
+{
+    // The config is read from elsewhere, so its paths must be absolute
+    std::error_code errorCode;
+    const std::filesystem::path OutputPath = std::filesystem::absolute(outputPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Invalid output path %s: %s", outputPath.c_str(), errorCode.message().c_str());
+        return false;
+    }
+
+    SyntheticLibraryPaths paths;
+    paths.TexturesPath = (OutputPath / "textures").string();
+    paths.GamesDbPath = (OutputPath / "gamesdb.json").string();
+    paths.ConfigPath = (OutputPath / "config.json").string();
+
+    if (!WriteSyntheticCovers(paths.TexturesPath, options.NumGames, options.CoverWidth, options.CoverHeight) ||
+        !WriteSyntheticGamesDb(paths.GamesDbPath, options.NumGames, {}) ||
+        !WriteAppConfigFile(paths.ConfigPath, paths.TexturesPath, shadersPath, paths.GamesDbPath))
+    {
+        return false;
+    }
+
+    if (pPathsOut)
+    {
+        *pPathsOut = paths;
+    }
+
+    return true;
+}
@@ -0,0 +1,66 @@
+// syntheticlibrary.h
+//
+// Writes made-up game libraries for benchmarking: a gamesdb.json, a cover
+// image per game, and a config.json tying them to a shaders directory.
+// Everything is derived from the game index, so the same N always produces
+// the same library.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SyntheticLibraryOptions
+{
+    uint32_t NumGames = 100;
+
+    // Covers are always named <prefix>_600x900 since that's the texture the
+    // app gives each card, but their pixel size can be scaled down so that
+    // very large libraries still fit in memory.
+    uint32_t CoverWidth = 600;
+    uint32_t CoverHeight = 900;
+};
+
+// Paths of a library written by WriteSyntheticLibrary
+struct SyntheticLibraryPaths
+{
+    std::string TexturesPath;
+    std::string GamesDbPath;
+    std::string ConfigPath;
+};
+
+// e.g. "synthetic_000042"
+std::string GetSyntheticTexturePrefix(uint32_t gameIndex);
+
+// Games are assigned texturePrefixes round-robin; if there are none, each
+// game gets its own synthetic prefix.
+bool
+WriteSyntheticGamesDb(
+    const std::string& gamesDbPath,
+    uint32_t numGames,
+    const std::vector<std::string>& texturePrefixes);
+
+// One RGB cover per game, named after its synthetic prefix
+bool
+WriteSyntheticCovers(
+    const std::string& texturesPath,
+    uint32_t numGames,
+    uint32_t coverWidth,
+    uint32_t coverHeight);
+
+bool
+WriteAppConfigFile(
+    const std::string& configPath,
+    const std::string& texturesPath,
+    const std::string& shadersPath,
+    const std::string& gamesDbPath);
+
+// Creates outputPath if needed and writes the database, the covers under
+// outputPath/textures and a config pointing at shadersPath.
+bool
+WriteSyntheticLibrary(
+    const std::string& outputPath,
+    const std::string& shadersPath,
+    const SyntheticLibraryOptions& options,
+    SyntheticLibraryPaths* pPathsOut = nullptr);
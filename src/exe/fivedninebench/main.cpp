@@ -0,0 +1,629 @@
+// fivednine_bench
+//
+// Renders a fixed number of carousel frames offscreen with a synthetic game
+// library and reports throughput. Input is either scripted (the selection
+// sweeps back and forth across the library) or replayed from a recording
+// (see inputrecording.h), and the simulation advances by a fixed step per
+// frame, so runs are repeatable; nothing is paced or vsynced.
+//
+// With --scaling_sizes, instead generates a library of each given size (see
+// syntheticlibrary.h) and reports how startup, memory, frame time and
+// navigation latency grow with it.
+
+#include "fivednineapp.h"
+#include "appconfig.h"
+#include "inputrecording.h"
+#include "syntheticlibrary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <json/json.hpp>
+
+#include <fivednine/cli/cliargumentparser.h>
+#include <fivednine/input/inputevent.h>
+#include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/render/window.h>
+#include <fivednine/render/color.h>
+#include <fivednine/system/framescheduler.h>
+#include <fivednine/system/histogram.h>
+#include <fivednine/system/memory.h>
+#include <fivednine/system/samplehistory.h>
+#include <fivednine/system/time.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+using namespace fivednine::render;
+using namespace fivednine::system;
+
+namespace
+{
+    static constexpr uint32_t kDefaultNumGames = 100;
+    static constexpr uint32_t kDefaultNumFrames = 1000;
+    static constexpr uint32_t kDefaultNumWarmupFrames = 60;
+    static constexpr uint32_t kDefaultWidth = 1920;
+    static constexpr uint32_t kDefaultHeight = 1080;
+
+    // Scaling runs repeat the whole startup per size, so measure fewer frames.
+    // Covers are kept small and a power of two so that 100k of them fit.
+    static constexpr uint32_t kDefaultNumScalingFrames = 300;
+    static constexpr uint32_t kDefaultScalingCoverWidth = 64;
+    static constexpr uint32_t kDefaultScalingCoverHeight = 128;
+
+    // One selection change every this many frames; about four per second at
+    // a nominal 60Hz, so the camera is almost always in motion
+    static constexpr uint32_t kFramesPerInput = 15;
+
+    double NsToMs(uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / time::kNanosecondsPerMillisecond;
+    }
+
+    bool GetUint32Argument(
+        const cli::CommandLineArgumentParser& argumentParser,
+        const char* pArgumentName,
+        uint32_t defaultValue,
+        uint32_t* pValueOut)
+    {
+        *pValueOut = defaultValue;
+        const cli::CommandLineArgument* pArgument = argumentParser.FindArgument(pArgumentName);
+        if (pArgument && !pArgument->AsUint32(pValueOut))
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "--%s expects an unsigned integer, got %s",
+                pArgumentName,
+                pArgument->AsString().c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    // Texture prefixes of the cover art actually on disk (<prefix>_600x900.png),
+    // so that synthetic cards are textured like real ones
+    std::vector<std::string> FindTexturePrefixes(const std::string& texturesPath)
+    {
+        static const std::string kCardTextureSuffix = "_600x900";
+
+        std::vector<std::string> texturePrefixes;
+        std::error_code errorCode;
+        for (const auto& directoryEntry : std::filesystem::directory_iterator(texturesPath, errorCode))
+        {
+            const std::filesystem::path& FilePath = directoryEntry.path();
+            const std::string Stem = FilePath.stem().string();
+            if (FilePath.extension() == ".png" &&
+                Stem.size() > kCardTextureSuffix.size() &&
+                Stem.compare(Stem.size() - kCardTextureSuffix.size(), std::string::npos, kCardTextureSuffix) == 0)
+            {
+                texturePrefixes.push_back(Stem.substr(0, Stem.size() - kCardTextureSuffix.size()));
+            }
+        }
+
+        std::sort(std::begin(texturePrefixes), std::end(texturePrefixes));
+        return texturePrefixes;
+    }
+
+    // Sweeps right to the end of the library, then back left, and so on
+    input::ActionType NextScriptedAction(fivednineApp& app, input::ActionType previousAction)
+    {
+        const uint32_t NumCards = app.Selector_GetNumCards();
+        const uint32_t SelectedIndex = app.Selector_GetSelectedIndex();
+        if (previousAction == input::ActionType::Next)
+        {
+            return SelectedIndex + 1 < NumCards ? input::ActionType::Next : input::ActionType::Previous;
+        }
+
+        return SelectedIndex > 0 ? input::ActionType::Previous : input::ActionType::Next;
+    }
+
+    // Runs warmup frames, then measured ones, and returns the measured wall
+    // time. Input is replayed if pInputReplayer is given, otherwise
+    // scripted. With finishEachFrame, every frame waits for the GPU, so
+    // frame times and input latency include GPU work rather than just
+    // submission.
+    double
+    RunFrames(
+        Window& window,
+        fivednineApp& app,
+        uint32_t numWarmupFrames,
+        uint32_t numFrames,
+        bool finishEachFrame,
+        InputReplayer* pInputReplayer,
+        SampleHistory* pFrameTimesMsOut)
+    {
+        // Same number of simulation steps per frame as a 60Hz display gets
+        const float FixedTimestepSeconds = 1.f / FrameScheduler::kDefaultSimulationHz;
+        const uint32_t StepsPerFrame =
+            static_cast<uint32_t>(FrameScheduler::kDefaultSimulationHz / FrameScheduler::kDefaultRefreshHz);
+
+        input::ActionType scriptedAction = input::ActionType::Next;
+        uint64_t simulationStep = 0;
+        uint64_t measureStartNs = 0;
+
+        const uint32_t TotalFrames = numWarmupFrames + numFrames;
+        for (uint32_t frameIndex = 0; frameIndex < TotalFrames; ++frameIndex)
+        {
+            if (frameIndex == numWarmupFrames)
+            {
+                window.Finish();
+                app.GetFrameTimings().ClearInputLatencies();
+                measureStartNs = time::GetTicksNs();
+            }
+            const uint64_t FrameStartNs = time::GetTicksNs();
+
+            if (!pInputReplayer && frameIndex % kFramesPerInput == 0)
+            {
+                scriptedAction = NextScriptedAction(app, scriptedAction);
+
+                input::InputEvent event;
+                event.ActionType = scriptedAction;
+                event.TimestampNs = FrameStartNs;
+                event.IsPressed = true;
+                window.InjectInputEvent(event);
+                event.IsPressed = false;
+                window.InjectInputEvent(event);
+            }
+
+            for (uint32_t i = 0; i < StepsPerFrame; ++i)
+            {
+                if (pInputReplayer)
+                {
+                    pInputReplayer->DeliverEvents(simulationStep);
+                }
+
+                app.Tick(FixedTimestepSeconds);
+                ++simulationStep;
+            }
+
+            window.Clear(ColorRGB::BLACK);
+            app.Draw(1.f);
+            window.Update();
+            if (finishEachFrame)
+            {
+                window.Finish();
+            }
+            app.OnFramePresented(time::GetTicksNs());
+
+            if (frameIndex >= numWarmupFrames)
+            {
+                pFrameTimesMsOut->AddSample(NsToMs(time::GetTicksNs() - FrameStartNs));
+            }
+        }
+
+        // Without finishEachFrame, frame times are submission times; the
+        // total still includes waiting for the GPU to drain
+        window.Finish();
+        return static_cast<double>(time::GetTicksNs() - measureStartNs) / time::kNanosecondsPerSecond;
+    }
+
+    // "10,100,1000" -> { 10, 100, 1000 }
+    bool ParseSizeList(const std::string& sizeList, std::vector<uint32_t>* pSizesOut)
+    {
+        pSizesOut->clear();
+        size_t start = 0;
+        while (start <= sizeList.size())
+        {
+            const size_t End = std::min(sizeList.find(',', start), sizeList.size());
+            uint32_t size = 0;
+            const char* pBegin = sizeList.data() + start;
+            const char* pEnd = sizeList.data() + End;
+            const std::from_chars_result Result = std::from_chars(pBegin, pEnd, size);
+            if (Result.ec != std::errc() || Result.ptr != pEnd || size == 0)
+            {
+                return false;
+            }
+
+            pSizesOut->push_back(size);
+            start = End + 1;
+        }
+
+        return !pSizesOut->empty();
+    }
+
+    struct ScalingRunOptions
+    {
+        uint32_t NumFrames = kDefaultNumScalingFrames;
+        uint32_t NumWarmupFrames = kDefaultNumWarmupFrames;
+        uint32_t Width = kDefaultWidth;
+        uint32_t Height = kDefaultHeight;
+    };
+
+    // Runs in a child process per library size, so that memory figures
+    // aren't polluted by earlier, larger runs. Results go to resultPath as
+    // JSON, since the parent can't see this process's memory.
+    bool
+    RunScalingStep(
+        const std::string& configPath,
+        uint32_t numGames,
+        const ScalingRunOptions& options,
+        const std::string& resultPath)
+    {
+        AppConfig appConfig;
+        if (!appConfig.Parse(configPath))
+        {
+            return false;
+        }
+
+        Window window("fivednine_bench", options.Width, options.Height, false /* fullScreen */, true /* headless */);
+        fivednineApp app;
+
+        const uint64_t InitializeStartNs = time::GetTicksNs();
+        if (!app.Initialize(appConfig, &window))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to initialize app with %u games", numGames);
+            return false;
+        }
+        window.Finish();
+        const double InitializeMs = NsToMs(time::GetTicksNs() - InitializeStartNs);
+
+        json stagesData = json::array();
+        for (const StartupStageTiming& stageTiming : app.GetStartupTimings())
+        {
+            stagesData.push_back({ { "stage", stageTiming.pStageName }, { "ms", stageTiming.Milliseconds } });
+        }
+
+        // Taken before rendering so that these are the library's footprint;
+        // with a software rasterizer, texture memory is counted here too
+        const uint64_t RssBytes = memory::GetCurrentRssBytes();
+
+        SampleHistory frameTimesMs(options.NumFrames);
+        RunFrames(window, app, options.NumWarmupFrames, options.NumFrames, true /* finishEachFrame */, nullptr, &frameTimesMs);
+
+        const Histogram& NavigationLatencyMs = app.GetFrameTimings().GetInputLatencyHistogram();
+        json resultData = {
+            { "num_games", numGames },
+            { "num_cards", app.Selector_GetNumCards() },
+            { "initialize_ms", InitializeMs },
+            { "stages", std::move(stagesData) },
+            { "rss_bytes", RssBytes },
+            { "peak_rss_bytes", memory::GetPeakRssBytes() },
+            { "vram_estimate_bytes", app.GetEstimatedVramBytes() },
+            { "frame_avg_ms", frameTimesMs.GetAverage() },
+            { "frame_p50_ms", frameTimesMs.GetPercentile(50.0) },
+            { "frame_p99_ms", frameTimesMs.GetPercentile(99.0) },
+            { "frame_max_ms", frameTimesMs.GetMax() },
+            { "navigation_count", NavigationLatencyMs.GetCount() },
+            { "navigation_avg_ms", NavigationLatencyMs.GetMean() },
+            { "navigation_p50_ms", NavigationLatencyMs.GetPercentile(50.0) },
+            { "navigation_p99_ms", NavigationLatencyMs.GetPercentile(99.0) },
+            { "navigation_max_ms", NavigationLatencyMs.GetMax() },
+        };
+
+        std::ofstream resultOut(resultPath, std::ios::trunc);
+        resultOut << resultData.dump(4) << std::endl;
+        return static_cast<bool>(resultOut);
+    }
+
+    bool RunScalingStepInChild(
+        const std::string& configPath,
+        uint32_t numGames,
+        const ScalingRunOptions& options,
+        const std::string& resultPath,
+        json* pResultOut)
+    {
+        // Buffered output would otherwise be written by both processes
+        fflush(stdout);
+        fflush(stderr);
+
+        const pid_t ChildPid = fork();
+        if (ChildPid < 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "fork failed: %s", strerror(errno));
+            return false;
+        }
+
+        if (ChildPid == 0)
+        {
+            const bool Succeeded = RunScalingStep(configPath, numGames, options, resultPath);
+            fflush(stdout);
+            fflush(stderr);
+            // Skip the parent's exit handlers and static destructors
+            _exit(Succeeded ? 0 : 1);
+        }
+
+        int status = 0;
+        if (waitpid(ChildPid, &status, 0) != ChildPid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Benchmark run with %u games failed", numGames);
+            return false;
+        }
+
+        std::ifstream resultIn(resultPath);
+        *pResultOut = json::parse(resultIn, nullptr, false /* allow_exceptions */);
+        if (pResultOut->is_discarded())
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to read benchmark results from %s", resultPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    void PrintScalingResults(const json& resultsData)
+    {
+        constexpr double BytesPerMiB = 1024.0 * 1024.0;
+        if (resultsData.empty())
+        {
+            return;
+        }
+
+        // Stages are the same for every run
+        printf("startup (ms)\n%8s %10s %10s", "games", "generate", "total");
+        for (const json& stageData : resultsData.front()["stages"])
+        {
+            printf(" %18s", stageData["stage"].get<std::string>().c_str());
+        }
+        printf("\n");
+
+        for (const json& resultData : resultsData)
+        {
+            printf("%8u %10.1f %10.1f",
+                resultData["num_games"].get<uint32_t>(),
+                resultData["generate_ms"].get<double>(),
+                resultData["initialize_ms"].get<double>());
+            for (const json& stageData : resultData["stages"])
+            {
+                printf(" %18.2f", stageData["ms"].get<double>());
+            }
+            printf("\n");
+        }
+
+        printf("\nsteady state\n%8s %10s %10s %10s %10s %10s %10s %10s\n",
+            "games", "rss MiB", "peak MiB", "vram MiB", "frame p50", "frame p99", "nav p50", "nav p99");
+        for (const json& resultData : resultsData)
+        {
+            printf("%8u %10.1f %10.1f %10.1f %10.3f %10.3f %10.3f %10.3f\n",
+                resultData["num_games"].get<uint32_t>(),
+                resultData["rss_bytes"].get<uint64_t>() / BytesPerMiB,
+                resultData["peak_rss_bytes"].get<uint64_t>() / BytesPerMiB,
+                resultData["vram_estimate_bytes"].get<uint64_t>() / BytesPerMiB,
+                resultData["frame_p50_ms"].get<double>(),
+                resultData["frame_p99_ms"].get<double>(),
+                resultData["navigation_p50_ms"].get<double>(),
+                resultData["navigation_p99_ms"].get<double>());
+        }
+    }
+
+    // For each library size: generate a library with its own covers, start
+    // the app on it in a fresh process and measure startup per stage,
+    // memory, steady-state frame time and navigation latency.
+    int RunScaling(const cli::CommandLineArgumentParser& argumentParser, const std::filesystem::path& scratchPath)
+    {
+        const cli::CommandLineArgument* pScalingSizesArgument = argumentParser.FindArgument("scaling_sizes");
+        std::vector<uint32_t> librarySizes;
+        if (!ParseSizeList(pScalingSizesArgument->AsString(), &librarySizes))
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "--scaling_sizes expects a comma-separated list of nonzero sizes, got %s",
+                pScalingSizesArgument->AsString().c_str());
+            return -1;
+        }
+
+        ScalingRunOptions runOptions;
+        SyntheticLibraryOptions libraryOptions;
+        if (!GetUint32Argument(argumentParser, "num_frames", kDefaultNumScalingFrames, &runOptions.NumFrames) ||
+            !GetUint32Argument(argumentParser, "warmup_frames", kDefaultNumWarmupFrames, &runOptions.NumWarmupFrames) ||
+            !GetUint32Argument(argumentParser, "width", kDefaultWidth, &runOptions.Width) ||
+            !GetUint32Argument(argumentParser, "height", kDefaultHeight, &runOptions.Height) ||
+            !GetUint32Argument(argumentParser, "cover_width", kDefaultScalingCoverWidth, &libraryOptions.CoverWidth) ||
+            !GetUint32Argument(argumentParser, "cover_height", kDefaultScalingCoverHeight, &libraryOptions.CoverHeight))
+        {
+            return -1;
+        }
+
+        if (runOptions.NumFrames == 0 || runOptions.Width == 0 || runOptions.Height == 0)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Frame count and dimensions must be nonzero");
+            return -1;
+        }
+
+        std::error_code errorCode;
+        const std::string ShadersPath =
+            std::filesystem::absolute(argumentParser.FindArgument("shaders_path")->AsString(), errorCode).string();
+
+        json resultsData = json::array();
+        for (uint32_t librarySize : librarySizes)
+        {
+            // Each size gets its own library, removed afterwards; at the top
+            // end the covers alone run to gigabytes
+            const std::filesystem::path LibraryPath = scratchPath / ("library_" + std::to_string(librarySize));
+            libraryOptions.NumGames = librarySize;
+
+            const uint64_t GenerateStartNs = time::GetTicksNs();
+            SyntheticLibraryPaths libraryPaths;
+            if (!WriteSyntheticLibrary(LibraryPath.string(), ShadersPath, libraryOptions, &libraryPaths))
+            {
+                RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to generate a library of %u games", librarySize);
+                return -1;
+            }
+            const double GenerateMs = NsToMs(time::GetTicksNs() - GenerateStartNs);
+
+            json resultData;
+            const std::string ResultPath = (LibraryPath / "result.json").string();
+            const bool Succeeded =
+                RunScalingStepInChild(libraryPaths.ConfigPath, librarySize, runOptions, ResultPath, &resultData);
+            std::filesystem::remove_all(LibraryPath, errorCode);
+            if (!Succeeded)
+            {
+                return -1;
+            }
+
+            resultData["generate_ms"] = GenerateMs;
+            resultsData.push_back(std::move(resultData));
+        }
+
+        printf("fivednine_bench scaling: %ux%u, %ux%u covers, %u frames (+%u warmup) per size\n\n",
+            runOptions.Width, runOptions.Height,
+            libraryOptions.CoverWidth, libraryOptions.CoverHeight,
+            runOptions.NumFrames, runOptions.NumWarmupFrames);
+        PrintScalingResults(resultsData);
+
+        const cli::CommandLineArgument* pJsonPathArgument = argumentParser.FindArgument("json_path");
+        if (pJsonPathArgument)
+        {
+            std::ofstream resultsOut(pJsonPathArgument->AsString(), std::ios::trunc);
+            resultsOut << json({ { "scaling", std::move(resultsData) } }).dump(4) << std::endl;
+            if (!resultsOut)
+            {
+                RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write %s", pJsonPathArgument->AsString().c_str());
+                return -1;
+            }
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    log::SetLogVerbosity(log::LogVerbosity::Warning);
+    log::EnableZone(LOG_DEFAULT);
+    log::EnableZone(LOG_RENDER);
+    log::EnableZone(LOG_API);
+
+    cli::CommandLineArgumentParser argumentParser(argc, argv);
+    const cli::CommandLineArgument* pShadersPathArgument = argumentParser.FindArgument("shaders_path");
+    const cli::CommandLineArgument* pTexturesPathArgument = argumentParser.FindArgument("textures_path");
+    const bool IsScalingRun = argumentParser.FindArgument("scaling_sizes") != nullptr;
+    if (!pShadersPathArgument || (!pTexturesPathArgument && !IsScalingRun))
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Usage: %s --shaders_path <path> --textures_path <path> [--num_games <n>] [--num_frames <n>] "
+            "[--warmup_frames <n>] [--width <pixels>] [--height <pixels>] [--replay_input <path>] "
+            "[--trace_path <path>]\n"
+            "       %s --shaders_path <path> --scaling_sizes <n,n,...> [--num_frames <n>] [--warmup_frames <n>] "
+            "[--width <pixels>] [--height <pixels>] [--cover_width <pixels>] [--cover_height <pixels>] "
+            "[--json_path <path>]",
+            argv[0],
+            argv[0]);
+        return -1;
+    }
+
+    // The app only takes its library from a config file, so generate both
+    std::error_code errorCode;
+    std::string scratchTemplate = (std::filesystem::temp_directory_path(errorCode) / "fivednine_bench_XXXXXX").string();
+    if (errorCode || !mkdtemp(scratchTemplate.data()))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to create a scratch directory");
+        return -1;
+    }
+    const std::filesystem::path ScratchPath = scratchTemplate;
+
+    if (IsScalingRun)
+    {
+        const int Result = RunScaling(argumentParser, ScratchPath);
+        std::filesystem::remove_all(ScratchPath, errorCode);
+        return Result;
+    }
+
+    uint32_t numGames, numFrames, numWarmupFrames, width, height;
+    if (!GetUint32Argument(argumentParser, "num_games", kDefaultNumGames, &numGames) ||
+        !GetUint32Argument(argumentParser, "num_frames", kDefaultNumFrames, &numFrames) ||
+        !GetUint32Argument(argumentParser, "warmup_frames", kDefaultNumWarmupFrames, &numWarmupFrames) ||
+        !GetUint32Argument(argumentParser, "width", kDefaultWidth, &width) ||
+        !GetUint32Argument(argumentParser, "height", kDefaultHeight, &height))
+    {
+        std::filesystem::remove_all(ScratchPath, errorCode);
+        return -1;
+    }
+
+    if (numGames == 0 || numFrames == 0 || width == 0 || height == 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Game count, frame count and dimensions must be nonzero");
+        std::filesystem::remove_all(ScratchPath, errorCode);
+        return -1;
+    }
+
+    const cli::CommandLineArgument* pTracePathArgument = argumentParser.FindArgument("trace_path");
+    if (pTracePathArgument)
+    {
+        profile::SetEnabled(true);
+        profile::SetThreadName("main");
+    }
+
+    const std::string GamesDbPath = (ScratchPath / "gamesdb.json").string();
+    const std::string ConfigPath = (ScratchPath / "config.json").string();
+
+    const std::string TexturesPath = pTexturesPathArgument->AsString();
+    if (!WriteSyntheticGamesDb(GamesDbPath, numGames, FindTexturePrefixes(TexturesPath)) ||
+        !WriteAppConfigFile(ConfigPath, TexturesPath, pShadersPathArgument->AsString(), GamesDbPath))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write benchmark configuration to %s", ScratchPath.c_str());
+        std::filesystem::remove_all(ScratchPath, errorCode);
+        return -1;
+    }
+
+    AppConfig appConfig;
+    const bool ParsedConfig = appConfig.Parse(ConfigPath);
+
+    {
+        Window window("fivednine_bench", width, height, false /* fullScreen */, true /* headless */);
+        fivednineApp app;
+
+        const uint64_t InitializeStartNs = time::GetTicksNs();
+        if (!ParsedConfig || !app.Initialize(appConfig, &window))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to initialize app");
+            std::filesystem::remove_all(ScratchPath, errorCode);
+            return -1;
+        }
+        window.Finish();
+        const uint64_t InitializeEndNs = time::GetTicksNs();
+
+        const cli::CommandLineArgument* pReplayInputArgument = argumentParser.FindArgument("replay_input");
+        InputReplayer inputReplayer;
+        if (pReplayInputArgument)
+        {
+            if (!inputReplayer.Load(pReplayInputArgument->AsString(), FrameScheduler::kDefaultSimulationHz))
+            {
+                std::filesystem::remove_all(ScratchPath, errorCode);
+                return -1;
+            }
+            inputReplayer.Begin(&window);
+        }
+
+        SampleHistory frameTimesMs(numFrames);
+        const double TotalSeconds =
+            RunFrames(
+                window,
+                app,
+                numWarmupFrames,
+                numFrames,
+                false /* finishEachFrame */,
+                pReplayInputArgument ? &inputReplayer : nullptr,
+                &frameTimesMs);
+
+        printf("fivednine_bench: %u cards, %ux%u, %u frames (+%u warmup)\n",
+            app.Selector_GetNumCards(), width, height, numFrames, numWarmupFrames);
+        printf("  initialize      %8.2f ms\n", NsToMs(InitializeEndNs - InitializeStartNs));
+        printf("  total           %8.2f ms\n", TotalSeconds * 1000.0);
+        printf("  throughput      %8.2f frames/s\n", numFrames / TotalSeconds);
+        printf("  frame avg       %8.3f ms\n", frameTimesMs.GetAverage());
+        printf("  frame p50       %8.3f ms\n", frameTimesMs.GetPercentile(50.0));
+        printf("  frame p99       %8.3f ms\n", frameTimesMs.GetPercentile(99.0));
+        printf("  frame max       %8.3f ms\n", frameTimesMs.GetMax());
+    }
+
+    if (pTracePathArgument)
+    {
+        profile::ExportChromeTrace(pTracePathArgument->AsString());
+    }
+
+    std::filesystem::remove_all(ScratchPath, errorCode);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// fivednine_librarygen
+//
+// Writes a synthetic game library (gamesdb.json plus one cover per game) for
+// trying out the selector, or benchmarking it, at library sizes nobody has
+// on disk. With --shaders_path, also writes a config.json that fivednine can
+// be pointed at directly.
+
+#include "syntheticlibrary.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#include <fivednine/cli/cliargumentparser.h>
+#include <fivednine/log/log.h>
+#include <fivednine/system/time.h>
+
+using namespace fivednine;
+
+namespace
+{
+    static constexpr uint32_t kMaxNumGames = 1000000;
+
+    bool GetUint32Argument(
+        const cli::CommandLineArgumentParser& argumentParser,
+        const char* pArgumentName,
+        uint32_t defaultValue,
+        uint32_t* pValueOut)
+    {
+        *pValueOut = defaultValue;
+        const cli::CommandLineArgument* pArgument = argumentParser.FindArgument(pArgumentName);
+        if (pArgument && !pArgument->AsUint32(pValueOut))
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "--%s expects an unsigned integer, got %s",
+                pArgumentName,
+                pArgument->AsString().c_str());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    log::SetLogVerbosity(log::LogVerbosity::Warning);
+    log::EnableZone(LOG_DEFAULT);
+
+    cli::CommandLineArgumentParser argumentParser(argc, argv);
+    const cli::CommandLineArgument* pOutputDirArgument = argumentParser.FindArgument("output_dir");
+    if (!pOutputDirArgument)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Usage: %s --output_dir <path> [--num_games <n>] [--cover_width <pixels>] [--cover_height <pixels>] "
+            "[--shaders_path <path>]",
+            argv[0]);
+        return -1;
+    }
+
+    SyntheticLibraryOptions options;
+    if (!GetUint32Argument(argumentParser, "num_games", options.NumGames, &options.NumGames) ||
+        !GetUint32Argument(argumentParser, "cover_width", options.CoverWidth, &options.CoverWidth) ||
+        !GetUint32Argument(argumentParser, "cover_height", options.CoverHeight, &options.CoverHeight))
+    {
+        return -1;
+    }
+
+    if (options.NumGames == 0 || options.NumGames > kMaxNumGames)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "--num_games must be between 1 and %u", kMaxNumGames);
+        return -1;
+    }
+
+    // The config is only useful with shaders to point at; without them,
+    // write just the library
+    const cli::CommandLineArgument* pShadersPathArgument = argumentParser.FindArgument("shaders_path");
+    const uint64_t StartNs = system::time::GetTicksNs();
+
+    SyntheticLibraryPaths paths;
+    if (pShadersPathArgument)
+    {
+        std::error_code errorCode;
+        const std::string ShadersPath =
+            std::filesystem::absolute(pShadersPathArgument->AsString(), errorCode).string();
+        if (!WriteSyntheticLibrary(pOutputDirArgument->AsString(), ShadersPath, options, &paths))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        const std::filesystem::path OutputPath = pOutputDirArgument->AsString();
+        paths.TexturesPath = (OutputPath / "textures").string();
+        paths.GamesDbPath = (OutputPath / "gamesdb.json").string();
+        if (!WriteSyntheticCovers(paths.TexturesPath, options.NumGames, options.CoverWidth, options.CoverHeight) ||
+            !WriteSyntheticGamesDb(paths.GamesDbPath, options.NumGames, {}))
+        {
+            return -1;
+        }
+    }
+
+    printf("Wrote %u games (%ux%u covers) in %.2f s\n",
+        options.NumGames,
+        options.CoverWidth,
+        options.CoverHeight,
+        static_cast<double>(system::time::GetTicksNs() - StartNs) / system::time::kNanosecondsPerSecond);
+    printf("  gamesdb   %s\n", paths.GamesDbPath.c_str());
+    printf("  textures  %s\n", paths.TexturesPath.c_str());
+    if (!paths.ConfigPath.empty())
+    {
+        printf("  config    %s\n", paths.ConfigPath.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,478 @@
+// fivednine_microbench
+//
+// Microbenchmarks for the render and core library hot paths. GL benchmarks
+// run against a headless context, so they work without a display (e.g.
+// under Mesa's llvmpipe). Results go to stdout, and optionally to a JSON file
+// for comparing builds.
+
+#include "microbenchmark.h"
+
+#include "appevents.h"
+#include "gamesdb.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <json/json.hpp>
+
+#include <fivednine/cli/cliargumentparser.h>
+#include <fivednine/log/log.h>
+#include <fivednine/render/mesh.h>
+#include <fivednine/render/rendercommon.h>
+#include <fivednine/render/shaderstorage.h>
+#include <fivednine/render/texturestorage.h>
+#include <fivednine/render/uniform.h>
+#include <fivednine/render/window.h>
+#include <fivednine/system/ringqueue.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+using namespace fivednine::render;
+
+namespace
+{
+    // Same interface as the gamecard shaders, embedded so the benchmark
+    // doesn't depend on the asset directory
+    static const char* kVertexShaderText = R"(#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 texCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 uv;
+
+void main()
+{
+    uv = texCoords;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
+)";
+
+    static const char* kFragmentShaderText = R"(#version 330 core
+uniform float tint = 1.0;
+uniform sampler2D sampler;
+
+in vec2 uv;
+out vec4 fragmentColor;
+
+void main()
+{
+    fragmentColor = vec4(tint, tint, tint, 1.0) * vec4(texture(sampler, uv).rgb, 1.0);
+}
+)";
+
+    static const glm::vec3 kQuadVertices[4] = {
+        glm::vec3(0.f, 0.f, 0.f),
+        glm::vec3(1.f, 0.f, 0.f),
+        glm::vec3(1.f, 1.f, 0.f),
+        glm::vec3(0.f, 1.f, 0.f)
+    };
+
+    static const glm::vec2 kQuadUVs[4] = {
+        glm::vec2(0.f, 0.f),
+        glm::vec2(1.f, 0.f),
+        glm::vec2(1.f, 1.f),
+        glm::vec2(0.f, 1.f)
+    };
+
+    static const int kQuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    static const uint32_t kTextureStorageSizes[] = { 10, 1000, 100000 };
+    static constexpr uint32_t kNumSyntheticGames = 1000;
+
+    std::string TextureNameFromIndex(uint32_t index)
+    {
+        char textureName[32];
+        snprintf(textureName, sizeof(textureName), "texture_%06u", index);
+        return textureName;
+    }
+
+    std::string MakeSyntheticGamesDb(uint32_t numGames)
+    {
+        json gamesArray = json::array();
+        for (uint32_t i = 0; i < numGames; ++i)
+        {
+            gamesArray.push_back({
+                { "title", "Synthetic Game " + std::to_string(i) },
+                { "alias", "SG" + std::to_string(i) },
+                { "steam_appid", 100000 + i },
+                { "proton", (i % 2) == 0 },
+                { "supported", true },
+                { "texture_prefix", "synthetic_" + std::to_string(i) },
+            });
+        }
+
+        return json({ { "games", std::move(gamesArray) } }).dump(4);
+    }
+
+    // Points stderr (where the log writes) at /dev/null for as long as it's
+    // alive, so that logging benchmarks don't flood the terminal
+    class ScopedSilenceStderr
+    {
+    public:
+        ScopedSilenceStderr()
+        {
+            fflush(stderr);
+            m_savedDescriptor = dup(STDERR_FILENO);
+            const int NullDescriptor = open("/dev/null", O_WRONLY);
+            if (NullDescriptor >= 0)
+            {
+                dup2(NullDescriptor, STDERR_FILENO);
+                close(NullDescriptor);
+            }
+        }
+
+        ~ScopedSilenceStderr()
+        {
+            fflush(stderr);
+            if (m_savedDescriptor >= 0)
+            {
+                dup2(m_savedDescriptor, STDERR_FILENO);
+                close(m_savedDescriptor);
+            }
+        }
+
+    private:
+        int m_savedDescriptor = -1;
+    };
+
+    void RunRenderBenchmarks(MicrobenchmarkRunner* pRunner)
+    {
+        ShaderStorage shaderStorage;
+        if (!shaderStorage.AddShader(kVertexShaderText, kFragmentShaderText, "microbench"))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to compile benchmark shader; skipping render benchmarks");
+            return;
+        }
+        ShaderPtr spShader = shaderStorage.FindShaderByName("microbench");
+
+        TextureStorage textureStorage;
+        uint8_t whitePixel[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+        textureStorage.AddTexture(ImageData{ 1, 1, 4, whitePixel }, "white");
+
+        Mesh mesh(4, 6);
+        mesh.SetShader(spShader);
+        mesh.SetPositions(kQuadVertices, 4);
+        mesh.SetTextureCoordinates(kQuadUVs, 4);
+        mesh.SetIndices(kQuadIndices, 6);
+        mesh.SetModelMatrix(glm::mat4(1.f));
+        mesh.SetTexture(textureStorage.FindTextureByName("white"));
+
+        const glm::mat4 Identity(1.f);
+        const float Tint = 0.5f;
+        pRunner->Run("Mesh::Draw",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    mesh.SetMeshUniforms({ MeshUniformValue("tint", UniformType::Float, &Tint) });
+                    mesh.Draw(Identity, Identity);
+                }
+            },
+            []()
+            {
+                // Only submission is timed; don't let queued work pile up
+                glFinish();
+            });
+
+        const uint32_t TintLocation = spShader->GetUniform("tint");
+        const uint32_t ModelLocation = spShader->GetUniform("model");
+        spShader->Bind();
+        pRunner->Run("SetUniformByType/Float",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    SetUniformByType(TintLocation, UniformType::Float, &Tint);
+                }
+            });
+        pRunner->Run("SetUniformByType/Mat4",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    SetUniformByType(ModelLocation, UniformType::Mat4, &Identity);
+                }
+            });
+        spShader->Unbind();
+
+        const std::string UniformName = "projection";
+        pRunner->Run("Shader::GetUniform/string",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    DoNotOptimize(spShader->GetUniform(UniformName));
+                }
+            });
+        // How Mesh::Draw looks uniforms up, converting from a char array
+        pRunner->Run("Shader::GetUniform/cstring",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    DoNotOptimize(spShader->GetUniform("projection"));
+                }
+            });
+        const std::string MissingUniformName = "not_a_uniform";
+        pRunner->Run("Shader::GetUniform/miss",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    DoNotOptimize(spShader->GetUniform(MissingUniformName));
+                }
+            });
+
+        for (uint32_t storageSize : kTextureStorageSizes)
+        {
+            const std::string HitName = "TextureStorage::FindTextureByName/" + std::to_string(storageSize);
+            const std::string MissName = HitName + "/miss";
+            if (!pRunner->IsSelected(HitName) && !pRunner->IsSelected(MissName))
+            {
+                continue;
+            }
+
+            TextureStorage sizedTextureStorage;
+            for (uint32_t i = 0; i < storageSize; ++i)
+            {
+                sizedTextureStorage.AddTexture(ImageData{ 1, 1, 4, whitePixel }, TextureNameFromIndex(i));
+            }
+
+            // A hash lookup by name, so this should stay flat as storage
+            // grows; the newest texture is used only to keep runs comparable
+            const std::string LastTextureName = TextureNameFromIndex(storageSize - 1);
+            pRunner->Run(HitName,
+                [&](uint64_t numIterations)
+                {
+                    for (uint64_t i = 0; i < numIterations; ++i)
+                    {
+                        DoNotOptimize(sizedTextureStorage.FindTextureByName(LastTextureName));
+                    }
+                });
+
+            const std::string MissingTextureName = "texture_missing";
+            pRunner->Run(MissName,
+                [&](uint64_t numIterations)
+                {
+                    for (uint64_t i = 0; i < numIterations; ++i)
+                    {
+                        DoNotOptimize(sizedTextureStorage.FindTextureByName(MissingTextureName));
+                    }
+                });
+        }
+    }
+
+    void RunCoreBenchmarks(MicrobenchmarkRunner* pRunner)
+    {
+        // Dispatched in batches, the way the app sees them, to one subscriber
+        static constexpr uint64_t kBatchSize = 64;
+        AppEventBus eventBus;
+        uint64_t numMoves = 0;
+        eventBus.Subscribe<SelectorInputEvent>(
+            [](const SelectorInputEvent& inputEvent, void* pUserPointer)
+            {
+                *static_cast<uint64_t*>(pUserPointer) += inputEvent.Count;
+            },
+            &numMoves);
+
+        SelectorInputEvent event;
+        event.InputEventType = SelectorInputEventType::NextSelection;
+        event.TimestampNs = 0;
+        event.Count = 1;
+
+        // Alternating directions, which never coalesce
+        SelectorInputEvent previousEvent = event;
+        previousEvent.InputEventType = SelectorInputEventType::PreviousSelection;
+        pRunner->Run("EventBus/PostAndDispatch",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    eventBus.Post(i % 2 == 0 ? event : previousEvent);
+                    if ((i + 1) % kBatchSize == 0)
+                    {
+                        eventBus.Dispatch();
+                    }
+                }
+                eventBus.Dispatch();
+                DoNotOptimize(numMoves);
+            });
+
+        // A run of moves, which is merged into one event per batch
+        pRunner->Run("EventBus/PostAndDispatchCoalesced",
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    eventBus.Post(event);
+                    if ((i + 1) % kBatchSize == 0)
+                    {
+                        eventBus.Dispatch();
+                    }
+                }
+                eventBus.Dispatch();
+                DoNotOptimize(numMoves);
+            });
+
+        // Single threaded, so these measure the per-operation cost without
+        // contention
+        static constexpr size_t kQueueCapacity = 256;
+        static constexpr uint64_t kQueueBatchSize = 64;
+        system::SpscRingQueue<SelectorInputEvent, kQueueCapacity> spscQueue;
+        pRunner->Run("SpscRingQueue/PushPop",
+            [&](uint64_t numIterations)
+            {
+                SelectorInputEvent eventOut;
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    spscQueue.TryPush(event);
+                    if ((i + 1) % kQueueBatchSize == 0)
+                    {
+                        while (spscQueue.TryPop(&eventOut)) {}
+                    }
+                }
+                while (spscQueue.TryPop(&eventOut)) {}
+                DoNotOptimize(eventOut);
+            });
+
+        system::MpscRingQueue<SelectorInputEvent, kQueueCapacity> mpscQueue;
+        pRunner->Run("MpscRingQueue/PushPop",
+            [&](uint64_t numIterations)
+            {
+                SelectorInputEvent eventOut;
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    mpscQueue.TryPush(event);
+                    if ((i + 1) % kQueueBatchSize == 0)
+                    {
+                        while (mpscQueue.TryPop(&eventOut)) {}
+                    }
+                }
+                while (mpscQueue.TryPop(&eventOut)) {}
+                DoNotOptimize(eventOut);
+            });
+
+        {
+            ScopedSilenceStderr silenceStderr;
+            log::SetLogVerbosity(log::LogVerbosity::Info);
+            pRunner->Run("log::LogLine/formatted",
+                [](uint64_t numIterations)
+                {
+                    for (uint64_t i = 0; i < numIterations; ++i)
+                    {
+                        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Added texture to storage: %s (%llu)", "texture_000042",
+                            static_cast<unsigned long long>(i));
+                    }
+                });
+            log::SetLogVerbosity(log::LogVerbosity::Warning);
+            pRunner->Run("log::LogLine/filtered",
+                [](uint64_t numIterations)
+                {
+                    for (uint64_t i = 0; i < numIterations; ++i)
+                    {
+                        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Added texture to storage: %s (%llu)", "texture_000042",
+                            static_cast<unsigned long long>(i));
+                    }
+                });
+        }
+
+        const std::string GamesDbText = MakeSyntheticGamesDb(kNumSyntheticGames);
+        std::vector<GameInfo> gameInfos;
+        pRunner->Run("ParseGamesDb/" + std::to_string(kNumSyntheticGames),
+            [&](uint64_t numIterations)
+            {
+                for (uint64_t i = 0; i < numIterations; ++i)
+                {
+                    std::istringstream gamesDbIn(GamesDbText);
+                    ParseGamesDb(gamesDbIn, "synthetic", &gameInfos);
+                    DoNotOptimize(gameInfos.data());
+                }
+            });
+    }
+
+    bool GetUint32Argument(
+        const cli::CommandLineArgumentParser& argumentParser,
+        const char* pArgumentName,
+        uint32_t* pValueOut)
+    {
+        const cli::CommandLineArgument* pArgument = argumentParser.FindArgument(pArgumentName);
+        if (pArgument && !pArgument->AsUint32(pValueOut))
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "--%s expects an unsigned integer, got %s",
+                pArgumentName,
+                pArgument->AsString().c_str());
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    log::SetLogVerbosity(log::LogVerbosity::Warning);
+    log::EnableZone(LOG_DEFAULT);
+    log::EnableZone(LOG_RENDER);
+    log::EnableZone(LOG_API);
+
+    cli::CommandLineArgumentParser argumentParser(argc, argv);
+
+    MicrobenchmarkRunner::Options options;
+    uint32_t targetRepetitionMs = static_cast<uint32_t>(options.TargetRepetitionNs / 1000000);
+    if (!GetUint32Argument(argumentParser, "warmup", &options.NumWarmupRepetitions) ||
+        !GetUint32Argument(argumentParser, "repetitions", &options.NumRepetitions) ||
+        !GetUint32Argument(argumentParser, "repetition_ms", &targetRepetitionMs))
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Usage: %s [--filter <substring>] [--warmup <n>] [--repetitions <n>] [--repetition_ms <ms>] "
+            "[--gl true|false] [--json_path <path>]",
+            argv[0]);
+        return -1;
+    }
+    options.TargetRepetitionNs = static_cast<uint64_t>(targetRepetitionMs) * 1000000;
+
+    const cli::CommandLineArgument* pFilterArgument = argumentParser.FindArgument("filter");
+    if (pFilterArgument)
+    {
+        options.Filter = pFilterArgument->AsString();
+    }
+
+    // GL benchmarks need EGL; they can be skipped where it isn't available
+    bool runRenderBenchmarks = true;
+    const cli::CommandLineArgument* pGlArgument = argumentParser.FindArgument("gl");
+    if (pGlArgument && !pGlArgument->AsBool(&runRenderBenchmarks))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "--gl expects true or false");
+        return -1;
+    }
+
+    MicrobenchmarkRunner runner(options);
+    if (runRenderBenchmarks)
+    {
+        Window window("fivednine_microbench", 256, 256, false /* fullScreen */, true /* headless */);
+        RunRenderBenchmarks(&runner);
+    }
+    RunCoreBenchmarks(&runner);
+
+    runner.PrintResults();
+
+    const cli::CommandLineArgument* pJsonPathArgument = argumentParser.FindArgument("json_path");
+    if (pJsonPathArgument && !runner.WriteToFile(pJsonPathArgument->AsString()))
+    {
+        return -1;
+    }
+
+    return 0;
+}
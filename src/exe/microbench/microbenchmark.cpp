@@ -0,0 +1,174 @@
+#include "microbenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+#include <fivednine/system/samplehistory.h>
+#include <fivednine/system/time.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+
+namespace
+{
+    // Calibration never goes past this, so that a benchmark whose body is
+    // optimized away doesn't loop forever
+    static constexpr uint64_t kMaxIterationsPerRepetition = 1ull << 30;
+
+    uint64_t TimeRepetitionNs(const MicrobenchmarkRunner::FnBenchmark& fnBenchmark, uint64_t numIterations)
+    {
+        const uint64_t StartNs = system::time::GetTicksNs();
+        fnBenchmark(numIterations);
+        return system::time::GetTicksNs() - StartNs;
+    }
+}
+
+MicrobenchmarkRunner::MicrobenchmarkRunner(const Options& options)
+    : m_options(options)
+{
+    m_options.NumRepetitions = std::max<uint32_t>(m_options.NumRepetitions, 1);
+}
+
+bool MicrobenchmarkRunner::IsSelected(const std::string& name) const
+{
+    return m_options.Filter.empty() || name.find(m_options.Filter) != std::string::npos;
+}
+
+void MicrobenchmarkRunner::Run(const std::string& name, const FnBenchmark& fnBenchmark, const FnSettle& fnSettle)
+{
+    if (!IsSelected(name))
+    {
+        return;
+    }
+
+    const uint64_t NumIterations = CalibrateIterations(fnBenchmark, fnSettle);
+    for (uint32_t i = 0; i < m_options.NumWarmupRepetitions; ++i)
+    {
+        fnBenchmark(NumIterations);
+        if (fnSettle)
+        {
+            fnSettle();
+        }
+    }
+
+    system::SampleHistory samplesNs(m_options.NumRepetitions);
+    for (uint32_t i = 0; i < m_options.NumRepetitions; ++i)
+    {
+        const uint64_t ElapsedNs = TimeRepetitionNs(fnBenchmark, NumIterations);
+        samplesNs.AddSample(static_cast<double>(ElapsedNs) / NumIterations);
+        if (fnSettle)
+        {
+            fnSettle();
+        }
+    }
+
+    MicrobenchmarkResult result;
+    result.Name = name;
+    result.IterationsPerRepetition = NumIterations;
+    result.NumRepetitions = m_options.NumRepetitions;
+    result.MinNs = samplesNs.GetMin();
+    result.MedianNs = samplesNs.GetPercentile(50.0);
+    result.MeanNs = samplesNs.GetAverage();
+    result.MaxNs = samplesNs.GetMax();
+
+    double sumSquaredDeviations = 0.0;
+    samplesNs.ForEachSample([&](double sampleNs) -> bool
+        {
+            const double Deviation = sampleNs - result.MeanNs;
+            sumSquaredDeviations += Deviation * Deviation;
+            return true;
+        });
+    result.StdDevNs = std::sqrt(sumSquaredDeviations / samplesNs.GetCount());
+
+    m_results.push_back(result);
+}
+
+const std::vector<MicrobenchmarkResult>& MicrobenchmarkRunner::GetResults() const
+{
+    return m_results;
+}
+
+void MicrobenchmarkRunner::PrintResults() const
+{
+    printf("%-48s %12s %12s %12s %12s %10s\n", "benchmark", "iterations", "median ns", "mean ns", "min ns", "stddev %");
+    for (const MicrobenchmarkResult& result : m_results)
+    {
+        printf("%-48s %12llu %12.1f %12.1f %12.1f %10.1f\n",
+            result.Name.c_str(),
+            static_cast<unsigned long long>(result.IterationsPerRepetition),
+            result.MedianNs,
+            result.MeanNs,
+            result.MinNs,
+            result.MeanNs > 0.0 ? 100.0 * result.StdDevNs / result.MeanNs : 0.0);
+    }
+}
+
+bool MicrobenchmarkRunner::WriteToFile(const std::string& resultsPath) const
+{
+    json benchmarksData = json::array();
+    for (const MicrobenchmarkResult& result : m_results)
+    {
+        benchmarksData.push_back({
+            { "name", result.Name },
+            { "iterations", result.IterationsPerRepetition },
+            { "repetitions", result.NumRepetitions },
+            { "min_ns", result.MinNs },
+            { "median_ns", result.MedianNs },
+            { "mean_ns", result.MeanNs },
+            { "max_ns", result.MaxNs },
+            { "stddev_ns", result.StdDevNs },
+        });
+    }
+
+    std::ofstream resultsOut(resultsPath, std::ios::trunc);
+    if (!resultsOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open benchmark results file: %s", resultsPath.c_str());
+        return false;
+    }
+
+    resultsOut << json({ { "benchmarks", std::move(benchmarksData) } }).dump(4) << std::endl;
+    return true;
+}
+
+uint64_t MicrobenchmarkRunner::CalibrateIterations(const FnBenchmark& fnBenchmark, const FnSettle& fnSettle) const
+{
+    // First calls tend to pay for one-off work (lazy shader compiles, cold
+    // caches) which would throw the estimate off
+    fnBenchmark(1);
+    if (fnSettle)
+    {
+        fnSettle();
+    }
+
+    // Grow geometrically until a repetition is long enough to measure, then
+    // scale to the target
+    uint64_t numIterations = 1;
+    while (true)
+    {
+        const uint64_t ElapsedNs = TimeRepetitionNs(fnBenchmark, numIterations);
+        if (fnSettle)
+        {
+            fnSettle();
+        }
+
+        if (numIterations >= kMaxIterationsPerRepetition)
+        {
+            return kMaxIterationsPerRepetition;
+        }
+
+        if (ElapsedNs >= m_options.TargetRepetitionNs / 10)
+        {
+            const double NsPerIteration = std::max(static_cast<double>(ElapsedNs) / numIterations, 1e-3);
+            const double TargetIterations = m_options.TargetRepetitionNs / NsPerIteration;
+            return std::clamp<uint64_t>(static_cast<uint64_t>(TargetIterations), 1, kMaxIterationsPerRepetition);
+        }
+
+        numIterations *= ElapsedNs > 0 ? std::min<uint64_t>(10, m_options.TargetRepetitionNs / 10 / ElapsedNs + 1) : 10;
+    }
+}
@@ -0,0 +1,75 @@
+// microbenchmark.h
+//
+// Small benchmark harness. A benchmark is a function which runs its body a
+// given number of times. The runner calibrates that count so one repetition
+// takes roughly the target time, runs a few untimed warmup repetitions, then
+// reports per-iteration statistics over the timed repetitions.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from discarding a value, or the computation producing
+// it, whose result is otherwise unused
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct MicrobenchmarkResult
+{
+    std::string Name;
+    uint64_t    IterationsPerRepetition = 0;
+    uint32_t    NumRepetitions = 0;
+
+    // Nanoseconds per iteration across repetitions
+    double MinNs = 0.0;
+    double MedianNs = 0.0;
+    double MeanNs = 0.0;
+    double MaxNs = 0.0;
+    double StdDevNs = 0.0;
+};
+
+class MicrobenchmarkRunner
+{
+public:
+    typedef std::function<void(uint64_t numIterations)> FnBenchmark;
+
+    // Runs untimed after each repetition, e.g. to wait for the GPU or to
+    // reset state the benchmark accumulated
+    typedef std::function<void()> FnSettle;
+
+    struct Options
+    {
+        uint32_t NumWarmupRepetitions = 3;
+        uint32_t NumRepetitions = 20;
+        uint64_t TargetRepetitionNs = 10000000; // 10ms
+
+        // Only benchmarks whose names contain this run. Empty runs everything.
+        std::string Filter;
+    };
+
+    explicit MicrobenchmarkRunner(const Options& options);
+
+    // Returns false if the benchmark was filtered out
+    bool IsSelected(const std::string& name) const;
+
+    void Run(const std::string& name, const FnBenchmark& fnBenchmark, const FnSettle& fnSettle = nullptr);
+
+    const std::vector<MicrobenchmarkResult>& GetResults() const;
+
+    // Human-readable table on stdout
+    void PrintResults() const;
+
+    bool WriteToFile(const std::string& resultsPath) const;
+
+private:
+    uint64_t CalibrateIterations(const FnBenchmark& fnBenchmark, const FnSettle& fnSettle) const;
+
+    Options                           m_options;
+    std::vector<MicrobenchmarkResult> m_results;
+};
@@ -0,0 +1,269 @@
+#include "steamlibraryscanner.h"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+#include <json/json.hpp>
+
+#include <fivednine/cli/cliargumentparser.h>
+#include <fivednine/log/log.h>
+
+// Preserve key order; the games DB is maintained by hand
+using json = nlohmann::ordered_json;
+using namespace fivednine;
+
+namespace
+{
+    // Runtimes and redistributables show up as apps but aren't games
+    bool IsSteamTool(const SteamAppManifest& manifest)
+    {
+        static const char* kToolNamePrefixes[] = {
+            "Proton",
+            "Steam Linux Runtime",
+            "Steamworks Common Redistributables",
+        };
+
+        for (const char* pPrefix : kToolNamePrefixes)
+        {
+            if (manifest.Name.rfind(pPrefix, 0) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // "Melty Blood: Type Lumina" -> "MBTL". Single-word names are used as-is.
+    std::string AliasFromName(const std::string& name)
+    {
+        std::string alias;
+        size_t numWords = 0;
+        bool atWordStart = true;
+        for (char c : name)
+        {
+            const unsigned char Character = static_cast<unsigned char>(c);
+            if (std::isalnum(Character))
+            {
+                if (atWordStart)
+                {
+                    alias.push_back(static_cast<char>(std::toupper(Character)));
+                    ++numWords;
+                }
+                atWordStart = false;
+            }
+            else if (c == ' ' || c == '-' || c == ':')
+            {
+                atWordStart = true;
+            }
+        }
+
+        return numWords > 1 ? alias : name;
+    }
+
+    // Install directories are stable and filesystem-safe, which is what we
+    // want for texture names.
+    std::string TexturePrefixFromInstallDir(const std::string& installDir)
+    {
+        std::string texturePrefix;
+        for (char c : installDir)
+        {
+            const unsigned char Character = static_cast<unsigned char>(c);
+            if (std::isalnum(Character))
+            {
+                texturePrefix.push_back(static_cast<char>(std::tolower(Character)));
+            }
+        }
+
+        return texturePrefix;
+    }
+
+    // Aliases key launch history, so a clash gets a number: "SF", "SF2", ...
+    std::string MakeUniqueAlias(const std::string& alias, const std::unordered_set<std::string>& knownAliases)
+    {
+        std::string uniqueAlias = alias;
+        for (uint32_t suffix = 2; knownAliases.count(uniqueAlias) > 0; ++suffix)
+        {
+            uniqueAlias = alias + std::to_string(suffix);
+        }
+
+        return uniqueAlias;
+    }
+
+    // A compatdata prefix only exists for apps Steam has run through Proton
+    bool UsesProton(const SteamAppManifest& manifest)
+    {
+        std::error_code errorCode;
+        return std::filesystem::is_directory(
+            std::filesystem::path(manifest.LibraryPath) / "steamapps" / "compatdata" / std::to_string(manifest.AppId),
+            errorCode);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    log::SetLogVerbosity(log::LogVerbosity::Info);
+    log::EnableZone(LOG_DEFAULT);
+
+    cli::CommandLineArgumentParser argumentParser(argc, argv);
+    const cli::CommandLineArgument* pSteamRootArgument = argumentParser.FindArgument("steam_root");
+    const cli::CommandLineArgument* pGamesDbArgument = argumentParser.FindArgument("gamesdb");
+    if (!pSteamRootArgument || !pGamesDbArgument)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Usage: %s --steam_root <path> --gamesdb <path> [--cache <path>] [--output <path>]",
+            argv[0]);
+        return -1;
+    }
+
+    const std::string GamesDbPath = pGamesDbArgument->AsString();
+    const cli::CommandLineArgument* pOutputArgument = argumentParser.FindArgument("output");
+    const std::string OutputPath = pOutputArgument ? pOutputArgument->AsString() : GamesDbPath;
+
+    SteamLibraryScanner scanner;
+    const cli::CommandLineArgument* pCacheArgument = argumentParser.FindArgument("cache");
+    if (pCacheArgument)
+    {
+        scanner.LoadCache(pCacheArgument->AsString());
+    }
+
+    std::vector<SteamAppManifest> apps;
+    if (!scanner.Scan(pSteamRootArgument->AsString(), &apps))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to scan Steam libraries");
+        return -1;
+    }
+
+    const SteamLibraryScanner::ScanStats& Stats = scanner.GetLastScanStats();
+    RELEASE_LOGLINE_INFO(
+        LOG_DEFAULT,
+        "Scanned %u libraries, %u manifests (%u parsed, %u cached, %u failed)",
+        Stats.NumLibraries, Stats.NumManifests, Stats.NumParsed, Stats.NumCached, Stats.NumFailed);
+
+    if (pCacheArgument)
+    {
+        scanner.SaveCache(pCacheArgument->AsString());
+    }
+
+    // Merge into the existing games DB. Existing entries are hand-maintained
+    // and are never modified; only games that aren't there yet are added.
+    json gamesDbData = { { "games", json::array() } };
+    if (std::filesystem::exists(GamesDbPath))
+    {
+        std::ifstream gamesDbIn(GamesDbPath);
+        gamesDbData = json::parse(gamesDbIn, nullptr, false /* allow_exceptions */);
+        if (gamesDbData.is_discarded())
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Games database is not valid JSON: %s", GamesDbPath.c_str());
+            return -1;
+        }
+
+        if (!gamesDbData.is_object() || !gamesDbData.contains("games") || !gamesDbData["games"].is_array())
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_DEFAULT,
+                "Games database missing required field 'games': %s",
+                GamesDbPath.c_str());
+            return -1;
+        }
+    }
+
+    json& gamesArray = gamesDbData["games"];
+    std::unordered_set<uint32_t> knownAppIds;
+    std::unordered_set<std::string> knownAliases;
+    for (const auto& gameEntry : gamesArray)
+    {
+        if (!gameEntry.is_object())
+        {
+            continue;
+        }
+
+        if (gameEntry.contains("steam_appid"))
+        {
+            const json& AppIdData = gameEntry["steam_appid"];
+            if (!AppIdData.is_number_unsigned() || AppIdData.get<uint64_t>() > UINT32_MAX)
+            {
+                // Can't tell whether the game is already there, so adding
+                // anything could duplicate it
+                RELEASE_LOGLINE_ERROR(
+                    LOG_DEFAULT,
+                    "Games database has an invalid 'steam_appid' (%s): %s",
+                    AppIdData.dump().c_str(),
+                    GamesDbPath.c_str());
+                return -1;
+            }
+            knownAppIds.insert(AppIdData.get<uint32_t>());
+        }
+
+        if (gameEntry.contains("alias") && gameEntry["alias"].is_string())
+        {
+            knownAliases.insert(gameEntry["alias"].get<std::string>());
+        }
+    }
+
+    uint32_t numAdded = 0;
+    for (const SteamAppManifest& app : apps)
+    {
+        if (!SteamLibraryScanner::IsInstalled(app) || IsSteamTool(app) || knownAppIds.count(app.AppId))
+        {
+            continue;
+        }
+
+        const std::string Alias = MakeUniqueAlias(AliasFromName(app.Name), knownAliases);
+        knownAliases.insert(Alias);
+        gamesArray.push_back({
+            { "title", app.Name },
+            { "alias", Alias },
+            { "steam_appid", app.AppId },
+            { "proton", UsesProton(app) },
+            // New entries need a human to vouch for them
+            { "supported", false },
+            { "texture_prefix", TexturePrefixFromInstallDir(app.InstallDir) },
+        });
+        ++numAdded;
+
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Added %s (%u)", app.Name.c_str(), app.AppId);
+    }
+
+    // Usually the hand-maintained games DB, so write-then-rename rather than
+    // risk truncating it with a failed write
+    const std::string TempPath = OutputPath + ".tmp";
+    {
+        std::ofstream gamesDbOut(TempPath, std::ios::trunc);
+        if (!gamesDbOut)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open output path: %s", TempPath.c_str());
+            return -1;
+        }
+
+        gamesDbOut << gamesDbData.dump(4) << std::endl;
+        if (!gamesDbOut)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write output path: %s", TempPath.c_str());
+            gamesDbOut.close();
+            std::error_code errorCode;
+            std::filesystem::remove(TempPath, errorCode);
+            return -1;
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(TempPath, OutputPath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Failed to move %s to %s: %s",
+            TempPath.c_str(),
+            OutputPath.c_str(),
+            errorCode.message().c_str());
+        return -1;
+    }
+
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Added %u games to %s", numAdded, OutputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,455 @@
+#include "steamlibraryscanner.h"
+#include "vdf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <json/json.hpp>
+
+#include <fivednine/log/log.h>
+
+using json = nlohmann::json;
+using namespace fivednine;
+
+namespace
+{
+    static constexpr uint32_t kCacheVersion = 1;
+
+    // See EAppState in the Steamworks SDK
+    static constexpr uint32_t kAppStateFullyInstalled = 4;
+
+    bool IsAppManifestPath(const std::filesystem::path& filePath)
+    {
+        const std::string FileName = filePath.filename().string();
+        return FileName.rfind("appmanifest_", 0) == 0 && filePath.extension() == ".acf";
+    }
+
+    bool IsUnsignedInteger(const std::string& text)
+    {
+        return !text.empty() &&
+            std::all_of(std::begin(text), std::end(text),
+                [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+    }
+
+    // Digits only, and fitting in 32 bits
+    bool ParseUint32(const std::string& text, uint32_t* pValueOut)
+    {
+        const char* pEnd = text.data() + text.size();
+        const std::from_chars_result Result = std::from_chars(text.data(), pEnd, *pValueOut);
+        return !text.empty() && Result.ec == std::errc() && Result.ptr == pEnd;
+    }
+
+    bool IsValidCacheEntry(const json& entry)
+    {
+        return entry.is_object() &&
+            entry.contains("path") && entry["path"].is_string() &&
+            entry.contains("mtime") && entry["mtime"].is_number_integer() &&
+            entry.contains("size") && entry["size"].is_number_unsigned() &&
+            entry.contains("appid") && entry["appid"].is_number_unsigned() &&
+            entry["appid"].get<uint64_t>() <= UINT32_MAX &&
+            entry.contains("name") && entry["name"].is_string() &&
+            entry.contains("installdir") && entry["installdir"].is_string() &&
+            entry.contains("library") && entry["library"].is_string() &&
+            entry.contains("state_flags") && entry["state_flags"].is_number_unsigned() &&
+            entry["state_flags"].get<uint64_t>() <= UINT32_MAX;
+    }
+
+    bool
+    ParseAppManifest(
+        const std::string& manifestPath,
+        const std::string& libraryPath,
+        SteamAppManifest* pManifestOut)
+    {
+        VdfNode root;
+        if (!ParseVdfFile(manifestPath, &root))
+        {
+            return false;
+        }
+
+        const VdfNode* pAppState = root.FindChild("AppState");
+        if (!pAppState || !pAppState->IsBlock())
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "App manifest is missing 'AppState': %s", manifestPath.c_str());
+            return false;
+        }
+
+        SteamAppManifest manifest;
+        const std::string* pAppId = pAppState->FindChildValue("appid");
+        if (!pAppId || !ParseUint32(*pAppId, &manifest.AppId))
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "App manifest has no valid 'appid': %s", manifestPath.c_str());
+            return false;
+        }
+        manifest.LibraryPath = libraryPath;
+
+        if (const std::string* pName = pAppState->FindChildValue("name"))
+        {
+            manifest.Name = *pName;
+        }
+
+        if (const std::string* pInstallDir = pAppState->FindChildValue("installdir"))
+        {
+            manifest.InstallDir = *pInstallDir;
+        }
+
+        const std::string* pStateFlags = pAppState->FindChildValue("StateFlags");
+        if (pStateFlags && !ParseUint32(*pStateFlags, &manifest.StateFlags))
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "App manifest has invalid 'StateFlags': %s", manifestPath.c_str());
+            return false;
+        }
+
+        *pManifestOut = std::move(manifest);
+        return true;
+    }
+}
+
+bool SteamLibraryScanner::LoadCache(const std::string& cachePath)
+{
+    m_cache.clear();
+
+    std::ifstream cacheIn(cachePath);
+    if (!cacheIn)
+    {
+        RELEASE_LOGLINE_INFO(LOG_DEFAULT, "No manifest cache at %s, scanning from scratch", cachePath.c_str());
+        return true;
+    }
+
+    json cacheData = json::parse(cacheIn, nullptr, false);
+    if (cacheData.is_discarded() ||
+        !cacheData.contains("version") ||
+        !cacheData["version"].is_number_unsigned() ||
+        cacheData["version"].get<uint32_t>() != kCacheVersion ||
+        !cacheData.contains("manifests") ||
+        !cacheData["manifests"].is_array())
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Ignoring stale or malformed manifest cache: %s", cachePath.c_str());
+        return false;
+    }
+
+    for (const auto& entry : cacheData["manifests"])
+    {
+        // The cache is only a shortcut, so any doubt about it means a full
+        // rescan rather than trusting part of it
+        if (!IsValidCacheEntry(entry))
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Ignoring malformed manifest cache: %s", cachePath.c_str());
+            m_cache.clear();
+            return false;
+        }
+
+        CacheEntry cacheEntry;
+        cacheEntry.ModifiedTime = entry["mtime"].get<int64_t>();
+        cacheEntry.FileSize = entry["size"].get<uint64_t>();
+        cacheEntry.Manifest.AppId = entry["appid"].get<uint32_t>();
+        cacheEntry.Manifest.Name = entry["name"].get<std::string>();
+        cacheEntry.Manifest.InstallDir = entry["installdir"].get<std::string>();
+        cacheEntry.Manifest.LibraryPath = entry["library"].get<std::string>();
+        cacheEntry.Manifest.StateFlags = entry["state_flags"].get<uint32_t>();
+        m_cache.emplace(entry["path"].get<std::string>(), std::move(cacheEntry));
+    }
+
+    return true;
+}
+
+bool SteamLibraryScanner::SaveCache(const std::string& cachePath) const
+{
+    json manifests = json::array();
+    for (const auto& [path, cacheEntry] : m_cache)
+    {
+        manifests.push_back({
+            { "path", path },
+            { "mtime", cacheEntry.ModifiedTime },
+            { "size", cacheEntry.FileSize },
+            { "appid", cacheEntry.Manifest.AppId },
+            { "name", cacheEntry.Manifest.Name },
+            { "installdir", cacheEntry.Manifest.InstallDir },
+            { "library", cacheEntry.Manifest.LibraryPath },
+            { "state_flags", cacheEntry.Manifest.StateFlags },
+        });
+    }
+
+    // Write-then-rename so an interrupted save never leaves a torn cache
+    const std::string TempPath = cachePath + ".tmp";
+    {
+        std::ofstream cacheOut(TempPath, std::ios::trunc);
+        if (!cacheOut)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write manifest cache: %s", TempPath.c_str());
+            return false;
+        }
+
+        json cacheData = { { "version", kCacheVersion }, { "manifests", std::move(manifests) } };
+        cacheOut << cacheData.dump() << std::flush;
+        if (!cacheOut)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write manifest cache: %s", TempPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(TempPath, cachePath, errorCode);
+    if (errorCode)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_DEFAULT,
+            "Failed to replace manifest cache %s: %s",
+            cachePath.c_str(),
+            errorCode.message().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool SteamLibraryScanner::Scan(const std::string& steamRootPath, std::vector<SteamAppManifest>* pAppsOut)
+{
+    if (!pAppsOut)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "pAppsOut cannot be null");
+        return false;
+    }
+    pAppsOut->clear();
+    m_lastScanStats = ScanStats();
+
+    if (!std::filesystem::is_directory(steamRootPath))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Steam root is not a directory: %s", steamRootPath.c_str());
+        return false;
+    }
+
+    // Gather manifest paths along with the metadata the cache is keyed on
+    struct ManifestFile
+    {
+        std::string Path;
+        std::string LibraryPath;
+        int64_t     ModifiedTime = 0;
+        uint64_t    FileSize = 0;
+    };
+    std::vector<ManifestFile> manifestFiles;
+
+    const std::vector<std::string> LibraryPaths = FindLibraryPaths(steamRootPath);
+    m_lastScanStats.NumLibraries = static_cast<uint32_t>(LibraryPaths.size());
+    for (const std::string& libraryPath : LibraryPaths)
+    {
+        const std::filesystem::path SteamAppsPath = std::filesystem::path(libraryPath) / "steamapps";
+
+        std::error_code errorCode;
+        std::filesystem::directory_iterator directoryIterator(SteamAppsPath, errorCode);
+        if (errorCode)
+        {
+            // Unmounted drives are common; keep going.
+            RELEASE_LOGLINE_WARNING(
+                LOG_DEFAULT,
+                "Skipping unreadable Steam library %s: %s",
+                SteamAppsPath.c_str(),
+                errorCode.message().c_str());
+            continue;
+        }
+
+        for (const auto& directoryEntry : directoryIterator)
+        {
+            const std::filesystem::path FilePath = directoryEntry.path();
+            if (!IsAppManifestPath(FilePath) || !directoryEntry.is_regular_file(errorCode))
+            {
+                continue;
+            }
+
+            ManifestFile manifestFile;
+            manifestFile.Path = FilePath.string();
+            manifestFile.LibraryPath = libraryPath;
+            manifestFile.ModifiedTime = directoryEntry.last_write_time(errorCode).time_since_epoch().count();
+            manifestFile.FileSize = directoryEntry.file_size(errorCode);
+            manifestFiles.push_back(std::move(manifestFile));
+        }
+    }
+    m_lastScanStats.NumManifests = static_cast<uint32_t>(manifestFiles.size());
+
+    // Anything that doesn't match the cache gets parsed
+    std::vector<size_t> pendingIndices;
+    for (size_t i = 0; i < manifestFiles.size(); ++i)
+    {
+        auto it = m_cache.find(manifestFiles[i].Path);
+        if (it == std::end(m_cache) ||
+            it->second.ModifiedTime != manifestFiles[i].ModifiedTime ||
+            it->second.FileSize != manifestFiles[i].FileSize ||
+            it->second.Manifest.LibraryPath != manifestFiles[i].LibraryPath)
+        {
+            pendingIndices.push_back(i);
+        }
+    }
+
+    // Parse in parallel. Each worker claims the next pending file and writes
+    // only to its own result slot, so no locking is needed.
+    struct ParseResult
+    {
+        bool             Succeeded = false;
+        SteamAppManifest Manifest;
+    };
+    std::vector<ParseResult> parseResults(pendingIndices.size());
+    std::atomic<size_t> nextPendingIndex(0);
+    auto parseWorker = [&]()
+    {
+        while (true)
+        {
+            const size_t ResultIndex = nextPendingIndex.fetch_add(1, std::memory_order_relaxed);
+            if (ResultIndex >= pendingIndices.size())
+            {
+                return;
+            }
+
+            const ManifestFile& File = manifestFiles[pendingIndices[ResultIndex]];
+            ParseResult& result = parseResults[ResultIndex];
+            result.Succeeded = ParseAppManifest(File.Path, File.LibraryPath, &result.Manifest);
+        }
+    };
+
+    const size_t NumWorkers = std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()),
+        pendingIndices.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < NumWorkers; ++i)
+    {
+        workers.emplace_back(parseWorker);
+    }
+    parseWorker();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    // Rebuild the cache so manifests which disappeared are dropped
+    std::unordered_map<std::string, CacheEntry> newCache;
+    newCache.reserve(manifestFiles.size());
+    for (size_t i = 0, pending = 0; i < manifestFiles.size(); ++i)
+    {
+        const ManifestFile& File = manifestFiles[i];
+        if (pending < pendingIndices.size() && pendingIndices[pending] == i)
+        {
+            ParseResult& result = parseResults[pending++];
+            if (!result.Succeeded)
+            {
+                ++m_lastScanStats.NumFailed;
+                continue;
+            }
+
+            CacheEntry cacheEntry;
+            cacheEntry.ModifiedTime = File.ModifiedTime;
+            cacheEntry.FileSize = File.FileSize;
+            cacheEntry.Manifest = std::move(result.Manifest);
+            newCache.emplace(File.Path, std::move(cacheEntry));
+            ++m_lastScanStats.NumParsed;
+        }
+        else
+        {
+            newCache.emplace(File.Path, std::move(m_cache[File.Path]));
+            ++m_lastScanStats.NumCached;
+        }
+
+        pAppsOut->push_back(newCache[File.Path].Manifest);
+    }
+    m_cache = std::move(newCache);
+
+    // The same app can show up in more than one library after a move; keep
+    // the first one found.
+    std::stable_sort(std::begin(*pAppsOut), std::end(*pAppsOut),
+        [](const SteamAppManifest& lhs, const SteamAppManifest& rhs)
+        {
+            return lhs.AppId < rhs.AppId;
+        });
+    pAppsOut->erase(
+        std::unique(std::begin(*pAppsOut), std::end(*pAppsOut),
+            [](const SteamAppManifest& lhs, const SteamAppManifest& rhs)
+            {
+                return lhs.AppId == rhs.AppId;
+            }),
+        std::end(*pAppsOut));
+
+    return true;
+}
+
+const SteamLibraryScanner::ScanStats& SteamLibraryScanner::GetLastScanStats() const
+{
+    return m_lastScanStats;
+}
+
+bool SteamLibraryScanner::IsInstalled(const SteamAppManifest& manifest)
+{
+    return (manifest.StateFlags & kAppStateFullyInstalled) != 0;
+}
+
+std::vector<std::string> SteamLibraryScanner::FindLibraryPaths(const std::string& steamRootPath) const
+{
+    std::vector<std::string> libraryPaths;
+    auto addLibraryPath = [&libraryPaths](const std::string& libraryPath)
+    {
+        std::error_code errorCode;
+        std::string normalizedPath = std::filesystem::weakly_canonical(libraryPath, errorCode).string();
+        if (errorCode)
+        {
+            normalizedPath = libraryPath;
+        }
+
+        if (std::find(std::begin(libraryPaths), std::end(libraryPaths), normalizedPath) == std::end(libraryPaths))
+        {
+            libraryPaths.push_back(normalizedPath);
+        }
+    };
+
+    // The Steam root is always a library, even if it isn't listed
+    addLibraryPath(steamRootPath);
+
+    const std::filesystem::path LibraryFoldersPath =
+        std::filesystem::path(steamRootPath) / "steamapps" / "libraryfolders.vdf";
+    if (!std::filesystem::exists(LibraryFoldersPath))
+    {
+        return libraryPaths;
+    }
+
+    VdfNode root;
+    if (!ParseVdfFile(LibraryFoldersPath.string(), &root))
+    {
+        return libraryPaths;
+    }
+
+    const VdfNode* pLibraryFolders = root.FindChild("libraryfolders");
+    if (!pLibraryFolders || !pLibraryFolders->IsBlock())
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_DEFAULT,
+            "Missing 'libraryfolders' block in %s",
+            LibraryFoldersPath.c_str());
+        return libraryPaths;
+    }
+
+    for (const VdfNode& folder : pLibraryFolders->GetChildren())
+    {
+        // Libraries are numbered; other keys are bookkeeping
+        if (!IsUnsignedInteger(folder.GetKey()))
+        {
+            continue;
+        }
+
+        if (folder.IsBlock())
+        {
+            // Current format: "0" { "path" "..." ... }
+            if (const std::string* pPath = folder.FindChildValue("path"))
+            {
+                addLibraryPath(*pPath);
+            }
+        }
+        else
+        {
+            // Legacy format: "1" "/path/to/library"
+            addLibraryPath(folder.GetValue());
+        }
+    }
+
+    return libraryPaths;
+}
@@ -0,0 +1,58 @@
+// steamlibraryscanner.h
+//
+// Finds installed Steam apps by walking libraryfolders.vdf and each library's
+// appmanifest_*.acf files. Parsed manifests are cached by path, keyed on
+// modification time and size, so rescans only parse files which changed.
+// Works entirely against the local filesystem.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SteamAppManifest
+{
+    uint32_t    AppId = 0;
+    std::string Name;
+    std::string InstallDir;
+    std::string LibraryPath;
+    uint32_t    StateFlags = 0;
+};
+
+class SteamLibraryScanner
+{
+public:
+    struct ScanStats
+    {
+        uint32_t NumLibraries = 0;
+        uint32_t NumManifests = 0;
+        uint32_t NumParsed = 0;
+        uint32_t NumCached = 0;
+        uint32_t NumFailed = 0;
+    };
+
+    // Missing cache files are not an error; everything will be parsed.
+    bool LoadCache(const std::string& cachePath);
+    bool SaveCache(const std::string& cachePath) const;
+
+    bool Scan(const std::string& steamRootPath, std::vector<SteamAppManifest>* pAppsOut);
+
+    const ScanStats& GetLastScanStats() const;
+
+    static bool IsInstalled(const SteamAppManifest& manifest);
+
+private:
+    struct CacheEntry
+    {
+        int64_t          ModifiedTime = 0;
+        uint64_t         FileSize = 0;
+        SteamAppManifest Manifest;
+    };
+
+    std::vector<std::string> FindLibraryPaths(const std::string& steamRootPath) const;
+
+    std::unordered_map<std::string, CacheEntry> m_cache;
+    ScanStats                                   m_lastScanStats;
+};
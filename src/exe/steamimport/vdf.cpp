@@ -0,0 +1,228 @@
+#include "vdf.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <strings.h>
+
+#include <fivednine/log/log.h>
+
+using namespace fivednine;
+
+class VdfParser
+{
+public:
+    VdfParser(const char* pText, size_t textLength)
+        : m_pCurrent(pText), m_pEnd(pText + textLength) {}
+
+    bool ParseBlockContents(VdfNode* pBlock, bool isRoot)
+    {
+        pBlock->m_isBlock = true;
+        while (true)
+        {
+            SkipWhitespaceAndComments();
+            if (m_pCurrent >= m_pEnd)
+            {
+                if (!isRoot)
+                {
+                    RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "VDF: unexpected end of input in block '%s'", pBlock->m_key.c_str());
+                    return false;
+                }
+                return true;
+            }
+
+            if (*m_pCurrent == '}')
+            {
+                if (isRoot)
+                {
+                    RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "VDF: unbalanced '}'");
+                    return false;
+                }
+                ++m_pCurrent;
+                return true;
+            }
+
+            VdfNode child;
+            if (!ReadToken(&child.m_key))
+            {
+                return false;
+            }
+
+            SkipWhitespaceAndComments();
+            if (m_pCurrent >= m_pEnd)
+            {
+                RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "VDF: key '%s' has no value", child.m_key.c_str());
+                return false;
+            }
+
+            if (*m_pCurrent == '{')
+            {
+                ++m_pCurrent;
+                if (!ParseBlockContents(&child, false))
+                {
+                    return false;
+                }
+            }
+            else if (!ReadToken(&child.m_value))
+            {
+                return false;
+            }
+
+            pBlock->m_children.push_back(std::move(child));
+        }
+    }
+
+private:
+    void SkipWhitespaceAndComments()
+    {
+        while (m_pCurrent < m_pEnd)
+        {
+            if (std::isspace(static_cast<unsigned char>(*m_pCurrent)))
+            {
+                ++m_pCurrent;
+            }
+            else if (*m_pCurrent == '/' && (m_pCurrent + 1) < m_pEnd && m_pCurrent[1] == '/')
+            {
+                while (m_pCurrent < m_pEnd && *m_pCurrent != '\n')
+                {
+                    ++m_pCurrent;
+                }
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    bool ReadToken(std::string* pTokenOut)
+    {
+        pTokenOut->clear();
+        if (*m_pCurrent == '"')
+        {
+            ++m_pCurrent;
+            while (m_pCurrent < m_pEnd && *m_pCurrent != '"')
+            {
+                if (*m_pCurrent == '\\' && (m_pCurrent + 1) < m_pEnd)
+                {
+                    ++m_pCurrent;
+                    switch (*m_pCurrent)
+                    {
+                        case 'n': pTokenOut->push_back('\n'); break;
+                        case 't': pTokenOut->push_back('\t'); break;
+                        default:  pTokenOut->push_back(*m_pCurrent); break;
+                    }
+                }
+                else
+                {
+                    pTokenOut->push_back(*m_pCurrent);
+                }
+                ++m_pCurrent;
+            }
+
+            if (m_pCurrent >= m_pEnd)
+            {
+                RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "VDF: unterminated string");
+                return false;
+            }
+
+            // Closing quote
+            ++m_pCurrent;
+            return true;
+        }
+
+        // Bare token
+        while (m_pCurrent < m_pEnd &&
+               !std::isspace(static_cast<unsigned char>(*m_pCurrent)) &&
+               *m_pCurrent != '{' && *m_pCurrent != '}' && *m_pCurrent != '"')
+        {
+            pTokenOut->push_back(*m_pCurrent);
+            ++m_pCurrent;
+        }
+
+        if (pTokenOut->empty())
+        {
+            RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "VDF: unexpected character '%c'", *m_pCurrent);
+            return false;
+        }
+
+        return true;
+    }
+
+    const char* m_pCurrent;
+    const char* m_pEnd;
+};
+
+const std::string& VdfNode::GetKey() const
+{
+    return m_key;
+}
+
+const std::string& VdfNode::GetValue() const
+{
+    return m_value;
+}
+
+bool VdfNode::IsBlock() const
+{
+    return m_isBlock;
+}
+
+const std::vector<VdfNode>& VdfNode::GetChildren() const
+{
+    return m_children;
+}
+
+const VdfNode* VdfNode::FindChild(const char* pKey) const
+{
+    for (const VdfNode& child : m_children)
+    {
+        if (strcasecmp(child.m_key.c_str(), pKey) == 0)
+        {
+            return &child;
+        }
+    }
+
+    return nullptr;
+}
+
+const std::string* VdfNode::FindChildValue(const char* pKey) const
+{
+    const VdfNode* pChild = FindChild(pKey);
+    if (!pChild || pChild->IsBlock())
+    {
+        return nullptr;
+    }
+
+    return &pChild->m_value;
+}
+
+bool ParseVdf(const char* pText, size_t textLength, VdfNode* pRootOut)
+{
+    *pRootOut = VdfNode();
+
+    VdfParser parser(pText, textLength);
+    return parser.ParseBlockContents(pRootOut, true);
+}
+
+bool ParseVdfFile(const std::string& filePath, VdfNode* pRootOut)
+{
+    std::ifstream in(filePath, std::ios::binary);
+    if (!in)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Failed to open VDF file: %s", filePath.c_str());
+        return false;
+    }
+
+    std::stringstream textStream;
+    textStream << in.rdbuf();
+    const std::string Text = textStream.str();
+    if (!ParseVdf(Text.data(), Text.size(), pRootOut))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_DEFAULT, "Failed to parse VDF file: %s", filePath.c_str());
+        return false;
+    }
+
+    return true;
+}
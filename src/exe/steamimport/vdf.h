@@ -0,0 +1,37 @@
+// vdf.h
+//
+// Minimal parser for Valve's text KeyValues format, as used by Steam's
+// libraryfolders.vdf and appmanifest_*.acf files. Only what those files need
+// is supported: quoted or bare tokens, nested blocks and // comments.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class VdfNode
+{
+public:
+    const std::string& GetKey() const;
+    const std::string& GetValue() const;
+    bool IsBlock() const;
+
+    const std::vector<VdfNode>& GetChildren() const;
+
+    // Keys are matched case-insensitively; Steam isn't consistent about case.
+    const VdfNode* FindChild(const char* pKey) const;
+    const std::string* FindChildValue(const char* pKey) const;
+
+private:
+    friend class VdfParser;
+
+    std::string          m_key;
+    std::string          m_value;
+    bool                 m_isBlock = false;
+    std::vector<VdfNode> m_children;
+};
+
+// Parses text into a root block whose children are the file's top-level keys.
+bool ParseVdf(const char* pText, size_t textLength, VdfNode* pRootOut);
+bool ParseVdfFile(const std::string& filePath, VdfNode* pRootOut);
@@ -1,5 +1,7 @@
 #include "cliargument.h"
 
+#include <charconv>
+
 using namespace fivednine;
 using namespace fivednine::cli;
 
@@ -15,4 +17,35 @@ std::string CommandLineArgument::AsString() const
 {
     // ha ha !! you fool!! it is already a string !!!
     return m_value;
-}
\ No newline at end of file
+}
+
+bool CommandLineArgument::AsUint32(uint32_t* pValueOut) const
+{
+    uint32_t value;
+    const char* pEnd = m_value.data() + m_value.size();
+    const std::from_chars_result Result = std::from_chars(m_value.data(), pEnd, value);
+    if (Result.ec != std::errc() || Result.ptr != pEnd)
+    {
+        return false;
+    }
+
+    *pValueOut = value;
+    return true;
+}
+
+bool CommandLineArgument::AsBool(bool* pValueOut) const
+{
+    if (m_value == "true" || m_value == "1")
+    {
+        *pValueOut = true;
+        return true;
+    }
+
+    if (m_value == "false" || m_value == "0")
+    {
+        *pValueOut = false;
+        return true;
+    }
+
+    return false;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace fivednine { namespace cli {
@@ -12,6 +13,11 @@ namespace fivednine { namespace cli {
 
         std::string AsString() const;
 
+        // Return false (and leave the output untouched) if the value doesn't
+        // parse. Booleans accept true/false and 1/0.
+        bool AsUint32(uint32_t* pValueOut) const;
+        bool AsBool(bool* pValueOut) const;
+
     private:
         const std::string m_name;
         const std::string m_value;
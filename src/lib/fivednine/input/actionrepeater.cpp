@@ -0,0 +1,75 @@
+#include "actionrepeater.h"
+
+#include <algorithm>
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+void ActionRepeater::SetSettings(const RepeatSettings& settings)
+{
+    m_settings = settings;
+}
+
+void ActionRepeater::OnInputEvent(const InputEvent& event)
+{
+    if (event.IsPressed)
+    {
+        Reset();
+        if (IsRepeatableAction(event.ActionType))
+        {
+            m_heldAction = event.ActionType;
+        }
+    }
+    else if (event.ActionType == m_heldAction)
+    {
+        Reset();
+    }
+}
+
+void ActionRepeater::Reset()
+{
+    m_heldAction = ActionType::None;
+    m_heldSeconds = 0.f;
+    m_pendingRepeats = 0.f;
+}
+
+bool ActionRepeater::IsRepeating() const
+{
+    return m_heldAction != ActionType::None;
+}
+
+uint32_t ActionRepeater::Tick(float dtSeconds, ActionType* pActionTypeOut)
+{
+    if (m_heldAction == ActionType::None)
+    {
+        return 0;
+    }
+
+    const float PreviousHeldSeconds = m_heldSeconds;
+    m_heldSeconds += dtSeconds;
+    if (m_heldSeconds <= m_settings.DelaySeconds)
+    {
+        return 0;
+    }
+
+    // Repeats begin at the end of the delay; integrate the rate, which
+    // ramps linearly, over the part of this step past it
+    const float RepeatStart = std::max(PreviousHeldSeconds, m_settings.DelaySeconds) - m_settings.DelaySeconds;
+    const float RepeatEnd = m_heldSeconds - m_settings.DelaySeconds;
+    const float MidpointSeconds = (RepeatStart + RepeatEnd) * 0.5f;
+    const float Acceleration = m_settings.AccelerationSeconds > 0.f ?
+        std::min(1.f, MidpointSeconds / m_settings.AccelerationSeconds) : 1.f;
+    const float RateHz = m_settings.InitialRateHz + (m_settings.MaxRateHz - m_settings.InitialRateHz) * Acceleration;
+
+    // The first repeat fires as soon as the delay is over
+    if (PreviousHeldSeconds <= m_settings.DelaySeconds)
+    {
+        m_pendingRepeats = 1.f;
+    }
+    m_pendingRepeats += RateHz * (RepeatEnd - RepeatStart);
+
+    const uint32_t NumRepeats = static_cast<uint32_t>(m_pendingRepeats);
+    m_pendingRepeats -= static_cast<float>(NumRepeats);
+    *pActionTypeOut = m_heldAction;
+    return NumRepeats;
+}
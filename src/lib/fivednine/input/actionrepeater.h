@@ -0,0 +1,53 @@
+// actionrepeater.h
+//
+// Hold-to-repeat for navigation actions. After an initial delay the held
+// action repeats, slowly at first so that single steps are easy to hit,
+// then faster the longer it's held, so that a held stick crosses a library
+// of a thousand games in a few seconds. Driven by simulation time rather
+// than the wall clock, so replayed input repeats exactly as it did live.
+//
+// Like a keyboard, only the most recently pressed action repeats, and any
+// other press stops it.
+
+#pragma once
+
+#include <cstdint>
+
+#include "inputevent.h"
+
+namespace fivednine { namespace input {
+    struct RepeatSettings
+    {
+        float DelaySeconds = 0.35f;
+        float InitialRateHz = 8.f;
+        float MaxRateHz = 200.f;
+
+        // Time held, after the delay, to go from the initial rate to the max
+        float AccelerationSeconds = 2.f;
+    };
+
+    class ActionRepeater
+    {
+    public:
+        void SetSettings(const RepeatSettings& settings);
+
+        void OnInputEvent(const InputEvent& event);
+
+        // Forgets the held action, e.g. when input is taken over by a replay
+        void Reset();
+
+        bool IsRepeating() const;
+
+        // Advances by dtSeconds and returns how many repeats of the held
+        // action are due, which can be more than one per step at high rates
+        uint32_t Tick(float dtSeconds, ActionType* pActionTypeOut);
+
+    private:
+        RepeatSettings m_settings;
+        ActionType     m_heldAction = ActionType::None;
+        float          m_heldSeconds = 0.f;
+
+        // Fractional repeats carried to the next tick
+        float          m_pendingRepeats = 0.f;
+    };
+}}
@@ -0,0 +1,270 @@
+#include "evdevdevice.h"
+#include "inputmapping.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <fivednine/log/log.h>
+#include <fivednine/system/time.h>
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+namespace
+{
+    static constexpr size_t kBitsPerLong = sizeof(unsigned long) * CHAR_BIT;
+
+    // Reads per read() call; a burst larger than this just takes another
+    static constexpr size_t kMaxEventsPerRead = 64;
+
+    bool TestBit(const unsigned long* pBits, uint32_t bit)
+    {
+        return (pBits[bit / kBitsPerLong] >> (bit % kBitsPerLong)) & 1ul;
+    }
+
+    // As udev decides: a keyboard has every key from Esc through D, which
+    // encoder boards and pads don't
+    bool IsKeyboard(const unsigned long* pKeyBits)
+    {
+        for (uint32_t key = KEY_ESC; key <= KEY_D; ++key)
+        {
+            if (!TestBit(pKeyBits, key))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+EvdevDevice::~EvdevDevice()
+{
+    Close();
+}
+
+bool
+EvdevDevice::Open(
+    const std::string& devicePath,
+    uint32_t deviceIndex,
+    const InputMapping& inputMapping,
+    bool areKeyboardsAllowed)
+{
+    Close();
+
+    const int FileDescriptor = open(devicePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (FileDescriptor < 0)
+    {
+        RELEASE_LOGLINE_VERBOSE(LOG_INPUT, "Can't open %s: %s", devicePath.c_str(), strerror(errno));
+        return false;
+    }
+
+    char name[256] = {};
+    if (ioctl(FileDescriptor, EVIOCGNAME(sizeof(name) - 1), name) < 0)
+    {
+        strncpy(name, "unknown", sizeof(name) - 1);
+    }
+
+    unsigned long keyBits[KEY_CNT / kBitsPerLong + 1] = {};
+    unsigned long absBits[ABS_CNT / kBitsPerLong + 1] = {};
+    ioctl(FileDescriptor, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits);
+    ioctl(FileDescriptor, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+
+    if (!areKeyboardsAllowed && IsKeyboard(keyBits))
+    {
+        RELEASE_LOGLINE_VERBOSE(LOG_INPUT, "Skipping %s (%s): keyboard", devicePath.c_str(), name);
+        close(FileDescriptor);
+        return false;
+    }
+
+    // Touchpads and tablets report absolute axes too, but as a position
+    const bool IsPointer = TestBit(keyBits, BTN_TOUCH) || TestBit(keyBits, BTN_TOOL_PEN);
+
+    const DeviceMapping& Mapping = inputMapping.FindDeviceMapping(InputSource::Evdev, name);
+    bool hasMappedKey = false;
+    m_numAxisRanges = 0;
+    for (const DeviceMapping::ControlAction& ControlAction : Mapping.GetControlActions())
+    {
+        if (ControlAction.ControlCode <= KEY_MAX)
+        {
+            hasMappedKey = hasMappedKey || TestBit(keyBits, ControlAction.ControlCode);
+            continue;
+        }
+
+        // Both directions of an axis are mapped separately; set it up once
+        uint32_t axisCode = 0;
+        const bool IsAxisKnown = AxisFromControlCode(ControlAction.ControlCode, &axisCode) && axisCode <= ABS_MAX;
+
+        bool isAxisSetUp = false;
+        for (size_t i = 0; i < m_numAxisRanges; ++i)
+        {
+            isAxisSetUp = isAxisSetUp || m_axisRanges[i].Code == axisCode;
+        }
+
+        struct input_absinfo absInfo;
+        if (!IsAxisKnown ||
+            isAxisSetUp ||
+            IsPointer ||
+            m_numAxisRanges == InputDeviceState::kMaxAxes ||
+            !TestBit(absBits, axisCode) ||
+            ioctl(FileDescriptor, EVIOCGABS(axisCode), &absInfo) < 0 ||
+            absInfo.maximum <= absInfo.minimum)
+        {
+            continue;
+        }
+
+        // Digital sticks and hats sit at the extremes; analog sticks count
+        // once they're past halfway
+        const int32_t Range = absInfo.maximum - absInfo.minimum;
+        AxisRange& axisRange = m_axisRanges[m_numAxisRanges++];
+        axisRange.Code = static_cast<uint16_t>(axisCode);
+        axisRange.LowThreshold = absInfo.minimum + Range / 4;
+        axisRange.HighThreshold = absInfo.maximum - Range / 4;
+    }
+
+    if (!hasMappedKey && m_numAxisRanges == 0)
+    {
+        RELEASE_LOGLINE_VERBOSE(LOG_INPUT, "Skipping %s (%s): no mapped keys or axes", devicePath.c_str(), name);
+        close(FileDescriptor);
+        return false;
+    }
+
+    int clockId = CLOCK_MONOTONIC;
+    m_hasMonotonicTimestamps = ioctl(FileDescriptor, EVIOCSCLOCKID, &clockId) == 0;
+
+    m_fileDescriptor = FileDescriptor;
+    m_path = devicePath;
+    m_name = name;
+    m_isDroppingUntilReport = false;
+    m_deviceState.Initialize(&Mapping, deviceIndex);
+
+    RELEASE_LOGLINE_INFO(LOG_INPUT, "Opened input device %s (%s)", m_path.c_str(), m_name.c_str());
+    return true;
+}
+
+void EvdevDevice::Close()
+{
+    if (m_fileDescriptor >= 0)
+    {
+        close(m_fileDescriptor);
+        m_fileDescriptor = -1;
+    }
+
+    m_numAxisRanges = 0;
+}
+
+bool EvdevDevice::IsOpen() const
+{
+    return m_fileDescriptor >= 0;
+}
+
+int EvdevDevice::GetFileDescriptor() const
+{
+    return m_fileDescriptor;
+}
+
+const std::string& EvdevDevice::GetPath() const
+{
+    return m_path;
+}
+
+const std::string& EvdevDevice::GetName() const
+{
+    return m_name;
+}
+
+bool EvdevDevice::ReadEvents(FnInputEventHandler pfnHandler, void* pUserPointer)
+{
+    struct input_event rawEvents[kMaxEventsPerRead];
+    while (true)
+    {
+        const ssize_t NumBytesRead = read(m_fileDescriptor, rawEvents, sizeof(rawEvents));
+        if (NumBytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // EAGAIN: drained. Anything else (ENODEV once unplugged) means
+            // the device is gone.
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        if (NumBytesRead == 0)
+        {
+            return false;
+        }
+
+        const size_t NumEvents = static_cast<size_t>(NumBytesRead) / sizeof(struct input_event);
+        const uint64_t ReadNs = system::time::GetTicksNs();
+        for (size_t i = 0; i < NumEvents; ++i)
+        {
+            const struct input_event& RawEvent = rawEvents[i];
+            if (RawEvent.type == EV_SYN)
+            {
+                if (RawEvent.code == SYN_DROPPED)
+                {
+                    RELEASE_LOGLINE_WARNING(LOG_INPUT, "Input device %s overflowed; events were lost", m_path.c_str());
+                    m_isDroppingUntilReport = true;
+                }
+                else if (RawEvent.code == SYN_REPORT)
+                {
+                    m_isDroppingUntilReport = false;
+                }
+                continue;
+            }
+
+            if (m_isDroppingUntilReport)
+            {
+                continue;
+            }
+
+            const uint64_t TimestampNs = m_hasMonotonicTimestamps ?
+                static_cast<uint64_t>(RawEvent.input_event_sec) * system::time::kNanosecondsPerSecond +
+                    static_cast<uint64_t>(RawEvent.input_event_usec) * 1000ull :
+                ReadNs;
+
+            if (RawEvent.type == EV_KEY)
+            {
+                // 0 is release, 1 press and 2 autorepeat, which is left to
+                // the action repeater
+                if (RawEvent.value != 2)
+                {
+                    m_deviceState.OnControl(RawEvent.code, RawEvent.value != 0, TimestampNs, pfnHandler, pUserPointer);
+                }
+            }
+            else if (RawEvent.type == EV_ABS)
+            {
+                for (size_t axisIndex = 0; axisIndex < m_numAxisRanges; ++axisIndex)
+                {
+                    const AxisRange& Range = m_axisRanges[axisIndex];
+                    if (Range.Code == RawEvent.code)
+                    {
+                        m_deviceState.OnAxis(
+                            Range.Code,
+                            RawEvent.value,
+                            Range.LowThreshold,
+                            Range.HighThreshold,
+                            TimestampNs,
+                            pfnHandler,
+                            pUserPointer);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void EvdevDevice::ReleaseAll(FnInputEventHandler pfnHandler, void* pUserPointer)
+{
+    m_deviceState.ReleaseAll(system::time::GetTicksNs(), pfnHandler, pUserPointer);
+}
@@ -0,0 +1,75 @@
+// evdevdevice.h
+//
+// A Linux input device (/dev/input/event*) read directly rather than through
+// the window system: keyboards, arcade sticks and encoder boards, pads.
+// Keys, buttons, and stick and hat directions are translated into actions
+// through the device's mapping (see inputmapping.h). The kernel is asked to
+// stamp events with CLOCK_MONOTONIC, the clock system::time uses, so
+// timestamps reflect when the device reported the event rather than when it
+// was read.
+
+#pragma once
+
+#include "inputdevicestate.h"
+#include "inputevent.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fivednine { namespace input {
+    class InputMapping;
+
+    class EvdevDevice
+    {
+    public:
+        ~EvdevDevice();
+
+        // Opens the device non-blocking. Fails if it can't be opened (often
+        // permissions; see the input group) or has nothing its mapping
+        // translates, e.g. mice and touchpads with the default mapping. Also
+        // fails for full keyboards unless areKeyboardsAllowed.
+        bool
+        Open(
+            const std::string& devicePath,
+            uint32_t deviceIndex,
+            const InputMapping& inputMapping,
+            bool areKeyboardsAllowed);
+        void Close();
+
+        bool IsOpen() const;
+        int GetFileDescriptor() const;
+        const std::string& GetPath() const;
+        const std::string& GetName() const;
+
+        // Reads everything pending without blocking, calling pfnHandler for
+        // each action pressed or released. Key autorepeat is ignored; see
+        // actionrepeater.h. Returns false once the device is gone.
+        bool ReadEvents(FnInputEventHandler pfnHandler, void* pUserPointer);
+
+        // Releases any actions still held, e.g. once the device is gone
+        void ReleaseAll(FnInputEventHandler pfnHandler, void* pUserPointer);
+
+    private:
+        int              m_fileDescriptor = -1;
+        std::string      m_path;
+        std::string      m_name;
+        bool             m_hasMonotonicTimestamps = false;
+        InputDeviceState m_deviceState;
+
+        // Events between a SYN_DROPPED and the next SYN_REPORT are
+        // incomplete and skipped
+        bool             m_isDroppingUntilReport = false;
+
+        // Mapped axes the device has, and the values either side of which
+        // they count as pushed
+        struct AxisRange
+        {
+            uint16_t Code = 0;
+            int32_t  LowThreshold = 0;
+            int32_t  HighThreshold = 0;
+        };
+        AxisRange m_axisRanges[InputDeviceState::kMaxAxes];
+        size_t    m_numAxisRanges = 0;
+    };
+}}
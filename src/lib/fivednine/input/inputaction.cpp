@@ -0,0 +1,66 @@
+#include "inputaction.h"
+
+#include <cstddef>
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+namespace
+{
+    static constexpr size_t kNumActions = static_cast<size_t>(ActionType::Max);
+}
+
+bool fivednine::input::IsRepeatableAction(ActionType actionType)
+{
+    switch (actionType)
+    {
+        case ActionType::Previous:
+        case ActionType::Next:
+        case ActionType::PagePrevious:
+        case ActionType::PageNext:
+        case ActionType::Search:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* fivednine::input::ActionToString(ActionType actionType)
+{
+    static const char* LUT[] = {
+        "none",
+        "previous",
+        "next",
+        "page_previous",
+        "page_next",
+        "confirm",
+        "search",
+        "next_library_view",
+        "toggle_overlay",
+        "quit",
+    };
+
+    static_assert(sizeof(LUT) / sizeof(LUT[0]) == kNumActions, "Action LUT size does not match enum");
+
+    if (actionType >= ActionType::Max)
+    {
+        return "invalid";
+    }
+
+    return LUT[static_cast<size_t>(actionType)];
+}
+
+bool fivednine::input::ActionFromString(const std::string& actionName, ActionType* pActionTypeOut)
+{
+    for (size_t i = 0; i < kNumActions; ++i)
+    {
+        const ActionType Action = static_cast<ActionType>(i);
+        if (actionName == ActionToString(Action))
+        {
+            *pActionTypeOut = Action;
+            return true;
+        }
+    }
+
+    return false;
+}
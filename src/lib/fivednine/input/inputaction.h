@@ -0,0 +1,33 @@
+// inputaction.h
+//
+// What the user asked for, independent of which key, button or stick asked
+// for it. Input sources translate their controls into these through an
+// InputMapping (see inputmapping.h).
+
+#pragma once
+
+#include <string>
+
+namespace fivednine { namespace input {
+    enum class ActionType
+    {
+        None = 0,
+        Previous,
+        Next,
+        PagePrevious,
+        PageNext,
+        Confirm,
+        Search,
+        NextLibraryView,
+        ToggleOverlay,
+        Quit,
+        Max
+    };
+
+    // Whether holding the action down repeats it (see actionrepeater.h)
+    bool IsRepeatableAction(ActionType actionType);
+
+    // Lower case, as used in mapping files
+    const char* ActionToString(ActionType actionType);
+    bool ActionFromString(const std::string& actionName, ActionType* pActionTypeOut);
+}}
@@ -0,0 +1,149 @@
+#include "inputdevicestate.h"
+#include "inputmapping.h"
+
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+void InputDeviceState::Initialize(const DeviceMapping* pMapping, uint32_t deviceIndex)
+{
+    RELEASE_CHECK(pMapping != nullptr, "pMapping cannot be null");
+    m_pMapping = pMapping;
+    m_deviceIndex = deviceIndex;
+    for (uint8_t& holdCount : m_actionHoldCounts)
+    {
+        holdCount = 0;
+    }
+    m_numAxes = 0;
+}
+
+const DeviceMapping* InputDeviceState::GetMapping() const
+{
+    return m_pMapping;
+}
+
+void
+InputDeviceState::OnControl(
+    uint32_t controlCode,
+    bool isPressed,
+    uint64_t timestampNs,
+    FnInputEventHandler pfnHandler,
+    void* pUserPointer)
+{
+    const ActionType Action = m_pMapping->FindAction(controlCode);
+    if (Action == ActionType::None)
+    {
+        return;
+    }
+
+    SetActionPressed(Action, isPressed, timestampNs, pfnHandler, pUserPointer);
+}
+
+void
+InputDeviceState::OnAxis(
+    uint32_t axis,
+    int32_t value,
+    int32_t lowThreshold,
+    int32_t highThreshold,
+    uint64_t timestampNs,
+    FnInputEventHandler pfnHandler,
+    void* pUserPointer)
+{
+    AxisDirection* pAxisDirection = nullptr;
+    for (size_t i = 0; i < m_numAxes; ++i)
+    {
+        if (m_axisDirections[i].Axis == axis)
+        {
+            pAxisDirection = &m_axisDirections[i];
+            break;
+        }
+    }
+
+    if (!pAxisDirection)
+    {
+        if (m_numAxes == kMaxAxes)
+        {
+            return;
+        }
+
+        pAxisDirection = &m_axisDirections[m_numAxes++];
+        pAxisDirection->Axis = axis;
+        pAxisDirection->Direction = 0;
+    }
+
+    const int32_t Direction = value <= lowThreshold ? -1 : value >= highThreshold ? 1 : 0;
+    const int32_t PreviousDirection = pAxisDirection->Direction;
+    if (Direction == PreviousDirection)
+    {
+        return;
+    }
+    pAxisDirection->Direction = Direction;
+
+    // Release the old direction before pressing the new one; a stick can go
+    // from one side to the other between two reports
+    if (PreviousDirection != 0)
+    {
+        OnControl(AxisControlCode(axis, PreviousDirection > 0), false, timestampNs, pfnHandler, pUserPointer);
+    }
+
+    if (Direction != 0)
+    {
+        OnControl(AxisControlCode(axis, Direction > 0), true, timestampNs, pfnHandler, pUserPointer);
+    }
+}
+
+void InputDeviceState::ReleaseAll(uint64_t timestampNs, FnInputEventHandler pfnHandler, void* pUserPointer)
+{
+    for (size_t i = 0; i < static_cast<size_t>(ActionType::Max); ++i)
+    {
+        if (m_actionHoldCounts[i] == 0)
+        {
+            continue;
+        }
+
+        m_actionHoldCounts[i] = 1;
+        SetActionPressed(static_cast<ActionType>(i), false, timestampNs, pfnHandler, pUserPointer);
+    }
+
+    for (size_t i = 0; i < m_numAxes; ++i)
+    {
+        m_axisDirections[i].Direction = 0;
+    }
+}
+
+void
+InputDeviceState::SetActionPressed(
+    ActionType actionType,
+    bool isPressed,
+    uint64_t timestampNs,
+    FnInputEventHandler pfnHandler,
+    void* pUserPointer)
+{
+    uint8_t& holdCount = m_actionHoldCounts[static_cast<size_t>(actionType)];
+    if (isPressed)
+    {
+        // Saturates rather than wrapping; no device has that many controls
+        // on one action
+        if (holdCount == UINT8_MAX || holdCount++ > 0)
+        {
+            return;
+        }
+    }
+    else
+    {
+        // Releases for controls that were down before the device was opened
+        // have nothing to release
+        if (holdCount == 0 || --holdCount > 0)
+        {
+            return;
+        }
+    }
+
+    InputEvent event;
+    event.ActionType = actionType;
+    event.IsPressed = isPressed;
+    event.TimestampNs = timestampNs;
+    event.DeviceIndex = m_deviceIndex;
+    pfnHandler(event, pUserPointer);
+}
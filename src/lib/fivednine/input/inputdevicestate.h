@@ -0,0 +1,76 @@
+// inputdevicestate.h
+//
+// What one device currently holds down, in terms of actions. Controls are
+// translated through the device's mapping; stick and hat axes are read as a
+// control for each direction. An action is pressed when the first control
+// mapped to it goes down and released when the last one comes up, so a pad
+// whose stick and d-pad both map to Next doesn't report it twice. Whatever
+// is still held can be released when the device goes away, so that nothing
+// keeps repeating after an unplug.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "inputevent.h"
+
+namespace fivednine { namespace input {
+    class DeviceMapping;
+
+    class InputDeviceState
+    {
+    public:
+        // Stick and hat axes tracked per device
+        static constexpr size_t kMaxAxes = 8;
+
+        void Initialize(const DeviceMapping* pMapping, uint32_t deviceIndex);
+        const DeviceMapping* GetMapping() const;
+
+        // Unmapped controls are ignored
+        void
+        OnControl(
+            uint32_t controlCode,
+            bool isPressed,
+            uint64_t timestampNs,
+            FnInputEventHandler pfnHandler,
+            void* pUserPointer);
+
+        // The axis counts as pushed one way at or beyond a threshold
+        void
+        OnAxis(
+            uint32_t axis,
+            int32_t value,
+            int32_t lowThreshold,
+            int32_t highThreshold,
+            uint64_t timestampNs,
+            FnInputEventHandler pfnHandler,
+            void* pUserPointer);
+
+        void ReleaseAll(uint64_t timestampNs, FnInputEventHandler pfnHandler, void* pUserPointer);
+
+    private:
+        void
+        SetActionPressed(
+            ActionType actionType,
+            bool isPressed,
+            uint64_t timestampNs,
+            FnInputEventHandler pfnHandler,
+            void* pUserPointer);
+
+        const DeviceMapping* m_pMapping = nullptr;
+        uint32_t             m_deviceIndex = 0;
+
+        // Per action, how many of this device's controls are holding it
+        uint8_t m_actionHoldCounts[static_cast<size_t>(ActionType::Max)] = {};
+
+        // Direction last reported per axis: -1, 0 or 1
+        struct AxisDirection
+        {
+            uint32_t Axis = 0;
+            int32_t  Direction = 0;
+        };
+        AxisDirection m_axisDirections[kMaxAxes];
+        size_t        m_numAxes = 0;
+    };
+}}
@@ -0,0 +1,29 @@
+// inputevent.h
+//
+// An action pressed or released on some input device, already translated
+// through the device's mapping. Every input source (the window's keyboard
+// and gamepads, the evdev input thread, recorded input) delivers these.
+
+#pragma once
+
+#include <cstdint>
+
+#include "inputaction.h"
+
+namespace fivednine { namespace input {
+    struct InputEvent
+    {
+        input::ActionType ActionType = input::ActionType::None;
+        bool              IsPressed = false;
+
+        // system::time::GetTicksNs clock, taken by the kernel when the
+        // device reported the event where possible
+        uint64_t TimestampNs = 0;
+
+        // Identifies the device within its source, e.g. among those the
+        // input thread opened; informational only
+        uint32_t DeviceIndex = 0;
+    };
+
+    typedef void(*FnInputEventHandler)(const InputEvent& event, void* pUserPointer);
+}}
@@ -0,0 +1,513 @@
+#include "inputmapping.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#include <linux/input.h>
+
+#include <SDL.h>
+
+#include <json/json.hpp>
+#include <fivednine/log/log.h>
+
+using json = nlohmann::json;
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+namespace
+{
+    // Above KEY_MAX, SDL's keycodes, and SDL's controller buttons
+    static constexpr uint32_t kAxisControlCodeBase = 0x80000000u;
+
+    struct NamedCode
+    {
+        const char* pName;
+        uint32_t    Code;
+    };
+
+    #define EVDEV_CODE(code) { #code, code }
+
+    // The keys and buttons arcade encoders, sticks and pads tend to report.
+    // Anything else can be given by number.
+    static const NamedCode kEvdevKeyCodes[] = {
+        EVDEV_CODE(KEY_ESC), EVDEV_CODE(KEY_TAB), EVDEV_CODE(KEY_ENTER), EVDEV_CODE(KEY_KPENTER),
+        EVDEV_CODE(KEY_SPACE), EVDEV_CODE(KEY_BACKSPACE), EVDEV_CODE(KEY_SLASH),
+        EVDEV_CODE(KEY_LEFTCTRL), EVDEV_CODE(KEY_LEFTALT), EVDEV_CODE(KEY_LEFTSHIFT),
+        EVDEV_CODE(KEY_RIGHTCTRL), EVDEV_CODE(KEY_RIGHTALT), EVDEV_CODE(KEY_RIGHTSHIFT),
+        EVDEV_CODE(KEY_UP), EVDEV_CODE(KEY_DOWN), EVDEV_CODE(KEY_LEFT), EVDEV_CODE(KEY_RIGHT),
+        EVDEV_CODE(KEY_PAGEUP), EVDEV_CODE(KEY_PAGEDOWN), EVDEV_CODE(KEY_HOME), EVDEV_CODE(KEY_END),
+        EVDEV_CODE(KEY_1), EVDEV_CODE(KEY_2), EVDEV_CODE(KEY_3), EVDEV_CODE(KEY_4), EVDEV_CODE(KEY_5),
+        EVDEV_CODE(KEY_6), EVDEV_CODE(KEY_7), EVDEV_CODE(KEY_8), EVDEV_CODE(KEY_9), EVDEV_CODE(KEY_0),
+        EVDEV_CODE(KEY_A), EVDEV_CODE(KEY_B), EVDEV_CODE(KEY_C), EVDEV_CODE(KEY_D), EVDEV_CODE(KEY_E),
+        EVDEV_CODE(KEY_F), EVDEV_CODE(KEY_G), EVDEV_CODE(KEY_H), EVDEV_CODE(KEY_I), EVDEV_CODE(KEY_J),
+        EVDEV_CODE(KEY_K), EVDEV_CODE(KEY_L), EVDEV_CODE(KEY_M), EVDEV_CODE(KEY_N), EVDEV_CODE(KEY_O),
+        EVDEV_CODE(KEY_P), EVDEV_CODE(KEY_Q), EVDEV_CODE(KEY_R), EVDEV_CODE(KEY_S), EVDEV_CODE(KEY_T),
+        EVDEV_CODE(KEY_U), EVDEV_CODE(KEY_V), EVDEV_CODE(KEY_W), EVDEV_CODE(KEY_X), EVDEV_CODE(KEY_Y),
+        EVDEV_CODE(KEY_Z),
+        EVDEV_CODE(KEY_F1), EVDEV_CODE(KEY_F2), EVDEV_CODE(KEY_F3), EVDEV_CODE(KEY_F4),
+        EVDEV_CODE(KEY_F5), EVDEV_CODE(KEY_F6), EVDEV_CODE(KEY_F7), EVDEV_CODE(KEY_F8),
+        EVDEV_CODE(KEY_F9), EVDEV_CODE(KEY_F10), EVDEV_CODE(KEY_F11), EVDEV_CODE(KEY_F12),
+        EVDEV_CODE(BTN_TRIGGER), EVDEV_CODE(BTN_THUMB), EVDEV_CODE(BTN_THUMB2), EVDEV_CODE(BTN_TOP),
+        EVDEV_CODE(BTN_TOP2), EVDEV_CODE(BTN_PINKIE), EVDEV_CODE(BTN_BASE), EVDEV_CODE(BTN_BASE2),
+        EVDEV_CODE(BTN_BASE3), EVDEV_CODE(BTN_BASE4), EVDEV_CODE(BTN_BASE5), EVDEV_CODE(BTN_BASE6),
+        EVDEV_CODE(BTN_SOUTH), EVDEV_CODE(BTN_EAST), EVDEV_CODE(BTN_NORTH), EVDEV_CODE(BTN_WEST),
+        EVDEV_CODE(BTN_TL), EVDEV_CODE(BTN_TR), EVDEV_CODE(BTN_TL2), EVDEV_CODE(BTN_TR2),
+        EVDEV_CODE(BTN_SELECT), EVDEV_CODE(BTN_START), EVDEV_CODE(BTN_MODE),
+        EVDEV_CODE(BTN_THUMBL), EVDEV_CODE(BTN_THUMBR),
+        EVDEV_CODE(BTN_DPAD_UP), EVDEV_CODE(BTN_DPAD_DOWN), EVDEV_CODE(BTN_DPAD_LEFT), EVDEV_CODE(BTN_DPAD_RIGHT),
+    };
+
+    static const NamedCode kEvdevAxisCodes[] = {
+        EVDEV_CODE(ABS_X), EVDEV_CODE(ABS_Y), EVDEV_CODE(ABS_RX), EVDEV_CODE(ABS_RY),
+        EVDEV_CODE(ABS_HAT0X), EVDEV_CODE(ABS_HAT0Y),
+    };
+
+    #undef EVDEV_CODE
+
+    bool FindNamedCode(const NamedCode* pNamedCodes, size_t numNamedCodes, const std::string& name, uint32_t* pCodeOut)
+    {
+        for (size_t i = 0; i < numNamedCodes; ++i)
+        {
+            if (name == pNamedCodes[i].pName)
+            {
+                *pCodeOut = pNamedCodes[i].Code;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Splits "ABS_X+" into "ABS_X" and a direction
+    bool SplitAxisDirection(const std::string& controlName, std::string* pAxisNameOut, bool* pIsPositiveOut)
+    {
+        if (controlName.size() < 2 || (controlName.back() != '-' && controlName.back() != '+'))
+        {
+            return false;
+        }
+
+        *pAxisNameOut = controlName.substr(0, controlName.size() - 1);
+        *pIsPositiveOut = controlName.back() == '+';
+        return true;
+    }
+
+    bool ParseUnsigned(const std::string& text, uint32_t* pValueOut)
+    {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        *pValueOut = static_cast<uint32_t>(std::strtoul(text.c_str(), nullptr, 10));
+        return true;
+    }
+
+    void SetKeyboardDefaults(DeviceMapping* pMapping)
+    {
+        // Arcade encoders pretending to be keyboards send MAME's defaults:
+        // left ctrl, left alt and space for the first three buttons
+        pMapping->SetAction(SDLK_LEFT, ActionType::Previous);
+        pMapping->SetAction(SDLK_a, ActionType::Previous);
+        pMapping->SetAction(SDLK_RIGHT, ActionType::Next);
+        pMapping->SetAction(SDLK_d, ActionType::Next);
+        pMapping->SetAction(SDLK_UP, ActionType::PagePrevious);
+        pMapping->SetAction(SDLK_PAGEUP, ActionType::PagePrevious);
+        pMapping->SetAction(SDLK_DOWN, ActionType::PageNext);
+        pMapping->SetAction(SDLK_PAGEDOWN, ActionType::PageNext);
+        pMapping->SetAction(SDLK_RETURN, ActionType::Confirm);
+        pMapping->SetAction(SDLK_KP_ENTER, ActionType::Confirm);
+        pMapping->SetAction(SDLK_LCTRL, ActionType::Confirm);
+        pMapping->SetAction(SDLK_SLASH, ActionType::Search);
+        pMapping->SetAction(SDLK_f, ActionType::Search);
+        pMapping->SetAction(SDLK_LALT, ActionType::Search);
+        pMapping->SetAction(SDLK_TAB, ActionType::NextLibraryView);
+        pMapping->SetAction(SDLK_SPACE, ActionType::NextLibraryView);
+        pMapping->SetAction(SDLK_F1, ActionType::ToggleOverlay);
+        pMapping->SetAction(SDLK_q, ActionType::Quit);
+    }
+
+    void SetGamepadDefaults(DeviceMapping* pMapping)
+    {
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_DPAD_LEFT, ActionType::Previous);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_DPAD_RIGHT, ActionType::Next);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_DPAD_UP, ActionType::PagePrevious);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_LEFTSHOULDER, ActionType::PagePrevious);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_DPAD_DOWN, ActionType::PageNext);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, ActionType::PageNext);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_A, ActionType::Confirm);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_START, ActionType::Confirm);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_Y, ActionType::Search);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_X, ActionType::NextLibraryView);
+        pMapping->SetAction(SDL_CONTROLLER_BUTTON_BACK, ActionType::NextLibraryView);
+        pMapping->SetAction(AxisControlCode(SDL_CONTROLLER_AXIS_LEFTX, false), ActionType::Previous);
+        pMapping->SetAction(AxisControlCode(SDL_CONTROLLER_AXIS_LEFTX, true), ActionType::Next);
+        pMapping->SetAction(AxisControlCode(SDL_CONTROLLER_AXIS_LEFTY, false), ActionType::PagePrevious);
+        pMapping->SetAction(AxisControlCode(SDL_CONTROLLER_AXIS_LEFTY, true), ActionType::PageNext);
+    }
+
+    void SetEvdevDefaults(DeviceMapping* pMapping)
+    {
+        // Keyboards read directly are read whatever has focus, so only the
+        // navigation keys are mapped: nothing that's typed or held for a
+        // shortcut elsewhere, and no quit. Encoders sending MAME's keys can
+        // be given them in a mapping file.
+        pMapping->SetAction(KEY_LEFT, ActionType::Previous);
+        pMapping->SetAction(KEY_RIGHT, ActionType::Next);
+        pMapping->SetAction(KEY_UP, ActionType::PagePrevious);
+        pMapping->SetAction(KEY_PAGEUP, ActionType::PagePrevious);
+        pMapping->SetAction(KEY_DOWN, ActionType::PageNext);
+        pMapping->SetAction(KEY_PAGEDOWN, ActionType::PageNext);
+        pMapping->SetAction(KEY_ENTER, ActionType::Confirm);
+        pMapping->SetAction(KEY_KPENTER, ActionType::Confirm);
+
+        // Pads, and joystick encoders whose first buttons are trigger and
+        // thumb
+        pMapping->SetAction(BTN_DPAD_LEFT, ActionType::Previous);
+        pMapping->SetAction(BTN_DPAD_RIGHT, ActionType::Next);
+        pMapping->SetAction(BTN_DPAD_UP, ActionType::PagePrevious);
+        pMapping->SetAction(BTN_TL, ActionType::PagePrevious);
+        pMapping->SetAction(BTN_DPAD_DOWN, ActionType::PageNext);
+        pMapping->SetAction(BTN_TR, ActionType::PageNext);
+        pMapping->SetAction(BTN_SOUTH, ActionType::Confirm);
+        pMapping->SetAction(BTN_START, ActionType::Confirm);
+        pMapping->SetAction(BTN_TRIGGER, ActionType::Confirm);
+        pMapping->SetAction(BTN_NORTH, ActionType::Search);
+        pMapping->SetAction(BTN_THUMB, ActionType::Search);
+        pMapping->SetAction(BTN_WEST, ActionType::NextLibraryView);
+        pMapping->SetAction(BTN_SELECT, ActionType::NextLibraryView);
+
+        // Sticks and hats
+        pMapping->SetAction(AxisControlCode(ABS_X, false), ActionType::Previous);
+        pMapping->SetAction(AxisControlCode(ABS_X, true), ActionType::Next);
+        pMapping->SetAction(AxisControlCode(ABS_HAT0X, false), ActionType::Previous);
+        pMapping->SetAction(AxisControlCode(ABS_HAT0X, true), ActionType::Next);
+        pMapping->SetAction(AxisControlCode(ABS_Y, false), ActionType::PagePrevious);
+        pMapping->SetAction(AxisControlCode(ABS_Y, true), ActionType::PageNext);
+        pMapping->SetAction(AxisControlCode(ABS_HAT0Y, false), ActionType::PagePrevious);
+        pMapping->SetAction(AxisControlCode(ABS_HAT0Y, true), ActionType::PageNext);
+    }
+
+    bool ApplyControls(InputSource source, const json& controlsData, const std::string& mappingPath, DeviceMapping* pMapping)
+    {
+        if (!controlsData.is_object())
+        {
+            RELEASE_LOGLINE_ERROR(LOG_INPUT, "Input mapping %s: \"controls\" must be an object", mappingPath.c_str());
+            return false;
+        }
+
+        for (auto it = controlsData.begin(); it != controlsData.end(); ++it)
+        {
+            uint32_t controlCode;
+            if (!InputMapping::ControlFromString(source, it.key(), &controlCode))
+            {
+                RELEASE_LOGLINE_ERROR(
+                    LOG_INPUT,
+                    "Input mapping %s: unknown %s control %s",
+                    mappingPath.c_str(),
+                    InputMapping::SourceToString(source),
+                    it.key().c_str());
+                return false;
+            }
+
+            ActionType actionType;
+            if (!it.value().is_string() || !ActionFromString(it.value().get<std::string>(), &actionType))
+            {
+                RELEASE_LOGLINE_ERROR(
+                    LOG_INPUT,
+                    "Input mapping %s: control %s has an unknown action",
+                    mappingPath.c_str(),
+                    it.key().c_str());
+                return false;
+            }
+
+            pMapping->SetAction(controlCode, actionType);
+        }
+
+        return true;
+    }
+}
+
+uint32_t fivednine::input::AxisControlCode(uint32_t axis, bool isPositive)
+{
+    return kAxisControlCodeBase | (axis << 1) | (isPositive ? 1u : 0u);
+}
+
+bool fivednine::input::AxisFromControlCode(uint32_t controlCode, uint32_t* pAxisOut)
+{
+    if ((controlCode & kAxisControlCodeBase) == 0)
+    {
+        return false;
+    }
+
+    *pAxisOut = (controlCode & ~kAxisControlCodeBase) >> 1;
+    return true;
+}
+
+void DeviceMapping::SetAction(uint32_t controlCode, ActionType actionType)
+{
+    auto it = std::lower_bound(std::begin(m_controlActions), std::end(m_controlActions), controlCode,
+        [](const ControlAction& controlAction, uint32_t code) -> bool
+        {
+            return controlAction.ControlCode < code;
+        });
+
+    const bool IsMapped = it != std::end(m_controlActions) && it->ControlCode == controlCode;
+    if (actionType == ActionType::None)
+    {
+        if (IsMapped)
+        {
+            m_controlActions.erase(it);
+        }
+        return;
+    }
+
+    if (IsMapped)
+    {
+        it->ActionType = actionType;
+        return;
+    }
+
+    ControlAction controlAction;
+    controlAction.ControlCode = controlCode;
+    controlAction.ActionType = actionType;
+    m_controlActions.insert(it, controlAction);
+}
+
+ActionType DeviceMapping::FindAction(uint32_t controlCode) const
+{
+    auto it = std::lower_bound(std::begin(m_controlActions), std::end(m_controlActions), controlCode,
+        [](const ControlAction& controlAction, uint32_t code) -> bool
+        {
+            return controlAction.ControlCode < code;
+        });
+
+    if (it == std::end(m_controlActions) || it->ControlCode != controlCode)
+    {
+        return ActionType::None;
+    }
+
+    return it->ActionType;
+}
+
+const std::vector<DeviceMapping::ControlAction>& DeviceMapping::GetControlActions() const
+{
+    return m_controlActions;
+}
+
+InputMapping::InputMapping()
+{
+    SetDefaults();
+}
+
+void InputMapping::SetDefaults()
+{
+    for (DeviceMapping& defaultMapping : m_defaultMappings)
+    {
+        defaultMapping = DeviceMapping();
+    }
+    m_deviceMappings.clear();
+
+    SetKeyboardDefaults(&m_defaultMappings[static_cast<size_t>(InputSource::Keyboard)]);
+    SetGamepadDefaults(&m_defaultMappings[static_cast<size_t>(InputSource::Gamepad)]);
+    SetEvdevDefaults(&m_defaultMappings[static_cast<size_t>(InputSource::Evdev)]);
+}
+
+bool InputMapping::LoadFromFile(const std::string& mappingPath)
+{
+    std::ifstream in(mappingPath);
+    if (!in)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_INPUT, "Failed to open input mapping: %s", mappingPath.c_str());
+        return false;
+    }
+
+    const json MappingData = json::parse(in, nullptr, false /* allow_exceptions */);
+    if (MappingData.is_discarded() || !MappingData.contains("devices") || !MappingData["devices"].is_array())
+    {
+        RELEASE_LOGLINE_ERROR(LOG_INPUT, "Input mapping %s has no \"devices\" array", mappingPath.c_str());
+        return false;
+    }
+
+    // Built up on copies so that a bad file changes nothing
+    DeviceMapping defaultMappings[kNumSources];
+    std::copy(std::begin(m_defaultMappings), std::end(m_defaultMappings), std::begin(defaultMappings));
+    std::vector<NamedDeviceMapping> deviceMappings = m_deviceMappings;
+
+    for (const json& DeviceData : MappingData["devices"])
+    {
+        InputSource source;
+        if (!DeviceData.contains("source") ||
+            !DeviceData["source"].is_string() ||
+            !SourceFromString(DeviceData["source"].get<std::string>(), &source))
+        {
+            RELEASE_LOGLINE_ERROR(LOG_INPUT, "Input mapping %s: device entry needs a valid \"source\"", mappingPath.c_str());
+            return false;
+        }
+
+        const json EmptyControls = json::object();
+        const json& ControlsData = DeviceData.contains("controls") ? DeviceData["controls"] : EmptyControls;
+        DeviceMapping& defaultMapping = defaultMappings[static_cast<size_t>(source)];
+        if (!DeviceData.contains("name"))
+        {
+            if (!ApplyControls(source, ControlsData, mappingPath, &defaultMapping))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (!DeviceData["name"].is_string() ||
+            (DeviceData.contains("replace_defaults") && !DeviceData["replace_defaults"].is_boolean()))
+        {
+            RELEASE_LOGLINE_ERROR(
+                LOG_INPUT,
+                "Input mapping %s: device \"name\" must be a string and \"replace_defaults\" true or false",
+                mappingPath.c_str());
+            return false;
+        }
+
+        NamedDeviceMapping namedMapping;
+        namedMapping.Source = source;
+        namedMapping.DeviceName = DeviceData["name"].get<std::string>();
+        const bool ReplaceDefaults = DeviceData.contains("replace_defaults") && DeviceData["replace_defaults"].get<bool>();
+        if (!ReplaceDefaults)
+        {
+            namedMapping.Mapping = defaultMapping;
+        }
+
+        if (!ApplyControls(source, ControlsData, mappingPath, &namedMapping.Mapping))
+        {
+            return false;
+        }
+        deviceMappings.push_back(std::move(namedMapping));
+    }
+
+    std::copy(std::begin(defaultMappings), std::end(defaultMappings), std::begin(m_defaultMappings));
+    m_deviceMappings = std::move(deviceMappings);
+
+    RELEASE_LOGLINE_INFO(
+        LOG_INPUT,
+        "Loaded input mapping %s (%zu device tables)",
+        mappingPath.c_str(),
+        m_deviceMappings.size());
+    return true;
+}
+
+const DeviceMapping& InputMapping::FindDeviceMapping(InputSource source, const std::string& deviceName) const
+{
+    for (const NamedDeviceMapping& NamedMapping : m_deviceMappings)
+    {
+        if (NamedMapping.Source == source && deviceName.find(NamedMapping.DeviceName) != std::string::npos)
+        {
+            return NamedMapping.Mapping;
+        }
+    }
+
+    return m_defaultMappings[static_cast<size_t>(source)];
+}
+
+const char* InputMapping::SourceToString(InputSource source)
+{
+    static const char* LUT[] = {
+        "keyboard",
+        "gamepad",
+        "evdev",
+    };
+
+    static_assert(sizeof(LUT) / sizeof(LUT[0]) == kNumSources, "Input source LUT size does not match enum");
+
+    if (source >= InputSource::Max)
+    {
+        return "invalid";
+    }
+
+    return LUT[static_cast<size_t>(source)];
+}
+
+bool InputMapping::SourceFromString(const std::string& sourceName, InputSource* pSourceOut)
+{
+    for (size_t i = 0; i < kNumSources; ++i)
+    {
+        const InputSource Source = static_cast<InputSource>(i);
+        if (sourceName == SourceToString(Source))
+        {
+            *pSourceOut = Source;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool InputMapping::ControlFromString(InputSource source, const std::string& controlName, uint32_t* pControlCodeOut)
+{
+    std::string axisName;
+    bool isPositive = false;
+    const bool IsAxis = SplitAxisDirection(controlName, &axisName, &isPositive);
+
+    switch (source)
+    {
+        case InputSource::Keyboard:
+        {
+            const SDL_Keycode Keycode = SDL_GetKeyFromName(controlName.c_str());
+            if (Keycode == SDLK_UNKNOWN)
+            {
+                return false;
+            }
+
+            *pControlCodeOut = static_cast<uint32_t>(Keycode);
+            return true;
+        }
+        case InputSource::Gamepad:
+        {
+            if (IsAxis)
+            {
+                const SDL_GameControllerAxis Axis = SDL_GameControllerGetAxisFromString(axisName.c_str());
+                if (Axis == SDL_CONTROLLER_AXIS_INVALID)
+                {
+                    return false;
+                }
+
+                *pControlCodeOut = AxisControlCode(static_cast<uint32_t>(Axis), isPositive);
+                return true;
+            }
+
+            const SDL_GameControllerButton Button = SDL_GameControllerGetButtonFromString(controlName.c_str());
+            if (Button == SDL_CONTROLLER_BUTTON_INVALID)
+            {
+                return false;
+            }
+
+            *pControlCodeOut = static_cast<uint32_t>(Button);
+            return true;
+        }
+        case InputSource::Evdev:
+        {
+            uint32_t code;
+            if (IsAxis)
+            {
+                if (!FindNamedCode(kEvdevAxisCodes, sizeof(kEvdevAxisCodes) / sizeof(kEvdevAxisCodes[0]), axisName, &code) &&
+                    !ParseUnsigned(axisName, &code))
+                {
+                    return false;
+                }
+
+                *pControlCodeOut = AxisControlCode(code, isPositive);
+                return code <= ABS_MAX;
+            }
+
+            if (!FindNamedCode(kEvdevKeyCodes, sizeof(kEvdevKeyCodes) / sizeof(kEvdevKeyCodes[0]), controlName, &code) &&
+                !ParseUnsigned(controlName, &code))
+            {
+                return false;
+            }
+
+            *pControlCodeOut = code;
+            return code <= KEY_MAX;
+        }
+        default:
+            return false;
+    }
+}
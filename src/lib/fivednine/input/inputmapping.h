@@ -0,0 +1,99 @@
+// inputmapping.h
+//
+// Tables translating a device's controls into actions. Each input source
+// has a default table, and devices can be given tables of their own by name,
+// e.g. an arcade encoder wired differently from a keyboard. Tables are
+// resolved once, when a device is opened, so translating an event is a
+// lookup in a small sorted array.
+//
+// Mapping files are JSON:
+//
+//   { "devices": [
+//       { "source": "evdev", "name": "I-PAC",
+//         "controls": { "KEY_LEFTCTRL": "confirm", "KEY_5": "none" } },
+//       { "source": "gamepad", "controls": { "b": "search" } } ] }
+//
+// An entry without a name changes the source's default table. An entry
+// with one applies to devices whose name contains it, and starts from the
+// source's default unless "replace_defaults" is true. Controls are named
+// as the source knows them: SDL key names for the keyboard, SDL game
+// controller button and axis names for gamepads, and Linux input codes for
+// evdev. Axis directions are the axis name followed by - or +.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "inputaction.h"
+
+namespace fivednine { namespace input {
+    enum class InputSource
+    {
+        Keyboard = 0, // SDL keycodes
+        Gamepad,      // SDL game controller buttons and axes
+        Evdev,        // Linux input event codes
+        Max
+    };
+
+    // Axis directions are mapped like buttons, with codes outside any
+    // source's button range
+    uint32_t AxisControlCode(uint32_t axis, bool isPositive);
+    bool AxisFromControlCode(uint32_t controlCode, uint32_t* pAxisOut);
+
+    class DeviceMapping
+    {
+    public:
+        struct ControlAction
+        {
+            uint32_t          ControlCode = 0;
+            input::ActionType ActionType = input::ActionType::None;
+        };
+
+        // ActionType::None unmaps the control
+        void SetAction(uint32_t controlCode, ActionType actionType);
+        ActionType FindAction(uint32_t controlCode) const;
+
+        // Sorted by control code
+        const std::vector<ControlAction>& GetControlActions() const;
+
+    private:
+        std::vector<ControlAction> m_controlActions;
+    };
+
+    class InputMapping
+    {
+    public:
+        // Starts out with the default tables
+        InputMapping();
+
+        void SetDefaults();
+
+        // Applies a mapping file on top of the current tables. On failure
+        // the tables are left as they were.
+        bool LoadFromFile(const std::string& mappingPath);
+
+        // The first device table whose name is contained in deviceName,
+        // otherwise the source's default
+        const DeviceMapping& FindDeviceMapping(InputSource source, const std::string& deviceName) const;
+
+        static const char* SourceToString(InputSource source);
+        static bool SourceFromString(const std::string& sourceName, InputSource* pSourceOut);
+        static bool ControlFromString(InputSource source, const std::string& controlName, uint32_t* pControlCodeOut);
+
+    private:
+        struct NamedDeviceMapping
+        {
+            InputSource   Source = InputSource::Max;
+            std::string   DeviceName;
+            DeviceMapping Mapping;
+        };
+
+        static constexpr size_t kNumSources = static_cast<size_t>(InputSource::Max);
+
+        DeviceMapping                   m_defaultMappings[kNumSources];
+        std::vector<NamedDeviceMapping> m_deviceMappings;
+    };
+}}
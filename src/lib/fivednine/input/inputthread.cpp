@@ -0,0 +1,297 @@
+#include "inputthread.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <fivednine/log/check.h>
+#include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/render/window.h>
+
+using namespace fivednine;
+using namespace fivednine::input;
+
+namespace
+{
+    static const char* kInputDevicesPath = "/dev/input";
+
+    bool IsEventDeviceName(const std::string& fileName)
+    {
+        return fileName.rfind("event", 0) == 0;
+    }
+}
+
+InputThread::~InputThread()
+{
+    Stop();
+}
+
+bool
+InputThread::Start(
+    const InputMapping* pInputMapping,
+    const render::Window* pWindowToWake,
+    bool areKeyboardsIncluded)
+{
+    RELEASE_CHECK(pInputMapping != nullptr, "pInputMapping cannot be null");
+    if (IsRunning())
+    {
+        return true;
+    }
+
+    m_pInputMapping = pInputMapping;
+    m_pWindowToWake = pWindowToWake;
+    m_areKeyboardsIncluded = areKeyboardsIncluded;
+
+    // Set up before the scan so that nothing plugged in during it is missed.
+    // Permissions are often applied just after a node is created, hence
+    // IN_ATTRIB.
+    m_directoryWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_directoryWatchFd >= 0 &&
+        inotify_add_watch(m_directoryWatchFd, kInputDevicesPath, IN_CREATE | IN_ATTRIB) < 0)
+    {
+        close(m_directoryWatchFd);
+        m_directoryWatchFd = -1;
+    }
+
+    // Sorted so device indices are stable from run to run
+    std::vector<std::string> devicePaths;
+    std::error_code errorCode;
+    for (const auto& directoryEntry : std::filesystem::directory_iterator(kInputDevicesPath, errorCode))
+    {
+        if (IsEventDeviceName(directoryEntry.path().filename().string()))
+        {
+            devicePaths.push_back(directoryEntry.path().string());
+        }
+    }
+    std::sort(std::begin(devicePaths), std::end(devicePaths));
+
+    m_devices.clear();
+    m_nextDeviceIndex = 0;
+    for (const std::string& devicePath : devicePaths)
+    {
+        OpenDevice(devicePath);
+    }
+
+    if (m_devices.empty())
+    {
+        RELEASE_LOGLINE_INFO(LOG_INPUT, "No readable input devices under %s", kInputDevicesPath);
+        if (m_directoryWatchFd >= 0)
+        {
+            close(m_directoryWatchFd);
+            m_directoryWatchFd = -1;
+        }
+        return false;
+    }
+
+    m_stopEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stopEventFd < 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_INPUT, "Failed to create input thread stop event: %s", strerror(errno));
+        m_devices.clear();
+        if (m_directoryWatchFd >= 0)
+        {
+            close(m_directoryWatchFd);
+            m_directoryWatchFd = -1;
+        }
+        return false;
+    }
+
+    if (m_directoryWatchFd < 0)
+    {
+        RELEASE_LOGLINE_INFO(LOG_INPUT, "Can't watch %s, devices plugged in later won't be seen", kInputDevicesPath);
+    }
+
+    m_thread = std::thread(&InputThread::Run, this);
+
+    RELEASE_LOGLINE_INFO(LOG_INPUT, "Input thread reading %zu devices", m_devices.size());
+    return true;
+}
+
+void InputThread::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+
+    const uint64_t StopValue = 1;
+    if (write(m_stopEventFd, &StopValue, sizeof(StopValue)) < 0)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_INPUT, "Failed to signal input thread: %s", strerror(errno));
+    }
+    m_thread.join();
+
+    close(m_stopEventFd);
+    m_stopEventFd = -1;
+    if (m_directoryWatchFd >= 0)
+    {
+        close(m_directoryWatchFd);
+        m_directoryWatchFd = -1;
+    }
+    m_devices.clear();
+    m_numOpenDevices.store(0, std::memory_order_relaxed);
+}
+
+bool InputThread::IsRunning() const
+{
+    return m_thread.joinable();
+}
+
+size_t InputThread::GetNumDevices() const
+{
+    return m_numOpenDevices.load(std::memory_order_relaxed);
+}
+
+bool InputThread::PopEvent(InputEvent* pEventOut)
+{
+    return m_eventQueue.TryPop(pEventOut);
+}
+
+uint64_t InputThread::GetNumDroppedEvents() const
+{
+    return m_numDroppedEvents.load(std::memory_order_relaxed);
+}
+
+void InputThread::OpenDevice(const std::string& devicePath)
+{
+    for (const std::unique_ptr<EvdevDevice>& spDevice : m_devices)
+    {
+        if (spDevice->GetPath() == devicePath)
+        {
+            return;
+        }
+    }
+
+    std::unique_ptr<EvdevDevice> spDevice(new EvdevDevice);
+    if (spDevice->Open(devicePath, m_nextDeviceIndex, *m_pInputMapping, m_areKeyboardsIncluded))
+    {
+        ++m_nextDeviceIndex;
+        m_devices.push_back(std::move(spDevice));
+        m_numOpenDevices.store(m_devices.size(), std::memory_order_relaxed);
+    }
+}
+
+void InputThread::HandleDirectoryEvents()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+        const ssize_t NumBytesRead = read(m_directoryWatchFd, buffer, sizeof(buffer));
+        if (NumBytesRead <= 0)
+        {
+            return;
+        }
+
+        for (ssize_t offset = 0; offset < NumBytesRead;)
+        {
+            const struct inotify_event* pEvent = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += sizeof(struct inotify_event) + pEvent->len;
+
+            if (pEvent->len > 0 && IsEventDeviceName(pEvent->name))
+            {
+                OpenDevice(std::string(kInputDevicesPath) + "/" + pEvent->name);
+            }
+        }
+    }
+}
+
+void InputThread::Run()
+{
+    profile::SetThreadName("input");
+
+    // Slot 0 is the stop event and slot 1 the directory watch (ignored if
+    // -1); the rest mirror m_devices
+    static constexpr size_t kFirstDeviceSlot = 2;
+    std::vector<struct pollfd> pollFds;
+    while (true)
+    {
+        pollFds.clear();
+        pollFds.push_back({ m_stopEventFd, POLLIN, 0 });
+        pollFds.push_back({ m_directoryWatchFd, POLLIN, 0 });
+        for (const std::unique_ptr<EvdevDevice>& spDevice : m_devices)
+        {
+            pollFds.push_back({ spDevice->GetFileDescriptor(), POLLIN, 0 });
+        }
+
+        if (poll(pollFds.data(), pollFds.size(), -1 /* timeout */) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            RELEASE_LOGLINE_ERROR(LOG_INPUT, "Input thread poll failed: %s", strerror(errno));
+            return;
+        }
+
+        if (pollFds[0].revents != 0)
+        {
+            return;
+        }
+
+        PROFILE_SCOPE("InputThread::ReadEvents");
+        m_hasPushedEvents = false;
+
+        // In device order, so events read together are queued in the order
+        // the devices were opened. Devices that went away are dropped after,
+        // keeping indices in step with pollFds.
+        bool hasLostDevice = false;
+        for (size_t deviceIndex = 0; deviceIndex < m_devices.size(); ++deviceIndex)
+        {
+            const short Revents = pollFds[deviceIndex + kFirstDeviceSlot].revents;
+            if (Revents == 0)
+            {
+                continue;
+            }
+
+            std::unique_ptr<EvdevDevice>& spDevice = m_devices[deviceIndex];
+            if ((Revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 || !spDevice->ReadEvents(HandleInputEvent, this))
+            {
+                RELEASE_LOGLINE_INFO(LOG_INPUT, "Input device %s (%s) went away", spDevice->GetPath().c_str(), spDevice->GetName().c_str());
+                spDevice->ReleaseAll(HandleInputEvent, this);
+                spDevice.reset();
+                hasLostDevice = true;
+            }
+        }
+
+        if (hasLostDevice)
+        {
+            m_devices.erase(
+                std::remove(std::begin(m_devices), std::end(m_devices), nullptr),
+                std::end(m_devices));
+            m_numOpenDevices.store(m_devices.size(), std::memory_order_relaxed);
+        }
+
+        // After reading, so that a device replugged at the same path isn't
+        // mistaken for the one that went away
+        if (pollFds[1].revents != 0)
+        {
+            HandleDirectoryEvents();
+        }
+
+        if (m_hasPushedEvents && m_pWindowToWake)
+        {
+            m_pWindowToWake->PostWakeEvent();
+        }
+    }
+}
+
+void InputThread::HandleInputEvent(const InputEvent& event, void* pUserPointer)
+{
+    InputThread* pInputThread = static_cast<InputThread*>(pUserPointer);
+    if (!pInputThread->m_eventQueue.TryPush(event))
+    {
+        pInputThread->m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    pInputThread->m_hasPushedEvents = true;
+}
@@ -0,0 +1,101 @@
+// inputthread.h
+//
+// Reads input devices on a thread of its own, so that input is picked up
+// and timestamped the moment it arrives rather than whenever the main loop
+// next gets around to polling (which can be most of a frame later). Events
+// are handed to the main thread through a lock-free queue, and the window is
+// woken so an idle main loop sees them immediately.
+//
+// Devices are read through evdev (see evdevdevice.h). If none can be opened
+// Start() fails, and the window's own input events should be used instead.
+// Once running, devices plugged in later are picked up as they appear under
+// /dev/input, and unplugged ones are closed, releasing whatever they held.
+
+#pragma once
+
+#include "evdevdevice.h"
+#include "inputevent.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fivednine/system/ringqueue.h>
+
+namespace fivednine { namespace render {
+    class Window;
+}}
+
+namespace fivednine { namespace input {
+    class InputMapping;
+
+    class InputThread
+    {
+    public:
+        // Far more than a frame's worth of input
+        static constexpr size_t kQueueCapacity = 256;
+
+        ~InputThread();
+
+        // Opens every usable /dev/input/event* device and starts reading
+        // them. The mapping must outlive the thread and not change while it
+        // runs. pWindowToWake may be null.
+        //
+        // Devices are read whichever window has focus, so keyboards are
+        // only included if areKeyboardsIncluded; otherwise typing into
+        // another app would drive this one.
+        bool
+        Start(
+            const InputMapping* pInputMapping,
+            const render::Window* pWindowToWake,
+            bool areKeyboardsIncluded);
+        void Stop();
+
+        bool IsRunning() const;
+
+        // Devices currently open
+        size_t GetNumDevices() const;
+
+        // Main thread only. Events come out in the order they were read.
+        bool PopEvent(InputEvent* pEventOut);
+
+        // Events lost because the main thread wasn't draining the queue
+        uint64_t GetNumDroppedEvents() const;
+
+    private:
+        void Run();
+
+        // Opens the device unless it's already open. Input thread only once
+        // running.
+        void OpenDevice(const std::string& devicePath);
+        void HandleDirectoryEvents();
+
+        static void HandleInputEvent(const InputEvent& event, void* pUserPointer);
+
+        // Owned by the input thread while it's running
+        std::vector<std::unique_ptr<EvdevDevice>> m_devices;
+        std::atomic<size_t>                       m_numOpenDevices{0};
+        uint32_t                                  m_nextDeviceIndex = 0;
+        const InputMapping*                       m_pInputMapping = nullptr;
+        bool                                      m_areKeyboardsIncluded = false;
+        const render::Window*                     m_pWindowToWake = nullptr;
+
+        std::thread m_thread;
+        int         m_stopEventFd = -1;
+
+        // Watches /dev/input for devices coming and going; -1 if inotify
+        // isn't available, in which case there's no hotplug
+        int         m_directoryWatchFd = -1;
+
+        // Set by the input thread while reading a batch, so the window is
+        // woken once per batch rather than once per event
+        bool        m_hasPushedEvents = false;
+
+        system::SpscRingQueue<InputEvent, kQueueCapacity> m_eventQueue;
+        std::atomic<uint64_t>                             m_numDroppedEvents{0};
+    };
+}}
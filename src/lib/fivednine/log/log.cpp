@@ -23,6 +23,7 @@ namespace
             "Default",
             "Render",
             "API",
+            "Input",
         };
 
         static_assert(sizeof(LUT) / sizeof(LUT[0]) == static_cast<int>(LogZone::Max), "Log zone LUT size does not match enum");
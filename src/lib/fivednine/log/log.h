@@ -27,6 +27,7 @@ namespace fivednine { namespace log {
         Default = 0,
         Render,
         API,
+        Input,
         Max
     };
 
@@ -123,3 +124,4 @@ namespace fivednine { namespace log {
 #define LOG_DEFAULT fivednine::log::LogZone::Default
 #define LOG_RENDER fivednine::log::LogZone::Render
 #define LOG_API fivednine::log::LogZone::API
+#define LOG_INPUT fivednine::log::LogZone::Input
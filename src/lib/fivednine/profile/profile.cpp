@@ -0,0 +1,199 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fivednine/log/log.h>
+
+using namespace fivednine;
+using namespace fivednine::profile;
+
+std::atomic<bool> fivednine::profile::detail::g_isEnabled(false);
+
+namespace
+{
+    struct ScopeEvent
+    {
+        const char* pName;
+        uint64_t    BeginNs;
+        uint64_t    EndNs;
+    };
+
+    // Single writer (the owning thread), any number of readers. The writer
+    // publishes each event by bumping WriteCount with release semantics.
+    // Readers snapshot the count, copy, then re-read it to discard anything
+    // the writer may have lapped while they were copying.
+    struct ThreadBuffer
+    {
+        static constexpr uint64_t kCapacity = 1 << 18;
+
+        ThreadBuffer(uint32_t threadId) : ThreadId(threadId) {}
+
+        const uint32_t          ThreadId;
+        std::string             ThreadName;
+
+        // Empty until the thread records its first event, so threads which
+        // are only named don't pay for a ring they never use. Only grown
+        // under the registry lock, which export holds throughout.
+        std::vector<ScopeEvent> Events;
+        std::atomic<uint64_t>   WriteCount { 0 };
+    };
+
+    // Buffers are registered once per thread and kept until exit, so events
+    // from threads which have finished are still exported.
+    std::mutex                                 s_registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_threadBuffers;
+
+    thread_local ThreadBuffer* t_pThreadBuffer = nullptr;
+
+    ThreadBuffer* GetThreadBuffer()
+    {
+        if (!t_pThreadBuffer)
+        {
+            std::lock_guard<std::mutex> lock(s_registryMutex);
+            const uint32_t ThreadId = static_cast<uint32_t>(s_threadBuffers.size()) + 1;
+            s_threadBuffers.emplace_back(new ThreadBuffer(ThreadId));
+            t_pThreadBuffer = s_threadBuffers.back().get();
+        }
+
+        return t_pThreadBuffer;
+    }
+
+    void WriteEscapedString(FILE* pFile, const char* pString)
+    {
+        std::fputc('"', pFile);
+        for (const char* pChar = pString; *pChar; ++pChar)
+        {
+            if (*pChar == '"' || *pChar == '\\')
+            {
+                std::fputc('\\', pFile);
+            }
+            std::fputc(*pChar, pFile);
+        }
+        std::fputc('"', pFile);
+    }
+}
+
+void fivednine::profile::SetEnabled(bool enabled)
+{
+    detail::g_isEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void fivednine::profile::SetThreadName(const char* pThreadName)
+{
+    ThreadBuffer* pThreadBuffer = GetThreadBuffer();
+
+    // The name is read during export
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    pThreadBuffer->ThreadName = pThreadName;
+}
+
+void fivednine::profile::RecordScope(const char* pName, uint64_t beginNs, uint64_t endNs)
+{
+    ThreadBuffer* pThreadBuffer = GetThreadBuffer();
+    if (pThreadBuffer->Events.empty())
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        pThreadBuffer->Events.resize(ThreadBuffer::kCapacity);
+    }
+
+    const uint64_t WriteCount = pThreadBuffer->WriteCount.load(std::memory_order_relaxed);
+
+    ScopeEvent& event = pThreadBuffer->Events[WriteCount % ThreadBuffer::kCapacity];
+    event.pName = pName;
+    event.BeginNs = beginNs;
+    event.EndNs = endNs;
+
+    pThreadBuffer->WriteCount.store(WriteCount + 1, std::memory_order_release);
+}
+
+bool fivednine::profile::ExportChromeTrace(const std::string& filePath)
+{
+    FILE* pFile = std::fopen(filePath.c_str(), "w");
+    if (!pFile)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to open trace file: %s", filePath.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+
+    // Timestamps are relative to the earliest exported event to keep the
+    // numbers readable
+    std::vector<std::vector<ScopeEvent>> threadEvents(s_threadBuffers.size());
+    uint64_t originNs = UINT64_MAX;
+    for (size_t i = 0; i < s_threadBuffers.size(); ++i)
+    {
+        const ThreadBuffer& Buffer = *s_threadBuffers[i];
+        const uint64_t EndCount = Buffer.WriteCount.load(std::memory_order_acquire);
+        const uint64_t StartCount = EndCount > ThreadBuffer::kCapacity ? EndCount - ThreadBuffer::kCapacity : 0;
+
+        std::vector<ScopeEvent>& events = threadEvents[i];
+        events.reserve(EndCount - StartCount);
+        for (uint64_t eventIndex = StartCount; eventIndex < EndCount; ++eventIndex)
+        {
+            events.push_back(Buffer.Events[eventIndex % ThreadBuffer::kCapacity]);
+        }
+
+        // Anything lapped by the writer during the copy may be torn,
+        // including the slot of the one event it may be writing right now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t InProgressCount = Buffer.WriteCount.load(std::memory_order_relaxed) + 1;
+        const uint64_t FirstValidCount =
+            InProgressCount > ThreadBuffer::kCapacity ? InProgressCount - ThreadBuffer::kCapacity : 0;
+        if (FirstValidCount > StartCount)
+        {
+            const uint64_t NumTorn = std::min<uint64_t>(FirstValidCount - StartCount, events.size());
+            events.erase(std::begin(events), std::begin(events) + NumTorn);
+        }
+
+        for (const ScopeEvent& Event : events)
+        {
+            originNs = std::min(originNs, Event.BeginNs);
+        }
+    }
+
+    size_t numEvents = 0;
+    std::fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    const char* pSeparator = "\n";
+    for (size_t i = 0; i < s_threadBuffers.size(); ++i)
+    {
+        const ThreadBuffer& Buffer = *s_threadBuffers[i];
+        if (!Buffer.ThreadName.empty())
+        {
+            std::fprintf(pFile, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                pSeparator, Buffer.ThreadId);
+            WriteEscapedString(pFile, Buffer.ThreadName.c_str());
+            std::fprintf(pFile, "}}");
+            pSeparator = ",\n";
+        }
+
+        for (const ScopeEvent& Event : threadEvents[i])
+        {
+            std::fprintf(pFile, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                pSeparator,
+                Buffer.ThreadId,
+                (Event.BeginNs - originNs) / 1000.0,
+                (Event.EndNs - Event.BeginNs) / 1000.0);
+            WriteEscapedString(pFile, Event.pName);
+            std::fputc('}', pFile);
+            pSeparator = ",\n";
+            ++numEvents;
+        }
+    }
+    std::fprintf(pFile, "\n]}\n");
+
+    const bool Succeeded = std::ferror(pFile) == 0;
+    std::fclose(pFile);
+    if (!Succeeded)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_DEFAULT, "Failed to write trace file: %s", filePath.c_str());
+        return false;
+    }
+
+    RELEASE_LOGLINE_INFO(LOG_DEFAULT, "Exported %zu profile events to %s", numEvents, filePath.c_str());
+    return true;
+}
@@ -0,0 +1,73 @@
+// profile.h
+//
+// Scoped timing zones. PROFILE_SCOPE("name") records the begin and end time of
+// the enclosing scope into a buffer owned by the calling thread; nothing is
+// shared between threads on the recording path. Buffers are rings, so a long
+// run keeps the most recent events, and can be exported to the Chrome
+// trace-event format (chrome://tracing, Perfetto) at any time.
+//
+// Zones compile out entirely unless FIVEDNINE_ENABLE_PROFILING is defined,
+// and cost a single relaxed load until profiling is enabled at runtime. Zone
+// names must be string literals (or otherwise outlive the export).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <fivednine/system/time.h>
+
+namespace fivednine { namespace profile {
+    void SetEnabled(bool enabled);
+
+    // Shows up as the track name in trace viewers
+    void SetThreadName(const char* pThreadName);
+
+    // Safe to call while other threads are recording
+    bool ExportChromeTrace(const std::string& filePath);
+
+    void RecordScope(const char* pName, uint64_t beginNs, uint64_t endNs);
+
+    namespace detail {
+        extern std::atomic<bool> g_isEnabled;
+    }
+
+    inline bool IsEnabled()
+    {
+        return detail::g_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* pName)
+            : m_pName(pName),
+              m_beginNs(IsEnabled() ? system::time::GetTicksNs() : 0)
+        {}
+
+        ~ProfileScope()
+        {
+            if (m_beginNs != 0)
+            {
+                RecordScope(m_pName, m_beginNs, system::time::GetTicksNs());
+            }
+        }
+
+    private:
+        ProfileScope(const ProfileScope& other) = delete;
+        ProfileScope& operator=(const ProfileScope& other) = delete;
+
+        const char* m_pName;
+        uint64_t    m_beginNs;
+    };
+}}
+
+#if defined(FIVEDNINE_ENABLE_PROFILING)
+    #define PROFILE_CONCAT_INNER(A, B) A##B
+    #define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+    #define PROFILE_SCOPE(Name) \
+        fivednine::profile::ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(Name)
+#else
+    #define PROFILE_SCOPE(Name) do {} while (0)
+#endif
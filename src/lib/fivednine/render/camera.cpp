@@ -2,6 +2,8 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+
 using namespace fivednine::render;
 
 const glm::vec3 Camera::kDefaultTranslation = glm::vec3(0.f);
@@ -21,6 +23,7 @@ Camera::Camera(
         m_upDirection(upDirection)
 {
     m_translationTarget = m_translation;
+    m_previousTranslation = m_translation;
 }
 
 glm::vec3 Camera::GetTranslation() const 
@@ -32,6 +35,7 @@ void Camera::SetTranslation(const glm::vec3& translation)
 {
     m_translation = translation;
     m_translationTarget = m_translation;
+    m_previousTranslation = m_translation;
 }
 
 void Camera::Translate(const glm::vec3& translationDelta) 
@@ -52,16 +56,38 @@ glm::mat4 Camera::ViewMatrix4() const
         m_upDirection);
 }
 
+glm::mat4 Camera::InterpolatedViewMatrix4(float alpha) const
+{
+    const glm::vec3 Translation = glm::mix(m_previousTranslation, m_translation, alpha);
+    return glm::lookAt(
+        Translation,
+        (Translation + m_forwardDirection),
+        m_upDirection);
+}
+
 void Camera::Tick(float dtSeconds)
 {
+    m_previousTranslation = m_translation;
+
     // TODO: Proper dampened spring model?
     // TODO: externally-configurable constants
-    const float kTranslationSpeed = 0.01f;
+    // Fraction of the remaining distance covered per second. Clamped so a
+    // large step can't overshoot the target.
+    const float kTranslationRate = 10.f;
     const glm::vec3 Delta = m_translationTarget - m_translation;
 
     const float kMinDistance = 0.001f;
-    if (Delta.length() > kMinDistance)
+    if (glm::length(Delta) > kMinDistance)
     {
-        m_translation += kTranslationSpeed * Delta * dtSeconds;
+        m_translation += Delta * std::min(kTranslationRate * dtSeconds, 1.f);
     }
-}
\ No newline at end of file
+    else
+    {
+        m_translation = m_translationTarget;
+    }
+}
+
+bool Camera::IsMoving() const
+{
+    return m_translation != m_translationTarget || m_translation != m_previousTranslation;
+}
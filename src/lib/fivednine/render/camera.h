@@ -21,10 +21,19 @@ namespace fivednine { namespace render {
 
         glm::mat4 ViewMatrix4() const;
 
+        // View between the translations before and after the last Tick(),
+        // for rendering in between fixed simulation steps
+        glm::mat4 InterpolatedViewMatrix4(float alpha) const;
+
         void Tick(float dtSeconds);
 
+        // False once the camera has reached its target and the last Tick()
+        // didn't move it, i.e. further frames would render identically
+        bool IsMoving() const;
+
     private:
         glm::vec3 m_translation;
+        glm::vec3 m_previousTranslation;
         glm::vec3 m_forwardDirection;
         glm::vec3 m_upDirection;
 
@@ -0,0 +1,116 @@
+#include "framelimiter.h"
+#include "rendercommon.h"
+
+#include <algorithm>
+
+#include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/system/time.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+namespace
+{
+    // Waits are retried in slices so that a lost context shows up as a
+    // logged stall instead of a silent hang
+    static constexpr GLuint64 kWaitSliceNs = 100000000ull; // 100ms
+}
+
+FrameLimiter::~FrameLimiter()
+{
+    while (m_numFences > 0)
+    {
+        glDeleteSync(static_cast<GLsync>(m_fences[m_oldestFenceIndex]));
+        m_oldestFenceIndex = (m_oldestFenceIndex + 1) % (kMaxFramesInFlightLimit + 1);
+        --m_numFences;
+    }
+}
+
+bool FrameLimiter::Initialize(uint32_t maxFramesInFlight)
+{
+    m_maxFramesInFlight = std::min(maxFramesInFlight, kMaxFramesInFlightLimit);
+    if (m_maxFramesInFlight == 0)
+    {
+        return true;
+    }
+
+    if (!GLEW_ARB_sync)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "ARB_sync unavailable, frames in flight won't be limited");
+        m_maxFramesInFlight = 0;
+        return false;
+    }
+
+    m_isSupported = true;
+    return true;
+}
+
+bool FrameLimiter::IsSupported() const
+{
+    return m_isSupported;
+}
+
+uint32_t FrameLimiter::GetMaxFramesInFlight() const
+{
+    return m_maxFramesInFlight;
+}
+
+uint64_t FrameLimiter::OnFramePresented()
+{
+    if (!m_isSupported || m_maxFramesInFlight == 0)
+    {
+        return 0;
+    }
+
+    PROFILE_SCOPE("FrameLimiter::OnFramePresented");
+    const uint32_t FenceIndex = (m_oldestFenceIndex + m_numFences) % (kMaxFramesInFlightLimit + 1);
+    m_fences[FenceIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (!m_fences[FenceIndex])
+    {
+        return 0;
+    }
+    ++m_numFences;
+
+    const uint64_t WaitStartNs = system::time::GetTicksNs();
+    while (m_numFences > m_maxFramesInFlight)
+    {
+        if (!WaitForOldestFence())
+        {
+            break;
+        }
+    }
+
+    return system::time::GetTicksNs() - WaitStartNs;
+}
+
+bool FrameLimiter::WaitForOldestFence()
+{
+    GLsync oldestFence = static_cast<GLsync>(m_fences[m_oldestFenceIndex]);
+
+    // Flushing on the first wait makes sure the fence actually reaches the
+    // GPU; later slices don't need to
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    GLenum waitResult;
+    while ((waitResult = glClientWaitSync(oldestFence, waitFlags, kWaitSliceNs)) == GL_TIMEOUT_EXPIRED)
+    {
+        RELEASE_LOGLINE_WARNING(
+            LOG_RENDER,
+            "Still waiting on a frame fence after %llu ms",
+            static_cast<unsigned long long>(kWaitSliceNs / 1000000ull));
+        waitFlags = 0;
+    }
+
+    glDeleteSync(oldestFence);
+    m_fences[m_oldestFenceIndex] = nullptr;
+    m_oldestFenceIndex = (m_oldestFenceIndex + 1) % (kMaxFramesInFlightLimit + 1);
+    --m_numFences;
+
+    if (waitResult == GL_WAIT_FAILED)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Waiting on a frame fence failed");
+        return false;
+    }
+
+    return true;
+}
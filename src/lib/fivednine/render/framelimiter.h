@@ -0,0 +1,42 @@
+// framelimiter.h
+//
+// Caps how many frames the CPU may get ahead of the GPU. Without a cap the
+// driver is free to queue several swaps, and every queued frame is a frame
+// of input latency. A fence goes in after each submitted frame; once more
+// than the limit are outstanding, the oldest is waited on. Requires
+// ARB_sync (core in 3.2); without it every call is a no-op.
+
+#pragma once
+
+#include <cstdint>
+
+namespace fivednine { namespace render {
+    class FrameLimiter
+    {
+    public:
+        static constexpr uint32_t kMaxFramesInFlightLimit = 4;
+
+        ~FrameLimiter();
+
+        // Zero leaves queueing up to the driver. Values above
+        // kMaxFramesInFlightLimit are clamped.
+        bool Initialize(uint32_t maxFramesInFlight);
+        bool IsSupported() const;
+        uint32_t GetMaxFramesInFlight() const;
+
+        // Call right after presenting. Fences the frame just submitted, then
+        // blocks until no more than the limit are still in flight. Returns
+        // how long it blocked.
+        uint64_t OnFramePresented();
+
+    private:
+        bool WaitForOldestFence();
+
+        // GLsync handles, kept opaque so GL headers stay out of this one
+        void*    m_fences[kMaxFramesInFlightLimit + 1] = {};
+        uint32_t m_oldestFenceIndex = 0;
+        uint32_t m_numFences = 0;
+        uint32_t m_maxFramesInFlight = 0;
+        bool     m_isSupported = false;
+    };
+}}
@@ -0,0 +1,84 @@
+#include "gputimer.h"
+#include "rendercommon.h"
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+GpuTimer::~GpuTimer()
+{
+    if (m_isSupported)
+    {
+        glDeleteQueries(kNumQueries, m_queryHandles);
+    }
+}
+
+bool GpuTimer::Initialize()
+{
+    if (!GLEW_ARB_timer_query)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "ARB_timer_query unavailable, GPU timings disabled");
+        return false;
+    }
+
+    glGenQueries(kNumQueries, m_queryHandles);
+    m_isSupported = true;
+    return true;
+}
+
+bool GpuTimer::IsSupported() const
+{
+    return m_isSupported;
+}
+
+void GpuTimer::Begin()
+{
+    RELEASE_CHECK(!m_isSpanOpen, "GPU timer span is already open");
+    if (!m_isSupported || m_numPending == kNumQueries)
+    {
+        return;
+    }
+
+    const uint32_t QueryIndex = (m_oldestPendingIndex + m_numPending) % kNumQueries;
+    glBeginQuery(GL_TIME_ELAPSED, m_queryHandles[QueryIndex]);
+    m_isSpanOpen = true;
+}
+
+void GpuTimer::End()
+{
+    if (!m_isSpanOpen)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    ++m_numPending;
+    m_isSpanOpen = false;
+}
+
+bool GpuTimer::PopResult(uint64_t* pElapsedNsOut)
+{
+    if (m_numPending == 0)
+    {
+        return false;
+    }
+
+    // Queries complete in order, so only the oldest needs checking
+    const uint32_t QueryHandle = m_queryHandles[m_oldestPendingIndex];
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(QueryHandle, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable != GL_TRUE)
+    {
+        return false;
+    }
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(QueryHandle, GL_QUERY_RESULT, &elapsedNs);
+    *pElapsedNsOut = static_cast<uint64_t>(elapsedNs);
+
+    m_oldestPendingIndex = (m_oldestPendingIndex + 1) % kNumQueries;
+    --m_numPending;
+    return true;
+}
@@ -0,0 +1,41 @@
+// gputimer.h
+//
+// Measures GPU time spent on a span of commands with GL_TIME_ELAPSED queries.
+// Queries are kept in a small ring and read back a few frames later, only
+// once the driver reports them available, so timing never stalls the
+// pipeline. Requires ARB_timer_query (core in 3.3); without it every call
+// is a no-op.
+
+#pragma once
+
+#include <cstdint>
+
+namespace fivednine { namespace render {
+    class GpuTimer
+    {
+    public:
+        // Results are typically available two frames after they're issued
+        static constexpr uint32_t kNumQueries = 4;
+
+        ~GpuTimer();
+
+        bool Initialize();
+        bool IsSupported() const;
+
+        // Brackets the commands to time. Only one span may be open at a
+        // time; if every query is still in flight the span is dropped.
+        void Begin();
+        void End();
+
+        // Returns the oldest finished measurement, if any. Call in a loop to
+        // drain everything that's ready.
+        bool PopResult(uint64_t* pElapsedNsOut);
+
+    private:
+        uint32_t m_queryHandles[kNumQueries] = {};
+        uint32_t m_oldestPendingIndex = 0;
+        uint32_t m_numPending = 0;
+        bool     m_isSupported = false;
+        bool     m_isSpanOpen = false;
+    };
+}}
@@ -0,0 +1,272 @@
+#include "headlesscontext.h"
+#include "rendercommon.h"
+
+#ifdef FIVEDNINE_ENABLE_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstring>
+
+#include <fivednine/log/log.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+#ifdef FIVEDNINE_ENABLE_HEADLESS
+namespace
+{
+    bool HasExtension(const char* pExtensions, const char* pExtensionName)
+    {
+        if (!pExtensions)
+        {
+            return false;
+        }
+
+        const size_t NameLength = strlen(pExtensionName);
+        const char* pCurrent = pExtensions;
+        while ((pCurrent = strstr(pCurrent, pExtensionName)) != nullptr)
+        {
+            const bool AtStart = pCurrent == pExtensions || pCurrent[-1] == ' ';
+            const bool AtEnd = pCurrent[NameLength] == ' ' || pCurrent[NameLength] == '\0';
+            if (AtStart && AtEnd)
+            {
+                return true;
+            }
+            pCurrent += NameLength;
+        }
+
+        return false;
+    }
+
+    EGLDisplay GetHeadlessDisplay()
+    {
+        // Prefer Mesa's surfaceless platform, which needs neither X nor a
+        // DRM device; fall back to whatever the default display is.
+        const char* pClientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (HasExtension(pClientExtensions, "EGL_EXT_platform_base") &&
+            HasExtension(pClientExtensions, "EGL_MESA_platform_surfaceless"))
+        {
+            auto pfnGetPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (pfnGetPlatformDisplay)
+            {
+                EGLDisplay display =
+                    pfnGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY)
+                {
+                    return display;
+                }
+            }
+        }
+
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    Destroy();
+}
+
+bool HeadlessContext::Initialize(uint32_t width, uint32_t height)
+{
+    Destroy();
+
+    EGLDisplay display = GetHeadlessDisplay();
+    if (display == EGL_NO_DISPLAY)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Failed to get an EGL display");
+        return false;
+    }
+
+    EGLint majorVersion, minorVersion;
+    if (!eglInitialize(display, &majorVersion, &minorVersion))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Failed to initialize EGL: 0x%x", eglGetError());
+        return false;
+    }
+    m_pDisplay = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "EGL implementation doesn't support desktop OpenGL");
+        Destroy();
+        return false;
+    }
+
+    const char* pDisplayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    const bool SupportsSurfaceless = HasExtension(pDisplayExtensions, "EGL_KHR_surfaceless_context");
+    if (!HasExtension(pDisplayExtensions, "EGL_KHR_create_context") && (majorVersion == 1 && minorVersion < 5))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "EGL %d.%d can't create core profile contexts", majorVersion, minorVersion);
+        Destroy();
+        return false;
+    }
+
+    const EGLint ConfigAttributes[] = {
+        EGL_SURFACE_TYPE, SupportsSurfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, ConfigAttributes, &config, 1, &numConfigs) || numConfigs < 1)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "No suitable EGL config: 0x%x", eglGetError());
+        Destroy();
+        return false;
+    }
+
+    // Same version and profile as the windowed context
+    const EGLint ContextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 2,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    m_pContext = eglCreateContext(display, config, EGL_NO_CONTEXT, ContextAttributes);
+    if (m_pContext == EGL_NO_CONTEXT)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Failed to create EGL context: 0x%x", eglGetError());
+        m_pContext = nullptr;
+        Destroy();
+        return false;
+    }
+
+    if (!SupportsSurfaceless)
+    {
+        // Never drawn to; only exists because the context needs a surface
+        // to be made current
+        const EGLint PbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        m_pSurface = eglCreatePbufferSurface(display, config, PbufferAttributes);
+        if (m_pSurface == EGL_NO_SURFACE)
+        {
+            RELEASE_LOGLINE_ERROR(LOG_RENDER, "Failed to create EGL pbuffer: 0x%x", eglGetError());
+            m_pSurface = nullptr;
+            Destroy();
+            return false;
+        }
+    }
+
+    EGLSurface surface = m_pSurface ? m_pSurface : EGL_NO_SURFACE;
+    if (!eglMakeCurrent(display, surface, surface, m_pContext))
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Failed to make EGL context current: 0x%x", eglGetError());
+        Destroy();
+        return false;
+    }
+
+    RELEASE_LOGLINE_INFO(
+        LOG_RENDER,
+        "Headless EGL %d.%d context (%s): %s",
+        majorVersion,
+        minorVersion,
+        SupportsSurfaceless ? "surfaceless" : "pbuffer",
+        eglQueryString(display, EGL_VENDOR));
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+bool HeadlessContext::CreateFramebuffer()
+{
+    if (!m_pContext)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Attempting to create a framebuffer without a context");
+        return false;
+    }
+
+    glGenRenderbuffers(1, &m_colorRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+
+    glGenRenderbuffers(1, &m_depthRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebufferId);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRenderbufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbufferId);
+
+    const GLenum Status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (Status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Offscreen framebuffer is incomplete: 0x%x", Status);
+        return false;
+    }
+
+    // Left bound; nothing else in the renderer binds framebuffers
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_pDisplay)
+    {
+        return;
+    }
+
+    if (m_pContext)
+    {
+        if (m_framebufferId != 0)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &m_framebufferId);
+            glDeleteRenderbuffers(1, &m_colorRenderbufferId);
+            glDeleteRenderbuffers(1, &m_depthRenderbufferId);
+            m_framebufferId = 0;
+            m_colorRenderbufferId = 0;
+            m_depthRenderbufferId = 0;
+        }
+
+        eglMakeCurrent(m_pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_pDisplay, m_pContext);
+        m_pContext = nullptr;
+    }
+
+    if (m_pSurface)
+    {
+        eglDestroySurface(m_pDisplay, m_pSurface);
+        m_pSurface = nullptr;
+    }
+
+    eglTerminate(m_pDisplay);
+    m_pDisplay = nullptr;
+}
+
+#else
+// Built without EGL (see external/OpenGL.cmake)
+HeadlessContext::~HeadlessContext() = default;
+
+bool HeadlessContext::Initialize(uint32_t /* width */, uint32_t /* height */)
+{
+    RELEASE_LOGLINE_ERROR(LOG_RENDER, "Headless rendering needs EGL, which this build doesn't have");
+    return false;
+}
+
+bool HeadlessContext::CreateFramebuffer()
+{
+    return false;
+}
+
+void HeadlessContext::Destroy()
+{
+}
+#endif
+
+uint32_t HeadlessContext::GetWidth() const
+{
+    return m_width;
+}
+
+uint32_t HeadlessContext::GetHeight() const
+{
+    return m_height;
+}
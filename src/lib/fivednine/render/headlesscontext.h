@@ -0,0 +1,49 @@
+// headlesscontext.h
+//
+// Offscreen GL context for running without a display (benchmarks, CI under
+// Mesa's software rasterizer). Built on EGL: a surfaceless context where the
+// driver supports one, a 1x1 pbuffer otherwise. Either way rendering goes to
+// a framebuffer object of the requested size which stays bound as the
+// default draw target, so callers can't tell the difference.
+//
+// Builds without EGL get a HeadlessContext whose Initialize() always fails.
+
+#pragma once
+
+#include <cstdint>
+
+namespace fivednine { namespace render {
+    class HeadlessContext
+    {
+    public:
+        HeadlessContext() = default;
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        // Creates a 3.2 core context and makes it current
+        bool Initialize(uint32_t width, uint32_t height);
+
+        // Needs GL entry points, so call after the context is current and
+        // GLEW has been initialized
+        bool CreateFramebuffer();
+
+        void Destroy();
+
+        uint32_t GetWidth() const;
+        uint32_t GetHeight() const;
+
+    private:
+        void* m_pDisplay = nullptr;
+        void* m_pContext = nullptr;
+        void* m_pSurface = nullptr;
+
+        uint32_t m_framebufferId = 0;
+        uint32_t m_colorRenderbufferId = 0;
+        uint32_t m_depthRenderbufferId = 0;
+
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+    };
+}}
@@ -0,0 +1,100 @@
+#include "imagedecoder.h"
+
+#include <png.h>
+
+#include <climits>
+#include <cstring>
+
+#include <fivednine/log/log.h>
+
+using namespace fivednine;
+using namespace fivednine::render;
+
+struct ImageDecoder::DecoderState
+{
+    png_image Image;
+};
+
+ImageDecoder::ImageDecoder() = default;
+
+ImageDecoder::~ImageDecoder()
+{
+    Close();
+}
+
+bool ImageDecoder::Open(const std::string& imagePath, ImageHeader* pHeaderOut)
+{
+    Close();
+
+    m_spState.reset(new DecoderState);
+    png_image& image = m_spState->Image;
+    std::memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&image, imagePath.c_str()))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to read image %s: %s", imagePath.c_str(), image.message);
+        Close();
+        return false;
+    }
+
+    // Anything with alpha (including tRNS chunks) becomes RGBA; everything
+    // else RGB, which saves a quarter of the upload for opaque cover art.
+    const bool HasAlpha = (image.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+    image.format = HasAlpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+
+    m_imagePath = imagePath;
+    pHeaderOut->Width = image.width;
+    pHeaderOut->Height = image.height;
+    pHeaderOut->Channels = PNG_IMAGE_PIXEL_CHANNELS(image.format);
+    return true;
+}
+
+bool ImageDecoder::DecodeInto(uint8_t* pDestination, size_t rowPitchBytes)
+{
+    if (!m_spState)
+    {
+        RELEASE_LOGLINE_ERROR(LOG_RENDER, "Attempting to decode without an open image");
+        return false;
+    }
+
+    png_image& image = m_spState->Image;
+    const size_t MinRowPitchBytes = PNG_IMAGE_ROW_STRIDE(image);
+    if (!pDestination || rowPitchBytes < MinRowPitchBytes || rowPitchBytes > INT_MAX)
+    {
+        RELEASE_LOGLINE_ERROR(
+            LOG_RENDER,
+            "Invalid destination for image %s (row pitch %zu, need %zu)",
+            m_imagePath.c_str(),
+            rowPitchBytes,
+            MinRowPitchBytes);
+        Close();
+        return false;
+    }
+
+    // finish_read releases libpng's state whether or not it succeeds
+    const bool Succeeded = png_image_finish_read(
+        &image,
+        nullptr /* background */,
+        pDestination,
+        static_cast<png_int_32>(rowPitchBytes),
+        nullptr /* colormap */) != 0;
+    if (!Succeeded)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to decode image %s: %s", m_imagePath.c_str(), image.message);
+    }
+
+    m_spState.reset();
+    m_imagePath.clear();
+    return Succeeded;
+}
+
+void ImageDecoder::Close()
+{
+    if (m_spState)
+    {
+        png_image_free(&m_spState->Image);
+        m_spState.reset();
+    }
+    m_imagePath.clear();
+}
@@ -0,0 +1,45 @@
+// imagedecoder.h
+//
+// Decodes PNG images directly into caller-provided memory (a mapped pixel
+// buffer, a reusable staging buffer, ...) so that no intermediate image is
+// kept around. Palette, grayscale and 16-bit images are converted to 8-bit
+// RGB or RGBA while decoding.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace fivednine { namespace render {
+    struct ImageHeader
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        uint32_t Channels = 0; // 3 (RGB) or 4 (RGBA)
+    };
+
+    class ImageDecoder
+    {
+    public:
+        ImageDecoder();
+        ~ImageDecoder();
+
+        // Reads only the image header; pixels are decoded by DecodeInto().
+        bool Open(const std::string& imagePath, ImageHeader* pHeaderOut);
+
+        // Decodes the opened image into pDestination, which must hold
+        // rowPitchBytes * Height bytes. rowPitchBytes must be at least
+        // Width * Channels. The decoder is closed afterwards either way.
+        bool DecodeInto(uint8_t* pDestination, size_t rowPitchBytes);
+
+        // Releases decoder state without decoding. Safe to call repeatedly.
+        void Close();
+
+    private:
+        struct DecoderState;
+        std::unique_ptr<DecoderState> m_spState;
+        std::string m_imagePath;
+    };
+}}
@@ -7,6 +7,7 @@
 
 #include <fivednine/render/uniform.h>
 #include <fivednine/log/log.h>
+#include <fivednine/profile/profile.h>
 
 using namespace fivednine::render;
 
@@ -218,6 +219,7 @@ void Mesh::SetMeshUniforms(const std::vector<MeshUniformValue>& uniformValues)
 
 void Mesh::Draw(const glm::mat4& projMatrix, const glm::mat4& viewMatrix) 
 {
+    PROFILE_SCOPE("Mesh::Draw");
     if (!GetVisibility())
     {
         // Nothing to do if we're not visible
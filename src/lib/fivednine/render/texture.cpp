@@ -28,4 +28,24 @@ namespace fivednine { namespace render {
     {
         return m_handle;
     }
+
+    uint32_t Texture::GetWidth() const
+    {
+        return m_width;
+    }
+
+    uint32_t Texture::GetHeight() const
+    {
+        return m_height;
+    }
+
+    uint32_t Texture::GetChannels() const
+    {
+        return m_channels;
+    }
+
+    uint64_t Texture::GetEstimatedSizeBytes() const
+    {
+        return static_cast<uint64_t>(m_width) * m_height * m_channels;
+    }
 }}
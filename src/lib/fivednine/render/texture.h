@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -29,6 +30,14 @@ namespace fivednine { namespace render {
         const std::string& GetName() const;
         const uint32_t GetHandle() const;
 
+        uint32_t GetWidth() const;
+        uint32_t GetHeight() const;
+        uint32_t GetChannels() const;
+
+        // Size of the level 0 image as uploaded; the driver's actual
+        // footprint may differ with padding or internal formats
+        uint64_t GetEstimatedSizeBytes() const;
+
     private:
         Texture() = delete;
 
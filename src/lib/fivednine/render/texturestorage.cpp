@@ -1,9 +1,6 @@
 #include "texturestorage.h"
 #include "rendercommon.h"
 
-#include <SDL.h>
-#include <SDL_image.h>
-
 #include <algorithm>
 
 #include <fivednine/log/log.h>
@@ -28,27 +25,95 @@ namespace {
 using namespace fivednine;
 using namespace fivednine::render;
 
+TextureStorage::~TextureStorage()
+{
+    ReleaseStagingMemory();
+}
+
 bool 
 TextureStorage::AddTextureFromImagePath(
     const std::string& imagePath,
     const std::string& textureName
     )
 {
-    SDL_Surface* pSurface = IMG_Load(imagePath.c_str());
-    if (!pSurface)
+    Texture* pTexture = LoadTextureFromImagePath(imagePath, textureName);
+    if (!pTexture || !AddResource(pTexture))
     {
-        RELEASE_LOG_WARNING(LOG_RENDER, "Failed to load image from path: %s", imagePath.c_str());
+        delete pTexture;
         return false;
     }
 
-    ImageData imageData {
-        static_cast<uint32_t>(pSurface->w),
-        static_cast<uint32_t>(pSurface->h),
-        pSurface->format->BytesPerPixel,
-        static_cast<uint8_t*>(pSurface->pixels)
-    };
+    return true;
+}
+
+TextureHandle
+TextureStorage::AddStreamedTextureFromImagePath(
+    const std::string& imagePath,
+    const std::string& textureName
+    )
+{
+    const TextureHandle NewTextureHandle = static_cast<TextureHandle>(m_storageVector.size() + 1);
+    if (!m_handlesByName.emplace(textureName, NewTextureHandle).second)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to add texture %s to storage: already exists.", textureName.c_str());
+        return kInvalidTextureHandle;
+    }
+
+    m_storageVector.emplace_back(nullptr);
+    m_streamedTextures[NewTextureHandle] = StreamedTexture{ imagePath, textureName, {} };
+    return NewTextureHandle;
+}
+
+Texture*
+TextureStorage::LoadTextureFromImagePath(
+    const std::string& imagePath,
+    const std::string& textureName
+    )
+{
+    ImageDecoder decoder;
+    ImageHeader header;
+    if (!decoder.Open(imagePath, &header))
+    {
+        RELEASE_LOG_WARNING(LOG_RENDER, "Failed to load image from path: %s", imagePath.c_str());
+        return nullptr;
+    }
+
+    // Rows are tightly packed to match GL_UNPACK_ALIGNMENT of 1
+    const size_t RowPitchBytes = static_cast<size_t>(header.Width) * header.Channels;
+    const size_t ImageSizeBytes = RowPitchBytes * header.Height;
+
+    ImageData imageData { header.Width, header.Height, header.Channels, nullptr };
+    if (!m_pixelBufferFailed)
+    {
+        if (DecodeIntoPixelBuffer(&decoder, ImageSizeBytes, RowPitchBytes))
+        {
+            Texture* pTexture = UploadTexture(imageData, textureName);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return pTexture;
+        }
+
+        if (!m_pixelBufferFailed)
+        {
+            RELEASE_LOG_WARNING(LOG_RENDER, "Failed to decode image from path: %s", imagePath.c_str());
+            return nullptr;
+        }
+
+        // Falling back to client memory for this and all later textures.
+        // The decoder may have been consumed, so restart from the header.
+        if (!decoder.Open(imagePath, &header))
+        {
+            return nullptr;
+        }
+    }
+
+    if (!DecodeIntoStagingBytes(&decoder, ImageSizeBytes, RowPitchBytes))
+    {
+        RELEASE_LOG_WARNING(LOG_RENDER, "Failed to decode image from path: %s", imagePath.c_str());
+        return nullptr;
+    }
 
-    return AddTexture(imageData, textureName);
+    imageData.pBytes = m_stagingBytes.data();
+    return UploadTexture(imageData, textureName);
 }
 
 bool 
@@ -56,6 +121,100 @@ TextureStorage::AddTexture(
     const ImageData& imageData,
     const std::string& textureName
     )
+{
+    if (!imageData.pBytes)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Texture named '%s' has no pixel data.", textureName.c_str());
+        return false;
+    }
+
+    Texture* pTexture = UploadTexture(imageData, textureName);
+    if (!AddResource(pTexture))
+    {
+        delete pTexture;
+        return false;
+    }
+
+    return true;
+}
+
+void TextureStorage::ReleaseStagingMemory()
+{
+    if (m_pixelBufferHandle != 0)
+    {
+        glDeleteBuffers(1, &m_pixelBufferHandle);
+        m_pixelBufferHandle = 0;
+    }
+
+    // clear() keeps the capacity around
+    std::vector<uint8_t>().swap(m_stagingBytes);
+}
+
+bool
+TextureStorage::DecodeIntoPixelBuffer(
+    ImageDecoder* pDecoder,
+    size_t imageSizeBytes,
+    size_t rowPitchBytes
+    )
+{
+    if (m_pixelBufferHandle == 0)
+    {
+        glGenBuffers(1, &m_pixelBufferHandle);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBufferHandle);
+
+    // Respecifying the store orphans the previous one, so there's no stall
+    // waiting for the last upload to finish reading it.
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, imageSizeBytes, nullptr, GL_STREAM_DRAW);
+    uint8_t* pMapped = static_cast<uint8_t*>(
+        glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER,
+            0, imageSizeBytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!pMapped)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to map pixel unpack buffer, decoding into client memory instead");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        m_pixelBufferFailed = true;
+        return false;
+    }
+
+    const bool Decoded = pDecoder->DecodeInto(pMapped, rowPitchBytes);
+
+    // The contents are undefined if unmapping fails (e.g. the store was
+    // lost during a mode switch)
+    const bool Unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    if (!Decoded || !Unmapped)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        m_pixelBufferFailed = m_pixelBufferFailed || !Unmapped;
+        return false;
+    }
+
+    return true;
+}
+
+bool
+TextureStorage::DecodeIntoStagingBytes(
+    ImageDecoder* pDecoder,
+    size_t imageSizeBytes,
+    size_t rowPitchBytes
+    )
+{
+    // Reused across textures; only grows
+    if (m_stagingBytes.size() < imageSizeBytes)
+    {
+        m_stagingBytes.resize(imageSizeBytes);
+    }
+
+    return pDecoder->DecodeInto(m_stagingBytes.data(), rowPitchBytes);
+}
+
+Texture*
+TextureStorage::UploadTexture(
+    const ImageData& imageData,
+    const std::string& textureName
+    )
 {
     // Check to see if dimensions are a power of two.
     if (!IsIntegerPowerOfTwo(imageData.Width) || !IsIntegerPowerOfTwo(imageData.Height))
@@ -92,41 +251,104 @@ TextureStorage::AddTexture(
         GL_UNSIGNED_BYTE,
         imageData.pBytes);
 
-    Texture* pTexture = 
+    return
         new Texture(
             textureName,
                 textureId,
                 imageData.Width,
                 imageData.Height,
                 imageData.Depth);
-    if (!AddResource(pTexture))
+}
+
+TexturePtr 
+TextureStorage::FindTextureByName(const std::string& textureName) const
+{
+    return GetTextureByHandle(FindTextureHandle(textureName));
+}
+
+TextureHandle
+TextureStorage::FindTextureHandle(const std::string& textureName) const
+{
+    const auto It = m_handlesByName.find(textureName);
+    return It != m_handlesByName.end() ? It->second : kInvalidTextureHandle;
+}
+
+TexturePtr
+TextureStorage::GetTextureByHandle(TextureHandle textureHandle) const
+{
+    if (!IsValidTextureHandle(textureHandle))
+    {
+        return nullptr;
+    }
+
+    if (const TexturePtr& spTexture = m_storageVector[textureHandle - 1])
+    {
+        return spTexture;
+    }
+
+    return m_streamedTextures.at(textureHandle).wpTexture.lock();
+}
+
+bool TextureStorage::IsValidTextureHandle(TextureHandle textureHandle) const
+{
+    return textureHandle != kInvalidTextureHandle && textureHandle <= m_storageVector.size();
+}
+
+bool TextureStorage::IsTextureResident(TextureHandle textureHandle) const
+{
+    if (!IsValidTextureHandle(textureHandle))
     {
-        delete pTexture;
         return false;
     }
 
-    return true;
+    return m_storageVector[textureHandle - 1] || !m_streamedTextures.at(textureHandle).wpTexture.expired();
 }
 
-TexturePtr 
-TextureStorage::FindTextureByName(const std::string& textureName) const
+TexturePtr TextureStorage::AcquireTexture(TextureHandle textureHandle)
+{
+    if (TexturePtr spTexture = GetTextureByHandle(textureHandle))
+    {
+        return spTexture;
+    }
+
+    const auto It = m_streamedTextures.find(textureHandle);
+    if (It == m_streamedTextures.end())
+    {
+        return nullptr;
+    }
+
+    // Failures are retried on the next acquire, in case the file comes back
+    StreamedTexture& streamedTexture = It->second;
+    TexturePtr spTexture(LoadTextureFromImagePath(streamedTexture.ImagePath, streamedTexture.TextureName));
+    streamedTexture.wpTexture = spTexture;
+    return spTexture;
+}
+
+size_t TextureStorage::GetNumTextures() const
+{
+    return m_storageVector.size();
+}
+
+uint64_t TextureStorage::GetEstimatedVramBytes() const
 {
-    for (const TexturePtr& spTexture : m_storageVector)
+    uint64_t totalBytes = 0;
+    for (TextureHandle textureHandle = 1; textureHandle <= m_storageVector.size(); ++textureHandle)
     {
-        if (spTexture->GetName() == textureName)
+        if (const TexturePtr spTexture = GetTextureByHandle(textureHandle))
         {
-            return spTexture;
+            totalBytes += spTexture->GetEstimatedSizeBytes();
         }
     }
 
-    return nullptr;
+    return totalBytes;
 }
 
 bool TextureStorage::AddResource(Texture* pTexture)
 {
     if (!pTexture) { return false; }
 
-    if (!FindTextureByName(pTexture->GetName()))
+    const TextureHandle NewTextureHandle = static_cast<TextureHandle>(m_storageVector.size() + 1);
+    if (m_handlesByName.emplace(pTexture->GetName(), NewTextureHandle).second)
     {
         m_storageVector.emplace_back(pTexture);
         RELEASE_LOGLINE_INFO(LOG_RENDER, "Added texture to storage: %s", pTexture->GetName().c_str());
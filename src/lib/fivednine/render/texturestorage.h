@@ -1,12 +1,19 @@
 #pragma once
 
 #include "texture.h"
+#include "imagedecoder.h"
 
 #include <string>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace fivednine { namespace render {
+    // Stable for the lifetime of the storage, and cheaper to pass around
+    // than names. Never zero, so zero can mean "no texture".
+    typedef uint32_t TextureHandle;
+    static constexpr TextureHandle kInvalidTextureHandle = 0;
+
     struct ImageData 
     {
         uint32_t Width;
@@ -18,6 +25,10 @@ namespace fivednine { namespace render {
     class TextureStorage 
     {
     public:
+        ~TextureStorage();
+
+        // Decodes straight into a mapped pixel unpack buffer, so the only
+        // CPU-side copy of the image is the one the driver hands us.
         bool 
         AddTextureFromImagePath(
             const std::string& imagePath,
@@ -30,15 +41,70 @@ namespace fivednine { namespace render {
             const std::string& textureName
             );
 
+        // Reserves a handle for an image which isn't loaded until it's
+        // acquired, and is freed again once nothing holds it. For large sets
+        // of textures of which only a few are in use at once, like covers.
+        TextureHandle
+        AddStreamedTextureFromImagePath(
+            const std::string& imagePath,
+            const std::string& textureName
+            );
+
+        // Resident textures only; see AcquireTexture
         TexturePtr FindTextureByName(const std::string& textureName) const;
 
+        TextureHandle FindTextureHandle(const std::string& textureName) const;
+        TexturePtr    GetTextureByHandle(TextureHandle textureHandle) const;
+        bool          IsValidTextureHandle(TextureHandle textureHandle) const;
+
+        // False for a streamed texture that nothing is holding
+        bool IsTextureResident(TextureHandle textureHandle) const;
+
+        // As GetTextureByHandle, but loads a streamed texture that isn't
+        // resident. Null if that fails.
+        TexturePtr AcquireTexture(TextureHandle textureHandle);
+
+        size_t GetNumTextures() const;
+
+        // Sum of the resident textures' estimated sizes
+        uint64_t GetEstimatedVramBytes() const;
+
+        // Frees the staging buffers used by AddTextureFromImagePath. Call
+        // once a batch of textures has been loaded.
+        void ReleaseStagingMemory();
+
     private:
+        struct StreamedTexture
+        {
+            std::string            ImagePath;
+            std::string            TextureName;
+            std::weak_ptr<Texture> wpTexture;
+        };
+
         virtual bool AddResource(Texture* pTexture);
 
-        // Using a vector for now because I don't anticipate using many 
-        // textures in the foreseeable future; linear operations are
-        // probably preferable, and we can change that if this things grow in
-        // scope and this assumption ever becomes untrue.
+        // Null if the image can't be loaded. The caller owns the texture.
+        Texture* LoadTextureFromImagePath(const std::string& imagePath, const std::string& textureName);
+
+        // Uploads from client memory, or from the bound pixel unpack buffer
+        // when imageData.pBytes is null. The caller owns the texture.
+        Texture* UploadTexture(const ImageData& imageData, const std::string& textureName);
+
+        bool DecodeIntoPixelBuffer(ImageDecoder* pDecoder, size_t imageSizeBytes, size_t rowPitchBytes);
+        bool DecodeIntoStagingBytes(ImageDecoder* pDecoder, size_t imageSizeBytes, size_t rowPitchBytes);
+
+        uint32_t             m_pixelBufferHandle = 0;
+        bool                 m_pixelBufferFailed = false;
+        std::vector<uint8_t> m_stagingBytes;
+
+        // Indexed by handle - 1. Textures are never removed, so positions
+        // are stable. Null for streamed textures, which are held weakly in
+        // m_streamedTextures instead.
         std::vector<TexturePtr> m_storageVector;
+        std::unordered_map<TextureHandle, StreamedTexture> m_streamedTextures;
+
+        // Every game's cover is looked up by name, so a linear scan here
+        // made loading a library quadratic in its size
+        std::unordered_map<std::string, TextureHandle> m_handlesByName;
     };
 }}
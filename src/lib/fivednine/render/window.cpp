@@ -1,55 +1,37 @@
 #include "window.h"
 #include "color.h"
+#include "headlesscontext.h"
 #include "rendercommon.h"
+#include <fivednine/input/inputmapping.h>
 #include <fivednine/log/log.h>
 #include <fivednine/log/check.h>
+#include <fivednine/profile/profile.h>
+#include <fivednine/system/time.h>
 
 #include <SDL.h>
 
+#include <algorithm>
+#include <string>
+
 using namespace fivednine;
 using namespace fivednine::render;
 
 namespace 
 {
-    Window::EventType SDLTofivednineEvent(Uint32 sdlType)
-    {
-        switch (sdlType)
-        {
-            case SDL_QUIT:
-                return Window::EventType::Quit;
-            case SDL_KEYDOWN:
-                return Window::EventType::KeyDown;
-            case SDL_KEYUP:
-                return Window::EventType::KeyUp;
-            default:
-                return Window::EventType::Invalid;
-        }
-    }
-
-    Window::KeyType SDLKeySymToKeyType(SDL_Keycode sdlKeyType)
-    {
-        switch (sdlKeyType)
-        {
-            case SDLK_a:
-                return Window::KeyType::A;
-            case SDLK_d:
-                return Window::KeyType::D;
-            case SDLK_q:
-                return Window::KeyType::Q;
-            case SDLK_LEFT:
-                return Window::KeyType::Left;
-            case SDLK_RIGHT:
-                return Window::KeyType::Right;
-            default:
-                return Window::KeyType::Invalid;
-        }
-    }
+    // Analog sticks count as pushed once they're past halfway
+    static constexpr int32_t kGamepadAxisThreshold = 16384;
 }
 
-Window::Window(const char* pWindowName, uint32_t width, uint32_t height, bool fullScreen)
+Window::Window(const char* pWindowName, uint32_t width, uint32_t height, bool fullScreen, bool headless)
 {
     RELEASE_CHECK(pWindowName != nullptr, "Window requires a name");
 
+    if (headless)
+    {
+        InitializeHeadless(width, height);
+        return;
+    }
+
     SDL_ShowCursor(SDL_DISABLE);
 
     Uint32 CreateWindowFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL;
@@ -90,44 +72,247 @@ Window::Window(const char* pWindowName, uint32_t width, uint32_t height, bool fu
     }
 
     glViewport(0.f, 0.f, width, height);
+
+    // Not fatal; the keyboard still works. Controllers already connected are
+    // reported as added by the first PollEvents().
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to initialize SDL game controllers: %s", SDL_GetError());
+    }
+
+    RegisterWakeEvent();
 }
 
 Window::~Window()
 {
-    SDL_DestroyWindow(m_pWindow);
-    m_pWindow = nullptr;
+    for (Gamepad& gamepad : m_gamepads)
+    {
+        SDL_GameControllerClose(gamepad.pController);
+    }
+    m_gamepads.clear();
+
+    if (m_spHeadlessContext)
+    {
+        m_spHeadlessContext->Destroy();
+        m_spHeadlessContext.reset();
+    }
+
+    if (m_pWindow)
+    {
+        SDL_DestroyWindow(m_pWindow);
+        m_pWindow = nullptr;
+    }
 
     // TODO: Does this really belong here?
     SDL_Quit();
 }
 
-Window::EventType Window::PollEvents() const
+bool Window::IsHeadless() const
+{
+    return m_spHeadlessContext != nullptr;
+}
+
+size_t Window::PollEvents(WindowEvent* pEventsOut, size_t maxEvents)
+{
+    PROFILE_SCOPE("Window::PollEvents");
+    SDL_PumpEvents();
+
+    SDL_Event eventBatch[kEventBatchSize];
+    size_t numEventsOut = 0;
+    while (numEventsOut < maxEvents)
+    {
+        // Each SDL event reports at most one window event, so never take
+        // more than there's room left for; the rest stay queued
+        const int MaxBatchEvents = static_cast<int>(std::min(kEventBatchSize, maxEvents - numEventsOut));
+        const int NumBatchEvents = SDL_PeepEvents(eventBatch, MaxBatchEvents, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+        if (NumBatchEvents < 0)
+        {
+            RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to read SDL events: %s", SDL_GetError());
+            break;
+        }
+
+        const uint64_t ReceivedNs = system::time::GetTicksNs();
+        for (int i = 0; i < NumBatchEvents; ++i)
+        {
+            WindowEvent windowEvent;
+            if (!TranslateEvent(eventBatch[i], ReceivedNs, &windowEvent))
+            {
+                continue;
+            }
+
+            for (const EventListener& listener : m_eventListeners)
+            {
+                listener.pfnHandler(windowEvent, listener.pUserPointer);
+            }
+            pEventsOut[numEventsOut++] = windowEvent;
+        }
+
+        if (NumBatchEvents < MaxBatchEvents)
+        {
+            break;
+        }
+    }
+
+    return numEventsOut;
+}
+
+void Window::AddEventListener(FnWindowEventHandler pfnHandler, void* pUserPointer)
+{
+    RELEASE_CHECK(pfnHandler != nullptr, "pfnHandler cannot be null");
+
+    EventListener listener;
+    listener.pfnHandler = pfnHandler;
+    listener.pUserPointer = pUserPointer;
+    m_eventListeners.push_back(listener);
+}
+
+void Window::RemoveEventListener(FnWindowEventHandler pfnHandler, void* pUserPointer)
+{
+    auto it = std::find_if(std::begin(m_eventListeners), std::end(m_eventListeners),
+        [pfnHandler, pUserPointer](const EventListener& listener)
+        {
+            return listener.pfnHandler == pfnHandler && listener.pUserPointer == pUserPointer;
+        });
+    if (it != std::end(m_eventListeners))
+    {
+        m_eventListeners.erase(it);
+    }
+}
+
+bool Window::TranslateEvent(const SDL_Event& e, uint64_t receivedNs, WindowEvent* pWindowEventOut)
+{
+    if (m_wakeEventType != 0 && e.type == m_wakeEventType)
+    {
+        pWindowEventOut->Type = EventType::Wake;
+        return true;
+    }
+
+    const bool IsTranslating = m_isSdlInputEnabled && m_pInputMapping && m_pfnInputEventHandler;
+    const bool IsTranslatingGamepads = IsTranslating && m_isSdlGamepadInputEnabled;
+    switch (e.type)
+    {
+        case SDL_QUIT:
+            pWindowEventOut->Type = EventType::Quit;
+            return true;
+        case SDL_WINDOWEVENT:
+            return TranslateWindowEvent(e, pWindowEventOut);
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            // Key repeat is left to the action repeater
+            if (IsTranslating && !e.key.repeat)
+            {
+                m_keyboardState.OnControl(
+                    static_cast<uint32_t>(e.key.keysym.sym),
+                    e.type == SDL_KEYDOWN,
+                    receivedNs,
+                    m_pfnInputEventHandler,
+                    m_pUserPointer);
+            }
+            return false;
+        case SDL_CONTROLLERDEVICEADDED:
+            if (m_isSdlInputEnabled && m_isSdlGamepadInputEnabled && m_pInputMapping)
+            {
+                OpenGamepad(e.cdevice.which);
+            }
+            return false;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            CloseGamepad(e.cdevice.which);
+            return false;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        {
+            Gamepad* pGamepad = FindGamepad(e.cbutton.which);
+            if (IsTranslatingGamepads && pGamepad)
+            {
+                pGamepad->DeviceState.OnControl(
+                    e.cbutton.button,
+                    e.type == SDL_CONTROLLERBUTTONDOWN,
+                    receivedNs,
+                    m_pfnInputEventHandler,
+                    m_pUserPointer);
+            }
+            return false;
+        }
+        case SDL_CONTROLLERAXISMOTION:
+        {
+            Gamepad* pGamepad = FindGamepad(e.caxis.which);
+            if (IsTranslatingGamepads && pGamepad)
+            {
+                pGamepad->DeviceState.OnAxis(
+                    e.caxis.axis,
+                    e.caxis.value,
+                    -kGamepadAxisThreshold,
+                    kGamepadAxisThreshold,
+                    receivedNs,
+                    m_pfnInputEventHandler,
+                    m_pUserPointer);
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+bool Window::TranslateWindowEvent(const SDL_Event& e, WindowEvent* pWindowEventOut)
 {
-    SDL_Event e;
-    if (SDL_PollEvent(&e))
+    switch (e.window.event)
     {
-        const Window::EventType EventType = SDLTofivednineEvent(e.type);
-        switch (EventType)
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+            // Sent for every size change, whether or not the user made it
+            pWindowEventOut->Type = EventType::Resized;
+            pWindowEventOut->Width = static_cast<uint32_t>(e.window.data1);
+            pWindowEventOut->Height = static_cast<uint32_t>(e.window.data2);
+            glViewport(0, 0, e.window.data1, e.window.data2);
+            return true;
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+            pWindowEventOut->Type = EventType::FocusGained;
+            return true;
+        case SDL_WINDOWEVENT_FOCUS_LOST:
         {
-            case Window::EventType::KeyUp:
-                // Fallthrough
-            case Window::EventType::KeyDown:
-                if (m_pfnKeyStateChanged)
+            // SDL releases held keys when focus goes, but gamepad releases
+            // go unreported while unfocused and would leave actions held
+            if (m_pfnInputEventHandler)
+            {
+                const uint64_t ReleasedNs = system::time::GetTicksNs();
+                for (Gamepad& gamepad : m_gamepads)
                 {
-                    m_pfnKeyStateChanged(
-                        EventType,
-                        SDLKeySymToKeyType(e.key.keysym.sym),
-                        m_pUserPointer);
+                    gamepad.DeviceState.ReleaseAll(ReleasedNs, m_pfnInputEventHandler, m_pUserPointer);
                 }
-                break;
-            default:
-                break;
+            }
+            pWindowEventOut->Type = EventType::FocusLost;
+            return true;
         }
+        case SDL_WINDOWEVENT_EXPOSED:
+            pWindowEventOut->Type = EventType::Exposed;
+            return true;
+        default:
+            return false;
+    }
+}
 
-        return EventType;
+bool Window::WaitForEvents(int32_t timeoutMs) const
+{
+    if (timeoutMs < 0)
+    {
+        return SDL_WaitEvent(nullptr) == 1;
     }
 
-    return Window::EventType::None;
+    return SDL_WaitEventTimeout(nullptr, timeoutMs) == 1;
+}
+
+void Window::PostWakeEvent() const
+{
+    if (m_wakeEventType == 0)
+    {
+        return;
+    }
+
+    // SDL_PushEvent is thread-safe
+    SDL_Event wakeEvent;
+    SDL_zero(wakeEvent);
+    wakeEvent.type = m_wakeEventType;
+    SDL_PushEvent(&wakeEvent);
 }
 
 void Window::Clear(const ColorRGB& clearColor) const
@@ -138,9 +323,49 @@ void Window::Clear(const ColorRGB& clearColor) const
 
 void Window::Update() const
 {
+    PROFILE_SCOPE("Window::Update");
+    if (m_spHeadlessContext)
+    {
+        glFlush();
+        return;
+    }
+
     SDL_GL_SwapWindow(m_pWindow);
 }
 
+void Window::Finish() const
+{
+    glFinish();
+}
+
+bool Window::SetVSyncMode(VSyncMode vsyncMode) const
+{
+    if (m_spHeadlessContext)
+    {
+        return true;
+    }
+
+    // Late swap tearing is requested with a negative interval
+    if (vsyncMode == VSyncMode::Adaptive)
+    {
+        if (SDL_GL_SetSwapInterval(-1) == 0)
+        {
+            return true;
+        }
+
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Adaptive vsync unsupported, falling back to vsync: %s", SDL_GetError());
+        vsyncMode = VSyncMode::On;
+    }
+
+    if (SDL_GL_SetSwapInterval(vsyncMode == VSyncMode::On ? 1 : 0) < 0)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to set swap interval: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
 void Window::Quit() const
 {
     SDL_Event quitEvent;
@@ -150,6 +375,13 @@ void Window::Quit() const
 
 void Window::GetWindowDimensions(uint32_t* pWidthOut, uint32_t* pHeightOut) const
 {
+    if (m_spHeadlessContext)
+    {
+        *pWidthOut = m_spHeadlessContext->GetWidth();
+        *pHeightOut = m_spHeadlessContext->GetHeight();
+        return;
+    }
+
     int width, height;
     SDL_GetWindowSize(m_pWindow, &width, &height);
 
@@ -157,12 +389,188 @@ void Window::GetWindowDimensions(uint32_t* pWidthOut, uint32_t* pHeightOut) cons
     *pHeightOut = static_cast<uint32_t>(height);
 }
 
-void Window::SetKeyStateChangedHandler(FnKeyStateChangedHandler pfnHandler)
+double Window::GetRefreshRateHz(double fallbackHz) const
+{
+    if (m_spHeadlessContext)
+    {
+        return fallbackHz;
+    }
+
+    SDL_DisplayMode displayMode;
+    const int DisplayIndex = SDL_GetWindowDisplayIndex(m_pWindow);
+    if (DisplayIndex < 0 || SDL_GetCurrentDisplayMode(DisplayIndex, &displayMode) < 0)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to query display mode: %s", SDL_GetError());
+        return fallbackHz;
+    }
+
+    if (displayMode.refresh_rate <= 0)
+    {
+        return fallbackHz;
+    }
+
+    return static_cast<double>(displayMode.refresh_rate);
+}
+
+void Window::SetInputMapping(const input::InputMapping* pInputMapping)
 {
-    m_pfnKeyStateChanged = pfnHandler;
+    m_pInputMapping = pInputMapping;
+    if (m_pInputMapping)
+    {
+        m_keyboardState.Initialize(
+            &m_pInputMapping->FindDeviceMapping(input::InputSource::Keyboard, "keyboard"),
+            0 /* deviceIndex */);
+    }
+}
+
+void Window::SetInputEventHandler(input::FnInputEventHandler pfnHandler)
+{
+    m_pfnInputEventHandler = pfnHandler;
+}
+
+input::FnInputEventHandler Window::GetInputEventHandler() const
+{
+    return m_pfnInputEventHandler;
+}
+
+void Window::InjectInputEvent(const input::InputEvent& event) const
+{
+    if (m_pfnInputEventHandler)
+    {
+        m_pfnInputEventHandler(event, m_pUserPointer);
+    }
+}
+
+void Window::SetSdlInputEnabled(bool enabled)
+{
+    m_isSdlInputEnabled = enabled;
+}
+
+void Window::SetSdlGamepadInputEnabled(bool enabled)
+{
+    m_isSdlGamepadInputEnabled = enabled;
 }
 
 void Window::SetUserPointer(void* pUserPointer)
 {
     m_pUserPointer = pUserPointer;
 }
+
+void* Window::GetUserPointer() const
+{
+    return m_pUserPointer;
+}
+
+void Window::InitializeHeadless(uint32_t width, uint32_t height)
+{
+    // Quit and wake events still go through SDL's queue, which doesn't need
+    // the video subsystem
+    if (SDL_InitSubSystem(SDL_INIT_EVENTS) < 0)
+    {
+        RELEASE_LOG_FATAL(LOG_RENDER, "Failed to initialize SDL events: %s", SDL_GetError());
+    }
+
+    m_spHeadlessContext.reset(new HeadlessContext);
+    RELEASE_CHECK(m_spHeadlessContext != nullptr, "Failed to allocate headless context");
+    if (!m_spHeadlessContext->Initialize(width, height))
+    {
+        RELEASE_LOG_FATAL(LOG_RENDER, "Failed to create headless GL context");
+    }
+
+    // GLEW also loads GLX extensions, which fails without an X display. The
+    // core GL entry points are loaded by then, and are all we need.
+    glewExperimental = GL_TRUE;
+    const GLenum GlewResult = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (GlewResult != GLEW_OK && GlewResult != GLEW_ERROR_NO_GLX_DISPLAY)
+#else
+    if (GlewResult != GLEW_OK)
+#endif
+    {
+        RELEASE_LOG_FATAL(LOG_RENDER, "Failed to initialize GLEW");
+    }
+
+    if (!m_spHeadlessContext->CreateFramebuffer())
+    {
+        RELEASE_LOG_FATAL(LOG_RENDER, "Failed to create offscreen framebuffer");
+    }
+
+    glViewport(0.f, 0.f, width, height);
+
+    RegisterWakeEvent();
+}
+
+void Window::RegisterWakeEvent()
+{
+    m_wakeEventType = SDL_RegisterEvents(1);
+    if (m_wakeEventType == static_cast<Uint32>(-1))
+    {
+        RELEASE_LOGLINE_WARNING(LOG_RENDER, "Failed to register wake event, idle waits will only end on input");
+        m_wakeEventType = 0;
+    }
+}
+
+void Window::OpenGamepad(int32_t joystickIndex)
+{
+    SDL_GameController* pController = SDL_GameControllerOpen(joystickIndex);
+    if (!pController)
+    {
+        RELEASE_LOGLINE_WARNING(LOG_INPUT, "Failed to open game controller %d: %s", joystickIndex, SDL_GetError());
+        return;
+    }
+
+    const int32_t InstanceId = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(pController));
+    if (FindGamepad(InstanceId))
+    {
+        // Already open; SDL refcounts the handle
+        SDL_GameControllerClose(pController);
+        return;
+    }
+
+    const char* pName = SDL_GameControllerName(pController);
+    const std::string Name = pName ? pName : "unknown";
+
+    Gamepad gamepad;
+    gamepad.pController = pController;
+    gamepad.InstanceId = InstanceId;
+    gamepad.DeviceState.Initialize(
+        &m_pInputMapping->FindDeviceMapping(input::InputSource::Gamepad, Name),
+        static_cast<uint32_t>(InstanceId));
+    m_gamepads.push_back(gamepad);
+
+    RELEASE_LOGLINE_INFO(LOG_INPUT, "Opened game controller %s", Name.c_str());
+}
+
+void Window::CloseGamepad(int32_t instanceId)
+{
+    for (auto it = std::begin(m_gamepads); it != std::end(m_gamepads); ++it)
+    {
+        if (it->InstanceId != instanceId)
+        {
+            continue;
+        }
+
+        if (m_pfnInputEventHandler)
+        {
+            it->DeviceState.ReleaseAll(system::time::GetTicksNs(), m_pfnInputEventHandler, m_pUserPointer);
+        }
+
+        RELEASE_LOGLINE_INFO(LOG_INPUT, "Game controller %d disconnected", instanceId);
+        SDL_GameControllerClose(it->pController);
+        m_gamepads.erase(it);
+        return;
+    }
+}
+
+Window::Gamepad* Window::FindGamepad(int32_t instanceId)
+{
+    for (Gamepad& gamepad : m_gamepads)
+    {
+        if (gamepad.InstanceId == instanceId)
+        {
+            return &gamepad;
+        }
+    }
+
+    return nullptr;
+}
@@ -1,15 +1,30 @@
 // window.h
 //
-// Basic window class, wraps SDL bootstrapping
+// Basic window class, wraps SDL bootstrapping. In headless mode there's no
+// window at all: rendering goes to an offscreen EGL context (see
+// headlesscontext.h) and only SDL's event queue is used.
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <fivednine/input/inputdevicestate.h>
+#include <fivednine/input/inputevent.h>
 
 struct SDL_Window;
+union  SDL_Event;
+struct _SDL_GameController;
+
+namespace fivednine { namespace input {
+    class InputMapping;
+}}
 
 namespace fivednine { namespace render {
     struct ColorRGB;
+    class HeadlessContext;
 
     class Window
     {
@@ -17,21 +32,36 @@ namespace fivednine { namespace render {
         enum class EventType
         {
             None = 0,
-            Invalid,
-            KeyDown,
-            KeyUp,
-            Quit
+            Quit,
+            Wake,
+            Resized,
+            FocusGained,
+            FocusLost,
+            // Part of the window was uncovered and needs redrawing
+            Exposed
+        };
+
+        struct WindowEvent
+        {
+            EventType Type = EventType::None;
+
+            // New size, for Resized
+            uint32_t Width = 0;
+            uint32_t Height = 0;
         };
 
-        // TODO: a real input abstraction layer
-        enum class KeyType
+        typedef void(*FnWindowEventHandler)(const WindowEvent& event, void* pUserPointer);
+
+        // SDL events pulled per SDL_PeepEvents call
+        static constexpr size_t kEventBatchSize = 64;
+
+        enum class VSyncMode
         {
-            Invalid = 0,
-            Left,
-            Right,
-            A,
-            D,
-            Q
+            Off = 0,
+            On,
+            // Syncs when a frame is on time and tears rather than waiting a
+            // whole extra interval when it's late
+            Adaptive
         };
 
         static constexpr uint32_t kDefaultWindowWidth = 1024;
@@ -40,25 +70,115 @@ namespace fivednine { namespace render {
             const char* pWindowName = nullptr,
             uint32_t width = kDefaultWindowWidth,
             uint32_t height = kDefaultWindowHeight,
-            bool fullScreen = false); // Temporarily disabling for development & iteration
+            bool fullScreen = false, // Temporarily disabling for development & iteration
+            bool headless = false);
         ~Window();
 
-        EventType PollEvents() const;
+        bool IsHeadless() const;
+
+        // Drains pending SDL events in batches. Input is translated and goes
+        // to the input event handler; everything else is passed to each
+        // listener and written to pEventsOut. Stops early once maxEvents
+        // have been written, leaving the rest queued, so call again while
+        // the buffer comes back full. Returns the number written.
+        size_t PollEvents(WindowEvent* pEventsOut, size_t maxEvents);
+
+        // Listeners are called from PollEvents, in the order they were added
+        void AddEventListener(FnWindowEventHandler pfnHandler, void* pUserPointer);
+        void RemoveEventListener(FnWindowEventHandler pfnHandler, void* pUserPointer);
+
+        // Blocks until an event is available (without consuming it) or the
+        // timeout elapses. A negative timeout waits indefinitely. Returns
+        // false on timeout.
+        bool WaitForEvents(int32_t timeoutMs = -1) const;
+
+        // Wakes a WaitForEvents() call from any thread, e.g. when an asset
+        // has finished loading. Shows up as EventType::Wake.
+        void PostWakeEvent() const;
         void Clear(const ColorRGB& clearColor) const;
+
+        // Presents the frame. Headless windows have nothing to present and
+        // just flush; use Finish() to wait for rendering to complete.
         void Update() const;
+        void Finish() const;
+
+        // On by default. Adaptive falls back to On where the driver doesn't
+        // support it. Always succeeds for headless windows, which never wait
+        // on a display.
+        bool SetVSyncMode(VSyncMode vsyncMode) const;
         void Quit() const;
 
         void GetWindowDimensions(uint32_t* pWidthOut, uint32_t* pHeightOut) const;
 
-        typedef void(*FnKeyStateChangedHandler)(EventType, KeyType, void*);
-        void SetKeyStateChangedHandler(FnKeyStateChangedHandler pfnHandler);
+        // Refresh rate of the display the window is on, or fallbackHz if the
+        // driver doesn't report one
+        double GetRefreshRateHz(double fallbackHz) const;
+
+        // Keyboard and gamepad input from SDL is translated into actions
+        // through this mapping, which must outlive the window. Without one,
+        // only injected input is delivered. Gamepads are opened as SDL
+        // reports them connected, and released when disconnected.
+        void SetInputMapping(const input::InputMapping* pInputMapping);
+
+        // The timestamp (system::time::GetTicksNs) is taken as the event is
+        // pulled from SDL, for input latency measurements
+        void SetInputEventHandler(input::FnInputEventHandler pfnHandler);
+        input::FnInputEventHandler GetInputEventHandler() const;
+
+        // Delivers an event to the handler as if it had come from SDL, for
+        // driving the app from scripted input or input read elsewhere
+        void InjectInputEvent(const input::InputEvent& event) const;
+
+        // On by default. Turned off when devices are read directly (see
+        // input/inputthread.h), which would otherwise be seen twice.
+        // Injected events are still delivered.
+        void SetSdlInputEnabled(bool enabled);
+
+        // As above for gamepads alone, for when only pads are read directly
+        // and keys still come from the window
+        void SetSdlGamepadInputEnabled(bool enabled);
 
         void SetUserPointer(void* pUserPointer);
+        void* GetUserPointer() const;
 
     private:
-        FnKeyStateChangedHandler m_pfnKeyStateChanged = nullptr;
-        void*                    m_pUserPointer = nullptr;
+        void InitializeHeadless(uint32_t width, uint32_t height);
+        void RegisterWakeEvent();
+
+        // False if the event isn't one to report, e.g. input
+        bool TranslateEvent(const SDL_Event& e, uint64_t receivedNs, WindowEvent* pWindowEventOut);
+        bool TranslateWindowEvent(const SDL_Event& e, WindowEvent* pWindowEventOut);
+
+        void OpenGamepad(int32_t joystickIndex);
+        void CloseGamepad(int32_t instanceId);
+
+        struct Gamepad
+        {
+            _SDL_GameController*    pController = nullptr;
+            int32_t                 InstanceId = -1;
+            input::InputDeviceState DeviceState;
+        };
+        Gamepad* FindGamepad(int32_t instanceId);
+
+        struct EventListener
+        {
+            FnWindowEventHandler pfnHandler = nullptr;
+            void*                pUserPointer = nullptr;
+        };
+        std::vector<EventListener> m_eventListeners;
+
+        input::FnInputEventHandler m_pfnInputEventHandler = nullptr;
+        void*                      m_pUserPointer = nullptr;
+
+        const input::InputMapping* m_pInputMapping = nullptr;
+        input::InputDeviceState    m_keyboardState;
+        std::vector<Gamepad>       m_gamepads;
 
         SDL_Window* m_pWindow = nullptr;
+        uint32_t    m_wakeEventType = 0;
+        bool        m_isSdlInputEnabled = true;
+        bool        m_isSdlGamepadInputEnabled = true;
+
+        std::unique_ptr<HeadlessContext> m_spHeadlessContext;
     };
 }}
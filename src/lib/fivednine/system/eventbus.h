@@ -0,0 +1,262 @@
+// eventbus.h
+//
+// Typed publish/subscribe over a bounded queue. The event types a bus
+// carries are fixed when it's declared, EventBus<InputEvent, ResizeEvent,
+// ...>, and each gets an integer id from its position in that list. Any
+// thread may post; only one thread dispatches, calling each type's
+// subscribers in the order they subscribed.
+//
+// Nothing allocates after construction. Payloads are copied inline into
+// fixed-size queue slots, so event types must be trivially copyable, and
+// subscriber tables are fixed-size per type. As with the ring queues, a
+// post to a full bus is dropped and counted rather than blocking.
+//
+// An event type may define bool Coalesce(const T& next). When the event
+// being dispatched is directly followed in the queue by another of the same
+// type, it's asked to absorb it; if it does, the two are delivered as one.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "ringqueue.h"
+
+namespace fivednine { namespace system {
+    namespace detail
+    {
+        template<typename T, typename... Ts>
+        struct TypeIndex;
+
+        template<typename T, typename... Ts>
+        struct TypeIndex<T, T, Ts...> : std::integral_constant<uint32_t, 0> {};
+
+        template<typename T, typename U, typename... Ts>
+        struct TypeIndex<T, U, Ts...> : std::integral_constant<uint32_t, 1 + TypeIndex<T, Ts...>::value> {};
+
+        template<typename T>
+        concept Coalescable = requires(T& event, const T& nextEvent)
+        {
+            { event.Coalesce(nextEvent) } -> std::convertible_to<bool>;
+        };
+    }
+
+    template<typename... TEvents>
+    class EventBus
+    {
+        static_assert(sizeof...(TEvents) > 0, "An event bus needs at least one event type");
+        static_assert((std::is_trivially_copyable_v<TEvents> && ...), "Event payloads are copied as bytes");
+
+        template<typename TEvent>
+        static constexpr bool kIsRegistered = ((std::is_same_v<TEvent, TEvents> ? 1 : 0) + ...) == 1;
+
+    public:
+        static constexpr size_t kCapacity = 256;
+        static constexpr size_t kMaxSubscribersPerType = 8;
+        static constexpr size_t kNumEventTypes = sizeof...(TEvents);
+
+        template<typename TEvent>
+        static constexpr uint32_t GetTypeId()
+        {
+            static_assert(kIsRegistered<TEvent>, "Event type isn't registered with this bus, or is registered twice");
+            return detail::TypeIndex<TEvent, TEvents...>::value;
+        }
+
+        template<typename TEvent>
+        using FnHandler = void(*)(const TEvent& event, void* pUserPointer);
+
+        // Dispatching thread only, and not from within a handler. Returns
+        // false if the type already has kMaxSubscribersPerType subscribers.
+        template<typename TEvent>
+        bool Subscribe(FnHandler<TEvent> pfnHandler, void* pUserPointer);
+
+        template<typename TEvent>
+        void Unsubscribe(FnHandler<TEvent> pfnHandler, void* pUserPointer);
+
+        // Any thread. Returns false if the event was dropped.
+        template<typename TEvent>
+        bool Post(const TEvent& event);
+
+        // Delivers queued events in order, including any posted by handlers
+        // along the way. Stops after kCapacity events so that producers
+        // posting concurrently can't keep the dispatcher here indefinitely;
+        // the remainder is left for the next call. Returns the number of
+        // events consumed, counting each one absorbed by coalescing.
+        size_t Dispatch();
+
+        // Exact on the dispatching thread; a hint anywhere else
+        bool IsEmpty() const;
+
+        // Total since construction
+        uint64_t GetNumDroppedEvents() const;
+
+    private:
+        static constexpr size_t kPayloadSize = std::max({ sizeof(TEvents)... });
+        static constexpr size_t kPayloadAlignment = std::max({ alignof(TEvents)... });
+
+        struct EventSlot
+        {
+            uint32_t TypeId;
+            alignas(kPayloadAlignment) unsigned char Payload[kPayloadSize];
+        };
+
+        // Handlers are stored type-erased and cast back by the invoker for
+        // the event's type
+        typedef void(*FnErasedHandler)();
+        struct Subscriber
+        {
+            FnErasedHandler pfnHandler = nullptr;
+            void*           pUserPointer = nullptr;
+        };
+
+        struct SubscriberTable
+        {
+            Subscriber Subscribers[kMaxSubscribersPerType];
+            size_t     NumSubscribers = 0;
+        };
+
+        typedef void(*FnInvoke)(const Subscriber& subscriber, const void* pPayload);
+        typedef bool(*FnCoalesce)(void* pPayload, const void* pNextPayload);
+
+        template<typename TEvent>
+        static void Invoke(const Subscriber& subscriber, const void* pPayload);
+
+        template<typename TEvent>
+        static bool Coalesce(void* pPayload, const void* pNextPayload);
+
+        // Indexed by type id
+        static constexpr FnInvoke   kInvokers[kNumEventTypes] = { &Invoke<TEvents>... };
+        static constexpr FnCoalesce kCoalescers[kNumEventTypes] = { &Coalesce<TEvents>... };
+
+        MpscRingQueue<EventSlot, kCapacity> m_eventQueue;
+        std::atomic<uint64_t>               m_numDroppedEvents{0};
+        SubscriberTable                     m_subscriberTables[kNumEventTypes];
+    };
+
+    template<typename... TEvents>
+    template<typename TEvent>
+    bool EventBus<TEvents...>::Subscribe(FnHandler<TEvent> pfnHandler, void* pUserPointer)
+    {
+        SubscriberTable& subscriberTable = m_subscriberTables[GetTypeId<TEvent>()];
+        if (!pfnHandler || subscriberTable.NumSubscribers == kMaxSubscribersPerType)
+        {
+            return false;
+        }
+
+        Subscriber& subscriber = subscriberTable.Subscribers[subscriberTable.NumSubscribers++];
+        subscriber.pfnHandler = reinterpret_cast<FnErasedHandler>(pfnHandler);
+        subscriber.pUserPointer = pUserPointer;
+        return true;
+    }
+
+    template<typename... TEvents>
+    template<typename TEvent>
+    void EventBus<TEvents...>::Unsubscribe(FnHandler<TEvent> pfnHandler, void* pUserPointer)
+    {
+        SubscriberTable& subscriberTable = m_subscriberTables[GetTypeId<TEvent>()];
+        const FnErasedHandler ErasedHandler = reinterpret_cast<FnErasedHandler>(pfnHandler);
+        for (size_t i = 0; i < subscriberTable.NumSubscribers; ++i)
+        {
+            const Subscriber& subscriber = subscriberTable.Subscribers[i];
+            if (subscriber.pfnHandler != ErasedHandler || subscriber.pUserPointer != pUserPointer)
+            {
+                continue;
+            }
+
+            // Shift down rather than swap, to keep subscription order
+            std::copy(
+                subscriberTable.Subscribers + i + 1,
+                subscriberTable.Subscribers + subscriberTable.NumSubscribers,
+                subscriberTable.Subscribers + i);
+            --subscriberTable.NumSubscribers;
+            return;
+        }
+    }
+
+    template<typename... TEvents>
+    template<typename TEvent>
+    bool EventBus<TEvents...>::Post(const TEvent& event)
+    {
+        EventSlot eventSlot;
+        eventSlot.TypeId = GetTypeId<TEvent>();
+        new (eventSlot.Payload) TEvent(event);
+        if (!m_eventQueue.TryPush(eventSlot))
+        {
+            m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename... TEvents>
+    size_t EventBus<TEvents...>::Dispatch()
+    {
+        size_t numEvents = 0;
+        EventSlot eventSlot;
+        while (numEvents < kCapacity && m_eventQueue.TryPop(&eventSlot))
+        {
+            ++numEvents;
+
+            const uint32_t TypeId = eventSlot.TypeId;
+            const EventSlot* pNextEventSlot = nullptr;
+            while (numEvents < kCapacity &&
+                   (pNextEventSlot = m_eventQueue.Peek()) != nullptr &&
+                   pNextEventSlot->TypeId == TypeId &&
+                   kCoalescers[TypeId](eventSlot.Payload, pNextEventSlot->Payload))
+            {
+                EventSlot absorbedEventSlot;
+                m_eventQueue.TryPop(&absorbedEventSlot);
+                ++numEvents;
+            }
+
+            const SubscriberTable& SubscribersForType = m_subscriberTables[TypeId];
+            for (size_t i = 0; i < SubscribersForType.NumSubscribers; ++i)
+            {
+                kInvokers[TypeId](SubscribersForType.Subscribers[i], eventSlot.Payload);
+            }
+        }
+
+        return numEvents;
+    }
+
+    template<typename... TEvents>
+    bool EventBus<TEvents...>::IsEmpty() const
+    {
+        return m_eventQueue.IsEmpty();
+    }
+
+    template<typename... TEvents>
+    uint64_t EventBus<TEvents...>::GetNumDroppedEvents() const
+    {
+        return m_numDroppedEvents.load(std::memory_order_relaxed);
+    }
+
+    template<typename... TEvents>
+    template<typename TEvent>
+    void EventBus<TEvents...>::Invoke(const Subscriber& subscriber, const void* pPayload)
+    {
+        const FnHandler<TEvent> pfnHandler = reinterpret_cast<FnHandler<TEvent>>(subscriber.pfnHandler);
+        pfnHandler(*std::launder(static_cast<const TEvent*>(pPayload)), subscriber.pUserPointer);
+    }
+
+    template<typename... TEvents>
+    template<typename TEvent>
+    bool EventBus<TEvents...>::Coalesce(void* pPayload, const void* pNextPayload)
+    {
+        if constexpr (detail::Coalescable<TEvent>)
+        {
+            return std::launder(static_cast<TEvent*>(pPayload))->Coalesce(
+                *std::launder(static_cast<const TEvent*>(pNextPayload)));
+        }
+        else
+        {
+            return false;
+        }
+    }
+}}
@@ -0,0 +1,121 @@
+#include "framescheduler.h"
+#include "time.h"
+
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::system;
+
+FrameScheduler::FrameScheduler(uint32_t simulationHz)
+    : m_frameTimeHistory(kFrameTimeHistoryCapacity)
+{
+    RELEASE_CHECK(simulationHz > 0, "Simulation rate must be nonzero");
+    m_fixedTimestepNs = time::kNanosecondsPerSecond / simulationHz;
+    SetTargetRefreshRate(kDefaultRefreshHz);
+}
+
+void FrameScheduler::SetTargetRefreshRate(double refreshHz)
+{
+    m_targetFrameNs = refreshHz > 0.0 ? static_cast<uint64_t>(time::kNanosecondsPerSecond / refreshHz) : 0;
+}
+
+double FrameScheduler::GetTargetRefreshRate() const
+{
+    return m_targetFrameNs > 0 ? static_cast<double>(time::kNanosecondsPerSecond) / m_targetFrameNs : 0.0;
+}
+
+void FrameScheduler::SetFixedStepsPerFrame(uint32_t numSteps)
+{
+    m_fixedStepsPerFrame = numSteps;
+}
+
+uint32_t FrameScheduler::BeginFrame()
+{
+    const uint64_t NowNs = time::GetTicksNs();
+    if (!m_hasStarted)
+    {
+        // Run one step up front so there's a valid state to render
+        m_hasStarted = true;
+        m_frameStartNs = NowNs;
+        m_accumulatorNs = 0;
+        return 1;
+    }
+
+    const uint64_t FrameNs = NowNs - m_frameStartNs;
+    m_frameStartNs = NowNs;
+    m_frameTimeHistory.AddSample(static_cast<double>(FrameNs) / time::kNanosecondsPerMillisecond);
+
+    if (m_fixedStepsPerFrame > 0)
+    {
+        m_accumulatorNs = 0;
+        return m_fixedStepsPerFrame;
+    }
+
+    m_accumulatorNs += FrameNs;
+    uint32_t numSteps = static_cast<uint32_t>(m_accumulatorNs / m_fixedTimestepNs);
+    if (numSteps > kMaxStepsPerFrame)
+    {
+        numSteps = kMaxStepsPerFrame;
+        m_accumulatorNs = 0;
+    }
+    else
+    {
+        m_accumulatorNs -= numSteps * m_fixedTimestepNs;
+    }
+
+    return numSteps;
+}
+
+void FrameScheduler::EndFrame()
+{
+    if (m_targetFrameNs == 0 || m_fixedStepsPerFrame > 0)
+    {
+        return;
+    }
+
+    const uint64_t DeadlineNs = m_frameStartNs + m_targetFrameNs;
+    uint64_t nowNs = time::GetTicksNs();
+    if (nowNs + kSpinThresholdNs < DeadlineNs)
+    {
+        time::SleepNs(DeadlineNs - nowNs - kSpinThresholdNs);
+    }
+
+    while (time::GetTicksNs() < DeadlineNs) {}
+}
+
+void FrameScheduler::Reset()
+{
+    m_hasStarted = false;
+}
+
+float FrameScheduler::GetFixedTimestepSeconds() const
+{
+    return static_cast<float>(m_fixedTimestepNs) / time::kNanosecondsPerSecond;
+}
+
+uint64_t FrameScheduler::GetFixedTimestepNs() const
+{
+    return m_fixedTimestepNs;
+}
+
+float FrameScheduler::GetInterpolationAlpha() const
+{
+    return static_cast<float>(m_accumulatorNs) / m_fixedTimestepNs;
+}
+
+float FrameScheduler::GetLatchedInterpolationAlpha() const
+{
+    if (!m_hasStarted || m_fixedStepsPerFrame > 0)
+    {
+        return GetInterpolationAlpha();
+    }
+
+    const uint64_t SinceBeginFrameNs = time::GetTicksNs() - m_frameStartNs;
+    const float Alpha = static_cast<float>(m_accumulatorNs + SinceBeginFrameNs) / m_fixedTimestepNs;
+    return Alpha < 1.f ? Alpha : 1.f;
+}
+
+const SampleHistory& FrameScheduler::GetFrameTimeHistory() const
+{
+    return m_frameTimeHistory;
+}
@@ -0,0 +1,79 @@
+// framescheduler.h
+//
+// Drives the main loop: a fixed-timestep simulation accumulator, an
+// interpolation factor for rendering between simulation steps, and frame
+// pacing which sleeps for most of the remaining frame time and spins for the
+// rest, targeting the display's refresh rate.
+
+#pragma once
+
+#include "samplehistory.h"
+
+#include <cstdint>
+
+namespace fivednine { namespace system {
+    class FrameScheduler
+    {
+    public:
+        static constexpr uint32_t kDefaultSimulationHz = 120;
+        static constexpr double   kDefaultRefreshHz = 60.0;
+
+        explicit FrameScheduler(uint32_t simulationHz = kDefaultSimulationHz);
+
+        // Zero or negative disables pacing (e.g. when vsync already blocks)
+        void SetTargetRefreshRate(double refreshHz);
+        double GetTargetRefreshRate() const;
+
+        // Runs exactly numSteps simulation steps per frame however long the
+        // frame took, without pacing, e.g. to replay input as fast as
+        // possible. Zero goes back to stepping by elapsed time.
+        void SetFixedStepsPerFrame(uint32_t numSteps);
+
+        // Accumulates time elapsed since the last call and returns how many
+        // fixed simulation steps should run this frame.
+        uint32_t BeginFrame();
+
+        // Waits out the rest of the frame and records its duration.
+        void EndFrame();
+
+        // Forgets accumulated time, e.g. after the loop was blocked waiting
+        // for input, so that the next frame doesn't try to catch up.
+        void Reset();
+
+        float GetFixedTimestepSeconds() const;
+        uint64_t GetFixedTimestepNs() const;
+
+        // How far between the previous and current simulation states the
+        // rendered frame is, in [0, 1)
+        float GetInterpolationAlpha() const;
+
+        // As above, but also counting the time since BeginFrame(), so that
+        // state sampled just before submission is as current as possible.
+        // Clamped to the newest simulated state. With fixed steps per frame
+        // this is the same as GetInterpolationAlpha(), to stay repeatable.
+        float GetLatchedInterpolationAlpha() const;
+
+        // Milliseconds per frame, as measured between successive BeginFrame()s
+        const SampleHistory& GetFrameTimeHistory() const;
+
+    private:
+        // Caps catch-up after a stall so a long hitch doesn't turn into a
+        // burst of simulation steps
+        static constexpr uint32_t kMaxStepsPerFrame = 8;
+
+        // Below this the OS scheduler can't be trusted to wake us in time
+        static constexpr uint64_t kSpinThresholdNs = 2000000ull;
+
+        static constexpr size_t kFrameTimeHistoryCapacity = 1024;
+
+        uint64_t m_fixedTimestepNs;
+        uint64_t m_targetFrameNs = 0;
+        uint32_t m_fixedStepsPerFrame = 0;
+
+        uint64_t m_frameStartNs = 0;
+        uint64_t m_accumulatorNs = 0;
+        bool     m_hasStarted = false;
+
+        SampleHistory m_frameTimeHistory;
+    };
+}}
@@ -0,0 +1,155 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <fivednine/log/log.h>
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::system;
+
+Histogram::Histogram(double bucketWidth, size_t numBuckets)
+    : m_bucketWidth(bucketWidth), m_bucketCounts(numBuckets, 0)
+{
+    RELEASE_CHECK(bucketWidth > 0.0, "Histogram bucket width must be positive");
+    RELEASE_CHECK(numBuckets > 0, "Histogram requires at least one bucket");
+}
+
+void Histogram::AddSample(double sample)
+{
+    const double BucketPosition = std::max(sample, 0.0) / m_bucketWidth;
+    if (BucketPosition >= static_cast<double>(m_bucketCounts.size()))
+    {
+        ++m_overflowCount;
+    }
+    else
+    {
+        ++m_bucketCounts[static_cast<size_t>(BucketPosition)];
+    }
+
+    m_min = m_count == 0 ? sample : std::min(m_min, sample);
+    m_max = m_count == 0 ? sample : std::max(m_max, sample);
+    m_sum += sample;
+    ++m_count;
+}
+
+void Histogram::Clear()
+{
+    std::fill(std::begin(m_bucketCounts), std::end(m_bucketCounts), 0);
+    m_overflowCount = 0;
+    m_count = 0;
+    m_sum = 0.0;
+    m_min = 0.0;
+    m_max = 0.0;
+}
+
+uint64_t Histogram::GetCount() const
+{
+    return m_count;
+}
+
+double Histogram::GetMin() const
+{
+    return m_min;
+}
+
+double Histogram::GetMax() const
+{
+    return m_max;
+}
+
+double Histogram::GetMean() const
+{
+    return m_count > 0 ? m_sum / m_count : 0.0;
+}
+
+double Histogram::GetPercentile(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0.0;
+    }
+
+    const double ClampedPercentile = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t Rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ClampedPercentile / 100.0 * m_count)));
+
+    uint64_t cumulativeCount = 0;
+    for (size_t i = 0; i < m_bucketCounts.size(); ++i)
+    {
+        cumulativeCount += m_bucketCounts[i];
+        if (cumulativeCount >= Rank)
+        {
+            return std::min((i + 1) * m_bucketWidth, m_max);
+        }
+    }
+
+    return m_max;
+}
+
+double Histogram::GetBucketWidth() const
+{
+    return m_bucketWidth;
+}
+
+size_t Histogram::GetNumBuckets() const
+{
+    return m_bucketCounts.size();
+}
+
+uint64_t Histogram::GetBucketCount(size_t bucketIndex) const
+{
+    RELEASE_CHECK(bucketIndex < m_bucketCounts.size(), "Histogram bucket index out of bounds: %zu", bucketIndex);
+    return m_bucketCounts[bucketIndex];
+}
+
+uint64_t Histogram::GetOverflowCount() const
+{
+    return m_overflowCount;
+}
+
+void Histogram::LogSummary(const char* pLabel, const char* pUnits) const
+{
+    RELEASE_LOGLINE_INFO(
+        LOG_DEFAULT,
+        "%s: %llu samples, min %.2f %s, mean %.2f %s, p50 %.2f %s, p99 %.2f %s, max %.2f %s",
+        pLabel,
+        static_cast<unsigned long long>(m_count),
+        GetMin(), pUnits,
+        GetMean(), pUnits,
+        GetPercentile(50.0), pUnits,
+        GetPercentile(99.0), pUnits,
+        GetMax(), pUnits);
+    if (m_count == 0)
+    {
+        return;
+    }
+
+    const uint64_t LargestCount = std::max(
+        *std::max_element(std::begin(m_bucketCounts), std::end(m_bucketCounts)),
+        m_overflowCount);
+    constexpr size_t kMaxBarLength = 40;
+    for (size_t i = 0; i <= m_bucketCounts.size(); ++i)
+    {
+        const bool IsOverflow = i == m_bucketCounts.size();
+        const uint64_t BucketCount = IsOverflow ? m_overflowCount : m_bucketCounts[i];
+        if (BucketCount == 0)
+        {
+            continue;
+        }
+
+        const size_t BarLength = std::max<size_t>(1, static_cast<size_t>(BucketCount * kMaxBarLength / LargestCount));
+        const std::string Bar(BarLength, '#');
+        if (IsOverflow)
+        {
+            RELEASE_LOGLINE_INFO(LOG_DEFAULT, "  >= %7.2f %s | %s %llu",
+                i * m_bucketWidth, pUnits, Bar.c_str(), static_cast<unsigned long long>(BucketCount));
+        }
+        else
+        {
+            RELEASE_LOGLINE_INFO(LOG_DEFAULT, "  < %8.2f %s | %s %llu",
+                (i + 1) * m_bucketWidth, pUnits, Bar.c_str(), static_cast<unsigned long long>(BucketCount));
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// histogram.h
+//
+// Fixed-width bucketed histogram for long-running measurements where keeping
+// every sample isn't an option. Samples past the last bucket are counted in
+// an overflow bucket; exact min/max/mean are tracked alongside.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fivednine { namespace system {
+    class Histogram
+    {
+    public:
+        Histogram(double bucketWidth, size_t numBuckets);
+
+        void AddSample(double sample);
+        void Clear();
+
+        uint64_t GetCount() const;
+        double GetMin() const;
+        double GetMax() const;
+        double GetMean() const;
+
+        // Upper edge of the bucket containing the given percentile, so an
+        // overestimate by at most one bucket width. Returns the max if the
+        // percentile lands in the overflow bucket.
+        double GetPercentile(double percentile) const;
+
+        double GetBucketWidth() const;
+        size_t GetNumBuckets() const;
+        uint64_t GetBucketCount(size_t bucketIndex) const;
+        uint64_t GetOverflowCount() const;
+
+        // One line per non-empty bucket with a proportional bar, at Info
+        // verbosity
+        void LogSummary(const char* pLabel, const char* pUnits) const;
+
+    private:
+        double                m_bucketWidth;
+        std::vector<uint64_t> m_bucketCounts;
+        uint64_t              m_overflowCount = 0;
+
+        uint64_t m_count = 0;
+        double   m_sum = 0.0;
+        double   m_min = 0.0;
+        double   m_max = 0.0;
+    };
+}}
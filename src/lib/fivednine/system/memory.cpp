@@ -0,0 +1,39 @@
+#include "memory.h"
+
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+uint64_t fivednine::system::memory::GetCurrentRssBytes()
+{
+    // Second field of statm is resident pages
+    FILE* pFile = std::fopen("/proc/self/statm", "r");
+    if (!pFile)
+    {
+        return 0;
+    }
+
+    unsigned long long totalPages = 0;
+    unsigned long long residentPages = 0;
+    const int NumRead = std::fscanf(pFile, "%llu %llu", &totalPages, &residentPages);
+    std::fclose(pFile);
+    if (NumRead != 2)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(residentPages) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+uint64_t fivednine::system::memory::GetPeakRssBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+    // ru_maxrss is in kilobytes on Linux
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
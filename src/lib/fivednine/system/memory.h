@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+namespace fivednine { namespace system { namespace memory {
+    // Resident set size of the process. Both return 0 if unavailable.
+    uint64_t GetCurrentRssBytes();
+    uint64_t GetPeakRssBytes();
+}}}
@@ -0,0 +1,238 @@
+// ringqueue.h
+//
+// Fixed-capacity lock-free FIFO queues for handing small values between
+// threads without locks or allocation. Both fail a push when full rather
+// than blocking or growing; what to do with the value is up to the caller.
+//
+// SpscRingQueue: one producer thread, one consumer thread.
+// MpscRingQueue: any number of producer threads, one consumer thread.
+//
+// Capacities must be powers of two. Indices and slots shared between
+// threads are kept on separate cache lines so producers and the consumer
+// don't invalidate each other's lines on every operation.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace fivednine { namespace system {
+    // Not std::hardware_destructive_interference_size, which varies with
+    // compiler flags and so isn't safe to use in a header
+    static constexpr size_t kCacheLineSize = 64;
+
+    template<typename T, size_t Capacity>
+    class SpscRingQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer only. Returns false if the queue is full.
+        bool TryPush(const T& value);
+
+        // Consumer only. Returns false if the queue is empty.
+        bool TryPop(T* pValueOut);
+
+        // Consumer only. The front value, or null if empty; stays valid
+        // until it's popped.
+        const T* Peek() const;
+
+        // Exact on the consumer thread; a hint anywhere else
+        bool IsEmpty() const;
+
+        static constexpr size_t GetCapacity() { return Capacity; }
+
+    private:
+        static constexpr size_t kIndexMask = Capacity - 1;
+
+        // Consumer's line: where it reads next, and its last view of the tail
+        alignas(kCacheLineSize) std::atomic<size_t> m_head{0};
+        mutable size_t                               m_cachedTail = 0;
+
+        // Producer's line: where it writes next, and its last view of the head
+        alignas(kCacheLineSize) std::atomic<size_t> m_tail{0};
+        size_t                                       m_cachedHead = 0;
+
+        alignas(kCacheLineSize) T m_slots[Capacity];
+    };
+
+    // Bounded queue after Dmitry Vyukov's: each slot carries a sequence
+    // number saying whether it's free for the producer of a given lap or
+    // holds a value for the consumer, so producers only contend on the tail
+    // index and never wait for each other to finish writing.
+    template<typename T, size_t Capacity>
+    class MpscRingQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        MpscRingQueue();
+
+        // Any thread. Returns false if the queue is full.
+        bool TryPush(const T& value);
+
+        // Consumer only. Returns false if the queue is empty, or if the
+        // producer that claimed the front slot hasn't finished writing it.
+        bool TryPop(T* pValueOut);
+
+        // Consumer only. The front value, or null if empty; stays valid
+        // until it's popped.
+        const T* Peek() const;
+
+        // Exact on the consumer thread, give or take pushes in progress; a
+        // hint anywhere else
+        bool IsEmpty() const;
+
+        static constexpr size_t GetCapacity() { return Capacity; }
+
+    private:
+        static constexpr size_t kIndexMask = Capacity - 1;
+
+        // One per line, so producers writing neighbouring slots don't share
+        struct alignas(kCacheLineSize) Slot
+        {
+            std::atomic<size_t> Sequence;
+            T                   Value;
+        };
+
+        alignas(kCacheLineSize) std::atomic<size_t> m_tail{0};
+
+        // Only touched by the consumer
+        alignas(kCacheLineSize) size_t m_head = 0;
+
+        Slot m_slots[Capacity];
+    };
+
+    template<typename T, size_t Capacity>
+    bool SpscRingQueue<T, Capacity>::TryPush(const T& value)
+    {
+        const size_t Tail = m_tail.load(std::memory_order_relaxed);
+        if (Tail - m_cachedHead == Capacity)
+        {
+            // Only go to the consumer's line once the stale view says full
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (Tail - m_cachedHead == Capacity)
+            {
+                return false;
+            }
+        }
+
+        m_slots[Tail & kIndexMask] = value;
+        m_tail.store(Tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T, size_t Capacity>
+    bool SpscRingQueue<T, Capacity>::TryPop(T* pValueOut)
+    {
+        const T* pFront = Peek();
+        if (!pFront)
+        {
+            return false;
+        }
+
+        *pValueOut = *pFront;
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T, size_t Capacity>
+    const T* SpscRingQueue<T, Capacity>::Peek() const
+    {
+        const size_t Head = m_head.load(std::memory_order_relaxed);
+        if (Head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (Head == m_cachedTail)
+            {
+                return nullptr;
+            }
+        }
+
+        return &m_slots[Head & kIndexMask];
+    }
+
+    template<typename T, size_t Capacity>
+    bool SpscRingQueue<T, Capacity>::IsEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    template<typename T, size_t Capacity>
+    MpscRingQueue<T, Capacity>::MpscRingQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            m_slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename T, size_t Capacity>
+    bool MpscRingQueue<T, Capacity>::TryPush(const T& value)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = m_slots[tail & kIndexMask];
+            const size_t Sequence = slot.Sequence.load(std::memory_order_acquire);
+            const intptr_t Lag = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(tail);
+            if (Lag == 0)
+            {
+                // Free for this lap; claim it. On failure tail is reloaded.
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                {
+                    slot.Value = value;
+                    slot.Sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (Lag < 0)
+            {
+                // Still holds last lap's value, which the consumer hasn't
+                // taken yet
+                return false;
+            }
+            else
+            {
+                // Another producer got here first
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename T, size_t Capacity>
+    bool MpscRingQueue<T, Capacity>::TryPop(T* pValueOut)
+    {
+        const T* pFront = Peek();
+        if (!pFront)
+        {
+            return false;
+        }
+
+        *pValueOut = *pFront;
+
+        // Hand the slot back to producers for the next lap
+        m_slots[m_head & kIndexMask].Sequence.store(m_head + Capacity, std::memory_order_release);
+        ++m_head;
+        return true;
+    }
+
+    template<typename T, size_t Capacity>
+    const T* MpscRingQueue<T, Capacity>::Peek() const
+    {
+        const Slot& FrontSlot = m_slots[m_head & kIndexMask];
+        if (FrontSlot.Sequence.load(std::memory_order_acquire) != m_head + 1)
+        {
+            return nullptr;
+        }
+
+        return &FrontSlot.Value;
+    }
+
+    template<typename T, size_t Capacity>
+    bool MpscRingQueue<T, Capacity>::IsEmpty() const
+    {
+        return Peek() == nullptr;
+    }
+}}
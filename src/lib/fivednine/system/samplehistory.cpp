@@ -0,0 +1,76 @@
+#include "samplehistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <fivednine/log/check.h>
+
+using namespace fivednine;
+using namespace fivednine::system;
+
+SampleHistory::SampleHistory(size_t capacity)
+    : m_samples(capacity, 0.0)
+{
+    RELEASE_CHECK(capacity > 0, "Sample history requires a nonzero capacity");
+}
+
+void SampleHistory::AddSample(double sample)
+{
+    m_samples[m_nextIndex] = sample;
+    m_nextIndex = (m_nextIndex + 1) % m_samples.size();
+    m_count = std::min(m_count + 1, m_samples.size());
+    ++m_totalCount;
+}
+
+void SampleHistory::Clear()
+{
+    m_nextIndex = 0;
+    m_count = 0;
+    m_totalCount = 0;
+}
+
+size_t SampleHistory::GetCount() const
+{
+    return m_count;
+}
+
+uint64_t SampleHistory::GetTotalCount() const
+{
+    return m_totalCount;
+}
+
+double SampleHistory::GetMin() const
+{
+    if (m_count == 0) { return 0.0; }
+    return *std::min_element(std::begin(m_samples), std::begin(m_samples) + m_count);
+}
+
+double SampleHistory::GetMax() const
+{
+    if (m_count == 0) { return 0.0; }
+    return *std::max_element(std::begin(m_samples), std::begin(m_samples) + m_count);
+}
+
+double SampleHistory::GetAverage() const
+{
+    if (m_count == 0) { return 0.0; }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        sum += m_samples[i];
+    }
+    return sum / m_count;
+}
+
+double SampleHistory::GetPercentile(double percentile) const
+{
+    if (m_count == 0) { return 0.0; }
+
+    std::vector<double> sorted(std::begin(m_samples), std::begin(m_samples) + m_count);
+    std::sort(std::begin(sorted), std::end(sorted));
+
+    const double ClampedPercentile = std::clamp(percentile, 0.0, 100.0);
+    const size_t Rank = static_cast<size_t>(std::ceil(ClampedPercentile / 100.0 * m_count));
+    return sorted[Rank == 0 ? 0 : Rank - 1];
+}
@@ -0,0 +1,54 @@
+// samplehistory.h
+//
+// Fixed-capacity ring of the most recent samples (frame times, latencies, ...)
+// with summary statistics. Adding a sample never allocates.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fivednine { namespace system {
+    class SampleHistory
+    {
+    public:
+        explicit SampleHistory(size_t capacity);
+
+        void AddSample(double sample);
+        void Clear();
+
+        // Number of retained samples, at most the capacity
+        size_t GetCount() const;
+        // Total samples ever added, including those since overwritten
+        uint64_t GetTotalCount() const;
+
+        double GetMin() const;
+        double GetMax() const;
+        double GetAverage() const;
+
+        // Nearest-rank percentile in [0, 100]. Sorts a copy, so this is meant
+        // for reporting rather than per-frame use.
+        double GetPercentile(double percentile) const;
+
+        // Oldest first. Stops early if the callback returns false.
+        template<typename TCallback>
+        void ForEachSample(TCallback callback) const
+        {
+            const size_t StartIndex = m_count < m_samples.size() ? 0 : m_nextIndex;
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                if (!callback(m_samples[(StartIndex + i) % m_samples.size()]))
+                {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::vector<double> m_samples;
+        size_t              m_nextIndex = 0;
+        size_t              m_count = 0;
+        uint64_t            m_totalCount = 0;
+    };
+}}
@@ -1,6 +1,9 @@
 #include "time.h"
 #include <SDL.h>
 
+#include <cerrno>
+#include <ctime>
+
 uint32_t fivednine::system::time::GetTicksMs()
 {
     return static_cast<uint32_t>(SDL_GetTicks());
@@ -9,4 +12,21 @@ uint32_t fivednine::system::time::GetTicksMs()
 void fivednine::system::time::SleepMs(uint32_t milliseconds)
 {
     SDL_Delay(milliseconds);
-}
\ No newline at end of file
+}
+
+uint64_t fivednine::system::time::GetTicksNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * kNanosecondsPerSecond + static_cast<uint64_t>(now.tv_nsec);
+}
+
+void fivednine::system::time::SleepNs(uint64_t nanoseconds)
+{
+    struct timespec remaining;
+    remaining.tv_sec = static_cast<time_t>(nanoseconds / kNanosecondsPerSecond);
+    remaining.tv_nsec = static_cast<long>(nanoseconds % kNanosecondsPerSecond);
+
+    // Resume after signals rather than returning early
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &remaining, &remaining) == EINTR) {}
+}
@@ -5,4 +5,11 @@
 namespace fivednine { namespace system { namespace time {
     uint32_t GetTicksMs();
     void SleepMs(uint32_t milliseconds);
-}}}
\ No newline at end of file
+
+    // Monotonic, unaffected by wall clock adjustments
+    uint64_t GetTicksNs();
+    void SleepNs(uint64_t nanoseconds);
+
+    constexpr uint64_t kNanosecondsPerSecond = 1000000000ull;
+    constexpr uint64_t kNanosecondsPerMillisecond = 1000000ull;
+}}}